@@ -1,75 +1,377 @@
+#include "absl/log/absl_log.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/packet.h"
-#include "ml/asr/model.h"
+#include "ml/asr/async_model.h"
+#include "ml/asr/profile.h"
 #include "av_transducer/utils/audio.h"
 #include "av_transducer/formats/asr.pb.h"
+#include <algorithm>
+#include <iterator>
+#include <string_view>
 #include <vector>
 
 namespace aikit {
 
+// This Calculator transcribes 16kHz mono audio. Audio frames in S16
+// format are fed to the recognizer as is, FLT frames are converted first.
+//
+// Final results are sent to ASR_RESULT when the recognizer detects
+// the end of an utterance. If PARTIAL_ASR_RESULT is connected, the current
+// hypothesis of the unfinished utterance is sent every time it changes.
+//
+// PROFILE selects the trade-off between accuracy and CPU/latency (see
+// ml::ASRProfile), "balanced" by default. It sets the chunk size, the
+// decoder search and endpointing and whether rescoring is loaded.
+// BUFFER_DURATION_SEC and OVERFLOW_POLICY override the profile.
+//
+// If FINAL_ASR_MODEL_PATH is set (and not empty), ASR_MODEL_PATH is
+// expected to be a small fast model and the recognition is two-pass (see
+// ml::AsyncASRModel): the fast model gives partial results and its finals
+// are sent to PARTIAL_ASR_RESULT as fully stable text right away, while
+// the audio of the utterance is re-decoded by the final model, as is
+// (the profile applies to the fast model only), whose result goes to
+// ASR_RESULT. Utterances the final model was too late for are counted in
+// ASRSkippedSecondPasses, their fast result goes to ASR_RESULT.
+//
+// If SPEECH_ACTIVITY is connected (see VoiceActivityCalculator), the
+// utterance is finished as soon as the speech activity ends, without
+// waiting for the recognizer's endpointing. AUDIO may have gaps then.
+//
+// Words of the results have timestamps of the input media timeline, the
+// gaps in AUDIO are taken into account.
+//
+// Decoding runs on a separate thread (see ml::AsyncASRModel), so a slow
+// decoder doesn't stall the graph. Results are sent on the following
+// Process calls with the timestamp of the input which completed the
+// chunk. The timestamp bounds of the outputs follow the oldest chunk
+// which is not decoded yet, so the nodes downstream don't wait for
+// results during silence. When the decoder is behind by QUEUE_CAPACITY chunks, the
+// OVERFLOW_POLICY ("block", "drop_oldest" or "shed_partials") applies,
+// its triggers are counted in ASRBlockedPushes, ASRDroppedChunks and
+// ASRShedPartials counters.
+//
+// Example config:
+// node {
+//   calculator: "ASRCalculator"
+//   input_side_packet: "ASR_MODEL_PATH:asr_model_path"
+//   input_side_packet: "SPK_MODEL_PATH:spk_model_path"
+//   input_side_packet: "FINAL_ASR_MODEL_PATH:final_asr_model_path"
+//   input_side_packet: "PROFILE:asr_profile"
+//   input_side_packet: "OVERFLOW_POLICY:asr_overflow_policy"
+//   input_stream: "AUDIO:audio"
+//   input_stream: "SPEECH_ACTIVITY:speech_activity"
+//   output_stream: "ASR_RESULT:asr_result"
+//   output_stream: "PARTIAL_ASR_RESULT:partial_asr_result"
+// }
 class ASRCalculator : public mediapipe::api2::Node {
 public:
     static constexpr mediapipe::api2::SideInput<std::string> kInASRModelPath{
         "ASR_MODEL_PATH"};
     static constexpr mediapipe::api2::SideInput<std::string> kInSPKModelPath{
         "SPK_MODEL_PATH"};
+    static constexpr mediapipe::api2::SideInput<std::string>::Optional kInFinalASRModelPath{
+        "FINAL_ASR_MODEL_PATH"};
+    static constexpr mediapipe::api2::SideInput<std::string>::Optional kInProfile{
+        "PROFILE"};
     static constexpr mediapipe::api2::SideInput<int>::Optional kInBufferDurationSec{
         "BUFFER_DURATION_SEC"};
+    static constexpr mediapipe::api2::SideInput<int>::Optional kInQueueCapacity{
+        "QUEUE_CAPACITY"};
+    static constexpr mediapipe::api2::SideInput<std::string>::Optional kInOverflowPolicy{
+        "OVERFLOW_POLICY"};
     static constexpr mediapipe::api2::Input<media::AudioFrame> kInAudio{
         "AUDIO"};
+    static constexpr mediapipe::api2::Input<bool>::Optional kInSpeechActivity{
+        "SPEECH_ACTIVITY"};
     static constexpr mediapipe::api2::Output<aikit::ASRResult>
         kOutASRResult{"ASR_RESULT"};
-    MEDIAPIPE_NODE_CONTRACT(kInASRModelPath, kInSPKModelPath, kInBufferDurationSec, kInAudio, kOutASRResult);
+    static constexpr mediapipe::api2::Output<aikit::ASRPartialResult>::Optional
+        kOutPartialASRResult{"PARTIAL_ASR_RESULT"};
+    MEDIAPIPE_NODE_CONTRACT(kInASRModelPath, kInSPKModelPath, kInFinalASRModelPath, kInProfile,
+                            kInBufferDurationSec,
+                            kInQueueCapacity, kInOverflowPolicy, kInAudio,
+                            kInSpeechActivity,
+                            kOutASRResult, kOutPartialASRResult,
+                            mediapipe::api2::TimestampChange::Arbitrary());
 
     absl::Status Open(mediapipe::CalculatorContext *cc) override;
     absl::Status Process(mediapipe::CalculatorContext *cc) override;
+    absl::Status Close(mediapipe::CalculatorContext *cc) override;
 
 private:
-    std::unique_ptr<aikit::ml::ASRModel> model_;
+    absl::Status AppendAudio(mediapipe::CalculatorContext *cc,
+                             const media::AudioFrame &audio_frame);
+    // Passes the collected chunk to the decoder, its results will get
+    // the given timestamp.
+    void PushChunk(mediapipe::Timestamp timestamp, bool flush);
+    // Sends the results which are ready.
+    void SendEvents(mediapipe::CalculatorContext *cc);
+    // Results which are not sent yet come at `bound` or later.
+    void UpdateTimestampBounds(mediapipe::CalculatorContext *cc, mediapipe::Timestamp bound);
+    void SendResult(mediapipe::CalculatorContext *cc, const ml::ASREvent &event);
+    void SendPartialResult(mediapipe::CalculatorContext *cc, const ml::ASREvent &event);
+    void SendPartialResult(mediapipe::CalculatorContext *cc, int64_t timestamp_us,
+                           const std::string &stable_text, const std::string &unstable_text);
+    void UpdateCounters(mediapipe::CalculatorContext *cc);
+
+    std::unique_ptr<ml::AsyncASRModel> model_;
+    ml::ASRChunk chunk_;
     std::vector<float> audio_buffer_;
     size_t buffer_size_;
+    bool partial_results_ = false;
+    aikit::ASRPartialResult last_partial_result_;
+    bool speech_active_ = false;
+    mediapipe::Timestamp last_input_timestamp_ = mediapipe::Timestamp::Unset();
+    // Results are sent with timestamps of the past inputs, those have
+    // to be increasing per stream.
+    mediapipe::Timestamp last_result_timestamp_ = mediapipe::Timestamp::Unset();
+    mediapipe::Timestamp last_partial_result_timestamp_ = mediapipe::Timestamp::Unset();
+    ml::AsyncASRModel::Counters counters_;
     static constexpr size_t kSampleRate = 16000;
-    static constexpr size_t kDefaultBufferDurationSec = 1;
+    static constexpr std::string_view kDefaultProfile = "balanced";
 };
 
 MEDIAPIPE_REGISTER_NODE(ASRCalculator);
 
 absl::Status ASRCalculator::Open(mediapipe::CalculatorContext *cc) {
-    const std::string &asr_model_path = kInASRModelPath(cc).Get();
+    std::string_view profile_name = kDefaultProfile;
+    if (kInProfile(cc).IsConnected() && !kInProfile(cc).IsEmpty()) {
+        profile_name = kInProfile(cc).Get();
+    }
+    auto profile = ml::GetASRProfile(profile_name);
+    if (!profile.ok()) {
+        return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+               << profile.status().message();
+    }
+    auto asr_model_path = ml::PrepareModelForProfile(kInASRModelPath(cc).Get(), profile.value());
+    if (!asr_model_path.ok()) {
+        return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+               << "Failed to apply ASR profile " << profile_name << ": "
+               << asr_model_path.status().message();
+    }
     const std::string &spk_model_path = kInSPKModelPath(cc).Get();
-    model_ = std::make_unique<ml::ASRModel>(asr_model_path, spk_model_path);
-    int buffer_duration_sec = kDefaultBufferDurationSec;
+
+    ml::AsyncASRModel::Options options;
+    if (kInQueueCapacity(cc).IsConnected() && !kInQueueCapacity(cc).IsEmpty()) {
+        options.queue_capacity = kInQueueCapacity(cc).Get();
+    }
+    std::string overflow_policy = profile->overflow_policy;
+    if (kInOverflowPolicy(cc).IsConnected() && !kInOverflowPolicy(cc).IsEmpty()) {
+        overflow_policy = kInOverflowPolicy(cc).Get();
+    }
+    auto policy = ml::ParseASROverflowPolicy(overflow_policy);
+    if (!policy.ok()) {
+        return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+               << policy.status().message();
+    }
+    options.overflow_policy = policy.value();
+    if (kInFinalASRModelPath(cc).IsConnected() && !kInFinalASRModelPath(cc).IsEmpty() &&
+        !kInFinalASRModelPath(cc).Get().empty()) {
+        const std::string &final_model_path = kInFinalASRModelPath(cc).Get();
+        model_ = std::make_unique<ml::AsyncASRModel>(
+            ml::ASRModel(asr_model_path.value(), spk_model_path),
+            ml::ASRModel(final_model_path, spk_model_path), options);
+        ABSL_LOG(INFO) << "ASR profile " << profile_name << ", fast model " << asr_model_path.value()
+                       << ", final model " << final_model_path;
+    } else {
+        model_ = std::make_unique<ml::AsyncASRModel>(
+            ml::ASRModel(asr_model_path.value(), spk_model_path), options);
+        ABSL_LOG(INFO) << "ASR profile " << profile_name << ", model " << asr_model_path.value();
+    }
+
+    partial_results_ = kOutPartialASRResult(cc).IsConnected();
+    buffer_size_ = kSampleRate * profile->chunk_ms / 1000;
     if (kInBufferDurationSec(cc).IsConnected() && !kInBufferDurationSec(cc).IsEmpty()) {
-        buffer_duration_sec = kInBufferDurationSec(cc).Get();
+        buffer_size_ = kSampleRate * kInBufferDurationSec(cc).Get();
     }
-    buffer_size_ = kSampleRate * buffer_duration_sec;
     audio_buffer_.reserve(buffer_size_);
+    chunk_.samples.reserve(buffer_size_);
     return absl::OkStatus();
 }
 
 absl::Status ASRCalculator::Process(mediapipe::CalculatorContext *cc) {
-    const auto &audio_frame = kInAudio(cc).Get();
-    auto status = audio_frame.AppendAudioData(audio_buffer_);
-    if (!status.ok()) {
-        return status;
+    last_input_timestamp_ = cc->InputTimestamp();
+    if (!kInAudio(cc).IsEmpty()) {
+        auto status = AppendAudio(cc, kInAudio(cc).Get());
+        if (!status.ok()) {
+            return status;
+        }
+        if (chunk_.samples.size() >= buffer_size_) {
+            PushChunk(cc->InputTimestamp(), /*flush=*/false);
+        }
     }
-    if (audio_buffer_.size() >= buffer_size_) {
-        auto result = model_->operator()(audio_buffer_);
-        audio_buffer_.clear();
-        if (!result.ok()) {
-            return absl::OkStatus();
+
+    if (kInSpeechActivity(cc).IsConnected() && !kInSpeechActivity(cc).IsEmpty()) {
+        const bool speech_active = kInSpeechActivity(cc).Get();
+        if (speech_active_ && !speech_active) {
+            PushChunk(cc->InputTimestamp(), /*flush=*/true);
         }
-        else {
-            aikit::ASRResult asr_result;
-            asr_result.set_transcription(result.value().text);
-            asr_result.mutable_spk_embedding()->Assign(
-                result.value().spk_embedding.begin(),
-                result.value().spk_embedding.end()
-            );  
-            kOutASRResult(cc).Send(asr_result);
+        speech_active_ = speech_active;
+    }
+
+    // Taken before the events are polled, the results emitted meanwhile
+    // are of the pending chunks.
+    const auto pending_timestamp_us = model_->PendingTimestampUs();
+    SendEvents(cc);
+    UpdateTimestampBounds(cc, pending_timestamp_us ? mediapipe::Timestamp(*pending_timestamp_us)
+                                                   : cc->InputTimestamp());
+    UpdateCounters(cc);
+    return absl::OkStatus();
+}
+
+absl::Status ASRCalculator::Close(mediapipe::CalculatorContext *cc) {
+    // Finish the last utterance and wait for all the results.
+    if (last_input_timestamp_ != mediapipe::Timestamp::Unset()) {
+        PushChunk(last_input_timestamp_, /*flush=*/true);
+    }
+    while (!model_->WaitIdle(absl::Milliseconds(100))) {
+        SendEvents(cc);
+    }
+    SendEvents(cc);
+    UpdateCounters(cc);
+    ABSL_LOG(INFO) << "ASR queue overflows: blocked pushes " << counters_.blocked_pushes
+                   << ", dropped chunks " << counters_.dropped_chunks
+                   << ", shed partial results " << counters_.shed_partials
+                   << ", skipped second passes " << counters_.skipped_second_passes;
+    model_.reset();
+    return absl::OkStatus();
+}
+
+absl::Status ASRCalculator::AppendAudio(mediapipe::CalculatorContext *cc,
+                                        const media::AudioFrame &audio_frame) {
+    const int64_t offset = chunk_.samples.size();
+    const auto format = audio_frame.c_frame()->format;
+    if (format == AV_SAMPLE_FMT_S16 || format == AV_SAMPLE_FMT_S16P) {
+        auto status = audio_frame.AppendAudioData(chunk_.samples);
+        if (!status.ok()) {
+            return status;
         }
+    } else {
+        audio_buffer_.clear();
+        auto status = audio_frame.AppendAudioData(audio_buffer_);
+        if (!status.ok()) {
+            return status;
+        }
+        std::transform(audio_buffer_.begin(), audio_buffer_.end(), std::back_inserter(chunk_.samples),
+                       [](float x) { return static_cast<int16_t>(std::clamp(x, -1.0f, 1.0f) * 32767.0f); });
     }
+    chunk_.segments.push_back({offset, cc->InputTimestamp().Microseconds()});
     return absl::OkStatus();
 }
 
-} // namespace aikit
\ No newline at end of file
+void ASRCalculator::PushChunk(mediapipe::Timestamp timestamp, bool flush) {
+    chunk_.timestamp_us = timestamp.Microseconds();
+    chunk_.flush = flush;
+    chunk_.partial = partial_results_;
+    model_->Push(std::move(chunk_));
+    chunk_ = ml::ASRChunk();
+    chunk_.samples.reserve(buffer_size_);
+}
+
+void ASRCalculator::SendEvents(mediapipe::CalculatorContext *cc) {
+    while (auto event = model_->PollEvent()) {
+        switch (event->type) {
+        case ml::ASREvent::Type::kFinal:
+            SendResult(cc, event.value());
+            break;
+        case ml::ASREvent::Type::kPartial:
+            SendPartialResult(cc, event.value());
+            break;
+        case ml::ASREvent::Type::kFastFinal:
+            if (partial_results_) {
+                SendPartialResult(cc, event->timestamp_us, event->result.text, "");
+            }
+            break;
+        }
+    }
+}
+
+void ASRCalculator::UpdateTimestampBounds(mediapipe::CalculatorContext *cc, mediapipe::Timestamp bound) {
+    auto next_allowed = [bound](mediapipe::Timestamp last_timestamp) {
+        return last_timestamp == mediapipe::Timestamp::Unset()
+                   ? bound
+                   : std::max(bound, last_timestamp.NextAllowedInStream());
+    };
+    kOutASRResult(cc).SetNextTimestampBound(next_allowed(last_result_timestamp_));
+    kOutPartialASRResult(cc).SetNextTimestampBound(next_allowed(last_partial_result_timestamp_));
+}
+
+void ASRCalculator::SendResult(mediapipe::CalculatorContext *cc, const ml::ASREvent &event) {
+    last_partial_result_.Clear();
+    const auto &result = event.result;
+    aikit::ASRResult asr_result;
+    asr_result.set_transcription(result.text);
+    asr_result.mutable_spk_embedding()->Assign(
+        result.spk_embedding.begin(),
+        result.spk_embedding.end()
+    );
+    for (size_t i = 0; i < result.words.size(); ++i) {
+        auto *asr_word = asr_result.add_words();
+        asr_word->set_word(result.words[i].word);
+        asr_word->set_start_timestamp_us(event.word_timestamps[i].start_us);
+        asr_word->set_end_timestamp_us(event.word_timestamps[i].end_us);
+        asr_word->set_confidence(result.words[i].conf);
+    }
+
+    // Flush may give two results for one chunk.
+    auto timestamp = mediapipe::Timestamp(event.timestamp_us);
+    if (last_result_timestamp_ != mediapipe::Timestamp::Unset() && timestamp <= last_result_timestamp_) {
+        timestamp = last_result_timestamp_.NextAllowedInStream();
+    }
+    last_result_timestamp_ = timestamp;
+    kOutASRResult(cc).Send(std::move(asr_result), timestamp);
+}
+
+void ASRCalculator::SendPartialResult(mediapipe::CalculatorContext *cc, const ml::ASREvent &event) {
+    SendPartialResult(cc, event.timestamp_us, event.partial.stable_text, event.partial.unstable_text);
+}
+
+void ASRCalculator::SendPartialResult(mediapipe::CalculatorContext *cc, int64_t timestamp_us,
+                                      const std::string &stable_text,
+                                      const std::string &unstable_text) {
+    // Nothing was recognized, e.g. the utterance ended in silence and
+    // gave no final result. The next hypothesis starts over.
+    if (stable_text.empty() && unstable_text.empty()) {
+        last_partial_result_.Clear();
+        return;
+    }
+    if (stable_text == last_partial_result_.stable_transcription() &&
+        unstable_text == last_partial_result_.unstable_transcription()) {
+        return;
+    }
+    last_partial_result_.set_stable_transcription(stable_text);
+    last_partial_result_.set_unstable_transcription(unstable_text);
+
+    auto timestamp = mediapipe::Timestamp(timestamp_us);
+    if (last_partial_result_timestamp_ != mediapipe::Timestamp::Unset() &&
+        timestamp <= last_partial_result_timestamp_) {
+        timestamp = last_partial_result_timestamp_.NextAllowedInStream();
+    }
+    last_partial_result_timestamp_ = timestamp;
+    kOutPartialASRResult(cc).Send(last_partial_result_, timestamp);
+}
+
+void ASRCalculator::UpdateCounters(mediapipe::CalculatorContext *cc) {
+    const auto counters = model_->counters();
+    if (counters.blocked_pushes > counters_.blocked_pushes) {
+        cc->GetCounter("ASRBlockedPushes")->IncrementBy(
+            static_cast<int>(counters.blocked_pushes - counters_.blocked_pushes));
+    }
+    if (counters.dropped_chunks > counters_.dropped_chunks) {
+        cc->GetCounter("ASRDroppedChunks")->IncrementBy(
+            static_cast<int>(counters.dropped_chunks - counters_.dropped_chunks));
+        ABSL_LOG_EVERY_N_SEC(WARNING, 3)
+            << "ASR is behind the audio, dropped " << counters.dropped_chunks << " chunks so far";
+    }
+    if (counters.shed_partials > counters_.shed_partials) {
+        cc->GetCounter("ASRShedPartials")->IncrementBy(
+            static_cast<int>(counters.shed_partials - counters_.shed_partials));
+    }
+    if (counters.skipped_second_passes > counters_.skipped_second_passes) {
+        cc->GetCounter("ASRSkippedSecondPasses")->IncrementBy(
+            static_cast<int>(counters.skipped_second_passes - counters_.skipped_second_passes));
+    }
+    counters_ = counters;
+}
+
+} // namespace aikit
@@ -1,5 +1,7 @@
 #include "absl/log/absl_log.h"
+#include "mediapipe/framework/calculator_graph.h"
 #include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status_matchers.h"
 #include "av_transducer/utils/audio.h"
 #include "av_transducer/formats/asr.pb.h"
@@ -20,6 +22,7 @@ protected:
                       input_side_packet: "BUFFER_DURATION_SEC:buffer_duration_sec"
                       input_stream: "AUDIO:audio"
                       output_stream: "ASR_RESULT:asr_result"
+                      output_stream: "PARTIAL_ASR_RESULT:partial_asr_result"
                     )pb") {}
 
 void SetInput() {
@@ -48,8 +51,9 @@ void SetInput() {
       AV_SAMPLE_FMT_FLTP, &in_channel_layout, 16000, chunk_size);
     auto status = in_frame_or->FillAudioData(audio_chunk);
     
+    // Timestamps are in microseconds, as in the graph.
     runner_.MutableInputs()->Tag("AUDIO").packets.push_back(
-        mediapipe::Adopt(in_frame_or.release()).At(mediapipe::Timestamp(i)));
+        mediapipe::Adopt(in_frame_or.release()).At(mediapipe::Timestamp(i * 1000000 / 16000)));
   }
 }
 
@@ -70,11 +74,110 @@ TEST_F(ASRCalculatorTest, ProcessesAudioCorrectly) {
   auto results = GetAllOutputs();
 
   EXPECT_GT(results.size(), 0);
+  int64_t prev_end_us = 0;
   for (const auto &result : results) {
     EXPECT_FALSE(result.transcription().empty());
+    EXPECT_GT(result.words_size(), 0);
+    for (const auto &word : result.words()) {
+      EXPECT_LE(prev_end_us, word.start_timestamp_us());
+      EXPECT_LE(word.start_timestamp_us(), word.end_timestamp_us());
+      prev_end_us = word.end_timestamp_us();
+    }
     ABSL_LOG(INFO) << "Text: " << result.transcription() << ", Vector size: " << result.spk_embedding().size() << "\n";
   }
 }
 
+TEST_F(ASRCalculatorTest, EmitsPartialResultsBeforeFinal) {
+  SetInput();
+  MP_ASSERT_OK(runner_.Run());
+
+  const auto &partial_packets = runner_.Outputs().Tag("PARTIAL_ASR_RESULT").packets;
+  const auto &final_packets = runner_.Outputs().Tag("ASR_RESULT").packets;
+  ASSERT_GT(partial_packets.size(), 0);
+  ASSERT_GT(final_packets.size(), 0);
+  EXPECT_LT(partial_packets.front().Timestamp(), final_packets.front().Timestamp());
+
+  for (const auto &packet : partial_packets) {
+    const auto &result = packet.Get<aikit::ASRPartialResult>();
+    EXPECT_FALSE(result.stable_transcription().empty() &&
+                 result.unstable_transcription().empty());
+    ABSL_LOG(INFO) << "Stable: " << result.stable_transcription()
+                   << ", unstable: " << result.unstable_transcription();
+  }
+}
+
+// Nodes with the default input stream handler downstream, such as
+// EvaluatorClientCalculator, get their other inputs while the recognizer
+// has nothing to say.
+TEST(ASRCalculatorGraphTest, AdvancesBoundsWithoutResults) {
+  auto config = mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(R"pb(
+    input_stream: "audio"
+    input_stream: "detections"
+    input_side_packet: "asr_model_path"
+    input_side_packet: "spk_model_path"
+    node {
+      calculator: "ASRCalculator"
+      input_side_packet: "ASR_MODEL_PATH:asr_model_path"
+      input_side_packet: "SPK_MODEL_PATH:spk_model_path"
+      input_stream: "AUDIO:audio"
+      output_stream: "ASR_RESULT:asr_result"
+      output_stream: "PARTIAL_ASR_RESULT:partial_asr_result"
+    }
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "detections"
+      input_stream: "asr_result"
+      input_stream: "partial_asr_result"
+      output_stream: "detections_out"
+      output_stream: "asr_result_out"
+      output_stream: "partial_asr_result_out"
+    }
+  )pb");
+  mediapipe::CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(
+      config, {{"asr_model_path", mediapipe::MakePacket<std::string>("ml/asr/models/vosk-model-ru-0.42")},
+               {"spk_model_path", mediapipe::MakePacket<std::string>("ml/asr/models/vosk-model-spk-0.4")}}));
+  std::vector<mediapipe::Packet> detections;
+  size_t num_asr_results = 0;
+  size_t num_partial_results = 0;
+  MP_ASSERT_OK(graph.ObserveOutputStream("detections_out", [&](const mediapipe::Packet &packet) {
+    detections.push_back(packet);
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.ObserveOutputStream("asr_result_out", [&](const mediapipe::Packet &packet) {
+    ++num_asr_results;
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.ObserveOutputStream("partial_asr_result_out", [&](const mediapipe::Packet &packet) {
+    ++num_partial_results;
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  // 10 s of silence in 100 ms frames, a video-side packet with every frame.
+  AVChannelLayout channel_layout = AV_CHANNEL_LAYOUT_MONO;
+  std::vector<float> silence(1600, 0.0f);
+  constexpr int kNumFrames = 100;
+  for (int i = 0; i < kNumFrames; ++i) {
+    auto frame = media::AudioFrame::CreateAudioFrame(AV_SAMPLE_FMT_FLTP, &channel_layout, 16000, silence.size());
+    ASSERT_NE(frame, nullptr);
+    MP_ASSERT_OK(frame->FillAudioData(silence));
+    const auto timestamp = mediapipe::Timestamp(i * 100000);
+    MP_ASSERT_OK(graph.AddPacketToInputStream("audio", mediapipe::Adopt(frame.release()).At(timestamp)));
+    MP_ASSERT_OK(graph.AddPacketToInputStream("detections", mediapipe::MakePacket<int>(i).At(timestamp)));
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  // The inputs are still open, without the bounds of the ASR outputs
+  // nothing would pass until the graph closes.
+  EXPECT_GT(detections.size(), 0);
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(detections.size(), kNumFrames);
+  EXPECT_EQ(num_asr_results, 0);
+  // Empty hypotheses are not sent.
+  EXPECT_EQ(num_partial_results, 0);
+}
+
 } // namespace
 } // namespace aikit
\ No newline at end of file
@@ -1,10 +1,16 @@
 
+#include "absl/log/absl_log.h"
+#include "absl/strings/str_cat.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/packet.h"
 #include "mediapipe/framework/formats/detection.pb.h"
 #include "mediapipe/framework/formats/image.h"
 #include "ml/detection/model.h"
+#include "ml/detection/resolution_policy.h"
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace aikit {
@@ -37,10 +43,22 @@ std::string LabelId2Label(int label_id) {
 // This Calculator applies object detection
 // model to the given frames.
 //
+// REDUCED_MODEL_PATHS are optional variants of the MODEL_PATH model
+// which infer the frames at lower resolutions, from the highest to the
+// lowest (see ml/detection/converter.py). The variant of each frame is
+// chosen by the labels of the previous one (see ml::ResolutionPolicy),
+// so trivial layouts cost a fraction of the full resolution inference.
+//
+// With a non-empty ORT_PROFILE_PREFIX the ops of the model are profiled
+// to <ORT_PROFILE_PREFIX>_cdetr_<date>.json, written on Close, the
+// variants to <ORT_PROFILE_PREFIX>_cdetr_<index>_<date>.json.
+//
 // Example config:
 // node {
 //   calculator: "DetectionCalculator"
 //   input_side_packet: "MODEL_PATH:model_path"
+//   input_side_packet: "REDUCED_MODEL_PATHS:reduced_model_paths"
+//   input_side_packet: "ORT_PROFILE_PREFIX:ort_profile_prefix"
 //   input_stream: "IMAGE:image"
 //   output_stream: "DETECTIONS:detections"
 // }
@@ -48,29 +66,77 @@ class DetectionCalculator : public mediapipe::api2::Node {
 public:
   static constexpr mediapipe::api2::SideInput<std::string>
       kInDetectionModelPath{"MODEL_PATH"};
+  static constexpr mediapipe::api2::SideInput<
+      std::vector<std::string>>::Optional kInReducedModelPaths{
+      "REDUCED_MODEL_PATHS"};
+  static constexpr mediapipe::api2::SideInput<std::string>::Optional
+      kInOrtProfilePrefix{"ORT_PROFILE_PREFIX"};
   static constexpr mediapipe::api2::Input<mediapipe::Image> kInImage{"IMAGE"};
   static constexpr mediapipe::api2::Output<std::vector<mediapipe::Detection>>
       kOutDetections{"DETECTIONS"};
-  MEDIAPIPE_NODE_CONTRACT(kInDetectionModelPath, kInImage, kOutDetections);
+  MEDIAPIPE_NODE_CONTRACT(kInDetectionModelPath, kInReducedModelPaths,
+                          kInOrtProfilePrefix, kInImage, kOutDetections);
 
   absl::Status Open(mediapipe::CalculatorContext *cc) override;
   absl::Status Process(mediapipe::CalculatorContext *cc) override;
+  absl::Status Close(mediapipe::CalculatorContext *cc) override;
 
 private:
-  std::unique_ptr<ml::CDetr> model_;
+  // The full resolution model, then the reduced ones.
+  std::vector<std::unique_ptr<ml::CDetr>> models_;
+  std::optional<ml::ResolutionPolicy> policy_;
+  // Frame without the padding of the rows.
+  std::vector<uint8_t> pixels_;
 };
 MEDIAPIPE_REGISTER_NODE(DetectionCalculator);
 
 absl::Status DetectionCalculator::Open(mediapipe::CalculatorContext *cc) {
-  const std::string &cdetr_model_path = kInDetectionModelPath(cc).Get();
-  model_ = std::make_unique<ml::CDetr>(cdetr_model_path);
+  std::vector<std::string> model_paths = {kInDetectionModelPath(cc).Get()};
+  if (kInReducedModelPaths(cc).IsConnected() &&
+      !kInReducedModelPaths(cc).IsEmpty()) {
+    const auto &reduced_model_paths = kInReducedModelPaths(cc).Get();
+    model_paths.insert(model_paths.end(), reduced_model_paths.begin(),
+                       reduced_model_paths.end());
+  }
+  std::string profile_prefix;
+  if (kInOrtProfilePrefix(cc).IsConnected() &&
+      !kInOrtProfilePrefix(cc).IsEmpty() &&
+      !kInOrtProfilePrefix(cc).Get().empty()) {
+    profile_prefix = kInOrtProfilePrefix(cc).Get() + "_cdetr";
+  }
+  for (size_t i = 0; i < model_paths.size(); ++i) {
+    ml::CDetrOptions options;
+    if (!profile_prefix.empty()) {
+      options.profile_prefix =
+          i == 0 ? profile_prefix : absl::StrCat(profile_prefix, "_", i);
+    }
+    models_.push_back(std::make_unique<ml::CDetr>(model_paths[i], options));
+  }
+  policy_.emplace(
+      ml::ResolutionPolicyOptions{.num_resolutions = models_.size()});
   return absl::OkStatus();
 }
 
 absl::Status DetectionCalculator::Process(mediapipe::CalculatorContext *cc) {
   const auto &image = kInImage(cc).Get();
-  auto detections =
-      model_->operator()(image.GetImageFrameSharedPtr()->PixelData());
+  const auto image_frame = image.GetImageFrameSharedPtr();
+  if (static_cast<size_t>(image_frame->Width()) != ml::CDetr::width ||
+      static_cast<size_t>(image_frame->Height()) != ml::CDetr::height ||
+      image_frame->NumberOfChannels() != 3) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Expected " << ml::CDetr::width << "x" << ml::CDetr::height
+           << " RGB frame, got " << image_frame->Width() << "x"
+           << image_frame->Height() << "x" << image_frame->NumberOfChannels();
+  }
+  // The model reads the frame in place, unless its rows are padded.
+  const uint8_t *pixels = image_frame->PixelData();
+  if (!image_frame->IsContiguous()) {
+    pixels_.resize(image_frame->PixelDataSizeStoredContiguously());
+    image_frame->CopyToBuffer(pixels_.data(), pixels_.size());
+    pixels = pixels_.data();
+  }
+  auto detections = models_[policy_->Next()]->operator()(pixels);
+  policy_->Update(detections);
 
   std::vector<mediapipe::Detection> mdets;
   for (const auto &detection : detections) {
@@ -96,4 +162,14 @@ absl::Status DetectionCalculator::Process(mediapipe::CalculatorContext *cc) {
   return absl::OkStatus();
 }
 
+absl::Status DetectionCalculator::Close(mediapipe::CalculatorContext *cc) {
+  for (auto &model : models_) {
+    const auto profile = model->EndProfiling();
+    if (!profile.empty()) {
+      ABSL_LOG(INFO) << "CDetr profile written to " << profile;
+    }
+  }
+  return absl::OkStatus();
+}
+
 } // namespace aikit
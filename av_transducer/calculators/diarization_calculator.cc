@@ -0,0 +1,82 @@
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "ml/diarization/diarizer.h"
+#include "av_transducer/formats/asr.pb.h"
+#include <optional>
+
+namespace aikit {
+
+// This Calculator sets the speaker_id of ASR results.
+//
+// Speaker embeddings of the results are clustered online (see
+// ml::OnlineDiarizer), the results are forwarded with the id of the
+// cluster. Ids start from 1 and stay the same for a speaker during the
+// session, results without an embedding get 0.
+//
+// Example config:
+// node {
+//   calculator: "DiarizationCalculator"
+//   input_side_packet: "SIMILARITY_THRESHOLD:similarity_threshold"
+//   input_side_packet: "MAX_SPEAKERS:max_speakers"
+//   input_stream: "ASR_RESULT:asr_result"
+//   output_stream: "ASR_RESULT:diarized_asr_result"
+// }
+class DiarizationCalculator : public mediapipe::api2::Node {
+public:
+  static constexpr mediapipe::api2::SideInput<float>::Optional
+      kInSimilarityThreshold{"SIMILARITY_THRESHOLD"};
+  static constexpr mediapipe::api2::SideInput<int>::Optional kInMaxSpeakers{
+      "MAX_SPEAKERS"};
+  static constexpr mediapipe::api2::Input<ASRResult> kInASRResult{
+      "ASR_RESULT"};
+  static constexpr mediapipe::api2::Output<ASRResult> kOutASRResult{
+      "ASR_RESULT"};
+  MEDIAPIPE_NODE_CONTRACT(kInSimilarityThreshold, kInMaxSpeakers, kInASRResult,
+                          kOutASRResult);
+
+  absl::Status Open(mediapipe::CalculatorContext *cc) override;
+  absl::Status Process(mediapipe::CalculatorContext *cc) override;
+
+private:
+  ml::OnlineDiarizerOptions options_;
+  // Created on the first embedding, its size depends on the speaker model.
+  std::optional<ml::OnlineDiarizer> diarizer_;
+};
+MEDIAPIPE_REGISTER_NODE(DiarizationCalculator);
+
+absl::Status DiarizationCalculator::Open(mediapipe::CalculatorContext *cc) {
+  if (kInSimilarityThreshold(cc).IsConnected() &&
+      !kInSimilarityThreshold(cc).IsEmpty()) {
+    options_.similarity_threshold = kInSimilarityThreshold(cc).Get();
+  }
+  if (kInMaxSpeakers(cc).IsConnected() && !kInMaxSpeakers(cc).IsEmpty()) {
+    options_.max_speakers = kInMaxSpeakers(cc).Get();
+  }
+  if (options_.max_speakers <= 0) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "MAX_SPEAKERS must be positive.";
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DiarizationCalculator::Process(mediapipe::CalculatorContext *cc) {
+  ASRResult asr_result = kInASRResult(cc).Get();
+  const auto &embedding = asr_result.spk_embedding();
+  if (!embedding.empty()) {
+    if (!diarizer_) {
+      options_.embedding_size = embedding.size();
+      diarizer_.emplace(options_);
+    }
+    auto speaker_id = diarizer_->Assign(
+        absl::MakeConstSpan(embedding.data(), embedding.size()));
+    if (!speaker_id.ok()) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << speaker_id.status().message();
+    }
+    asr_result.set_speaker_id(speaker_id.value());
+  }
+  kOutASRResult(cc).Send(std::move(asr_result));
+  return absl::OkStatus();
+}
+
+} // namespace aikit
@@ -24,6 +24,9 @@ namespace aikit {
 //   calculator: "EvaluatorClientCalculator"
 //   input_stream: "DETECTIONS:detections"
 //   input_stream: "SPEAKER_NAME:speaker_name"
+//   input_stream: "ASR_RESULT:asr_result"
+//   input_stream: "PARTIAL_ASR_RESULT:partial_asr_result"
+//   input_stream: "KEYWORD:keyword"
 // }
 class EvaluatorClientCalculator : public mediapipe::api2::Node {
 public:
@@ -33,7 +36,12 @@ public:
       "SPEAKER_NAME"};
   static constexpr mediapipe::api2::Input<ASRResult>::Optional kInASRResult{
       "ASR_RESULT"};
-  MEDIAPIPE_NODE_CONTRACT(kInDetections, kInSpeakerName, kInASRResult);
+  static constexpr mediapipe::api2::Input<ASRPartialResult>::Optional
+      kInPartialASRResult{"PARTIAL_ASR_RESULT"};
+  static constexpr mediapipe::api2::Input<KeywordEvent>::Optional kInKeyword{
+      "KEYWORD"};
+  MEDIAPIPE_NODE_CONTRACT(kInDetections, kInSpeakerName, kInASRResult,
+                          kInPartialASRResult, kInKeyword);
 
   absl::Status Open(mediapipe::CalculatorContext *cc) override;
   absl::Status Process(mediapipe::CalculatorContext *cc) override;
@@ -97,10 +105,9 @@ EvaluatorClientCalculator::Process(mediapipe::CalculatorContext *cc) {
     aikit::evaluator::ASRResultRequest request;
     request.set_event_timestamp(cc->InputTimestamp().Microseconds());
     request.set_transcription(asr_result.transcription());
-    request.mutable_spk_embedding()->Assign(
-                asr_result.spk_embedding().begin(),
-                asr_result.spk_embedding().end()
-            ); 
+    request.set_speaker_id(asr_result.speaker_id());
+    request.set_speaker_name(asr_result.speaker_name());
+    request.set_speaker_score(asr_result.speaker_score());
 
     aikit::evaluator::ASRResultReply reply;
     auto status = stub_->ASRResult(&context, request, &reply);
@@ -111,6 +118,52 @@ EvaluatorClientCalculator::Process(mediapipe::CalculatorContext *cc) {
     }
   }
 
+  if (!kInPartialASRResult(cc).IsEmpty()) {
+    const auto &partial_asr_result = kInPartialASRResult(cc).Get();
+
+    // ClientContext can't be reused between calls.
+    grpc::ClientContext partial_context;
+    partial_context.set_deadline(deadline);
+
+    aikit::evaluator::PartialASRResultRequest request;
+    request.set_event_timestamp(cc->InputTimestamp().Microseconds());
+    request.set_stable_transcription(
+        partial_asr_result.stable_transcription());
+    request.set_unstable_transcription(
+        partial_asr_result.unstable_transcription());
+
+    aikit::evaluator::PartialASRResultReply reply;
+    auto status =
+        stub_->PartialASRResult(&partial_context, request, &reply);
+
+    if (!status.ok()) {
+      ABSL_LOG(WARNING) << "Could not send partial ASR result to evaluator. "
+                        << status.error_message();
+    }
+  }
+
+  if (!kInKeyword(cc).IsEmpty()) {
+    const auto &keyword = kInKeyword(cc).Get();
+
+    grpc::ClientContext keyword_context;
+    keyword_context.set_deadline(deadline);
+
+    aikit::evaluator::KeywordRequest request;
+    request.set_event_timestamp(cc->InputTimestamp().Microseconds());
+    request.set_phrase(keyword.phrase());
+    request.set_start_timestamp(keyword.start_timestamp_us());
+    request.set_end_timestamp(keyword.end_timestamp_us());
+    request.set_confidence(keyword.confidence());
+
+    aikit::evaluator::KeywordReply reply;
+    auto status = stub_->Keyword(&keyword_context, request, &reply);
+
+    if (!status.ok()) {
+      ABSL_LOG(WARNING) << "Could not send keyword to evaluator. "
+                        << status.error_message();
+    }
+  }
+
   return absl::OkStatus();
 }
 
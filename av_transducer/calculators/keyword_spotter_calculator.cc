@@ -0,0 +1,289 @@
+#include "absl/log/absl_log.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "ml/asr/keyword_spotter.h"
+#include "ml/asr/profile.h"
+#include "av_transducer/utils/audio.h"
+#include "av_transducer/formats/asr.pb.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace aikit {
+
+// This Calculator spots KEYWORDS phrases in 16kHz mono audio (S16 or
+// FLT) with a grammar constrained recognizer, see ml::KeywordSpotter.
+//
+// MODEL_PATH must be a Vosk model with the runtime graph. It's prepared
+// for PROFILE the same way ASRCalculator does it, so with the same model
+// path and profile both share one loaded model. Audio is decoded in
+// chunks of CHUNK_MS (100 by default), a phrase is sent to KEYWORD as
+// soon as the recognizer is sure about it, at the timestamp of the input
+// which completed the chunk.
+//
+// If SPEECH_ACTIVITY is connected (see VoiceActivityCalculator), the
+// utterance is finished when the speech activity ends. AUDIO may have
+// gaps then, they are taken into account in the timestamps of the phrases.
+//
+// The timestamp bound of KEYWORD follows the inputs, so the nodes
+// downstream don't wait for phrases which are not said. With no KEYWORDS
+// (or an empty list) the calculator does nothing, doesn't load the model
+// and KEYWORD is closed.
+//
+// Example config:
+// node {
+//   calculator: "KeywordSpotterCalculator"
+//   input_side_packet: "MODEL_PATH:kws_model_path"
+//   input_side_packet: "KEYWORDS:keywords"
+//   input_side_packet: "PROFILE:asr_profile"
+//   input_stream: "AUDIO:audio"
+//   input_stream: "SPEECH_ACTIVITY:speech_activity"
+//   output_stream: "KEYWORD:keyword"
+// }
+class KeywordSpotterCalculator : public mediapipe::api2::Node {
+public:
+  static constexpr mediapipe::api2::SideInput<std::string> kInModelPath{
+      "MODEL_PATH"};
+  static constexpr mediapipe::api2::SideInput<
+      std::vector<std::string>>::Optional kInKeywords{"KEYWORDS"};
+  static constexpr mediapipe::api2::SideInput<std::string>::Optional
+      kInProfile{"PROFILE"};
+  static constexpr mediapipe::api2::SideInput<int>::Optional kInChunkMs{
+      "CHUNK_MS"};
+  static constexpr mediapipe::api2::Input<media::AudioFrame> kInAudio{"AUDIO"};
+  static constexpr mediapipe::api2::Input<bool>::Optional kInSpeechActivity{
+      "SPEECH_ACTIVITY"};
+  static constexpr mediapipe::api2::Output<aikit::KeywordEvent> kOutKeyword{
+      "KEYWORD"};
+  MEDIAPIPE_NODE_CONTRACT(kInModelPath, kInKeywords, kInProfile, kInChunkMs,
+                          kInAudio, kInSpeechActivity, kOutKeyword,
+                          mediapipe::api2::TimestampChange::Arbitrary());
+
+  absl::Status Open(mediapipe::CalculatorContext *cc) override;
+  absl::Status Process(mediapipe::CalculatorContext *cc) override;
+  absl::Status Close(mediapipe::CalculatorContext *cc) override;
+
+private:
+  // Position of the decoded sample `first_sample` on the input timeline.
+  struct Segment {
+    int64_t first_sample;
+    int64_t timestamp_us;
+  };
+
+  absl::Status AppendAudio(mediapipe::CalculatorContext *cc,
+                           const media::AudioFrame &audio_frame);
+  absl::Status Decode(mediapipe::CalculatorContext *cc, bool flush);
+  void SendHits(mediapipe::CalculatorContext *cc);
+  int64_t TimestampUs(float seconds) const;
+
+  std::optional<ml::KeywordSpotter> spotter_;
+  std::vector<int16_t> chunk_;
+  std::vector<float> float_buffer_;
+  size_t chunk_size_ = 0;
+  std::vector<ml::KeywordHit> hits_;
+  // Samples fed to the spotter, including the current chunk.
+  int64_t num_samples_ = 0;
+  std::deque<Segment> segments_;
+  bool speech_active_ = false;
+  // Input which completed the last chunk.
+  mediapipe::Timestamp last_timestamp_ = mediapipe::Timestamp::Unset();
+  // Smallest timestamp allowed for the next KEYWORD packet.
+  mediapipe::Timestamp next_timestamp_ = mediapipe::Timestamp::Unset();
+
+  static constexpr int kSampleRate = 16000;
+  static constexpr int kDefaultChunkMs = 100;
+};
+MEDIAPIPE_REGISTER_NODE(KeywordSpotterCalculator);
+
+absl::Status KeywordSpotterCalculator::Open(mediapipe::CalculatorContext *cc) {
+  if (!kInKeywords(cc).IsConnected() || kInKeywords(cc).IsEmpty() ||
+      kInKeywords(cc).Get().empty()) {
+    kOutKeyword(cc).SetNextTimestampBound(mediapipe::Timestamp::Done());
+    return absl::OkStatus();
+  }
+
+  std::string profile_name = "balanced";
+  if (kInProfile(cc).IsConnected() && !kInProfile(cc).IsEmpty()) {
+    profile_name = kInProfile(cc).Get();
+  }
+  auto profile = ml::GetASRProfile(profile_name);
+  if (!profile.ok()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << profile.status().message();
+  }
+  auto model_path =
+      ml::PrepareModelForProfile(kInModelPath(cc).Get(), profile.value());
+  if (!model_path.ok()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << model_path.status().message();
+  }
+  auto spotter = ml::KeywordSpotter::Create(model_path.value(),
+                                            kInKeywords(cc).Get(), kSampleRate);
+  if (!spotter.ok()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << spotter.status().message();
+  }
+  spotter_.emplace(std::move(spotter).value());
+  ABSL_LOG(INFO) << "Spotting " << kInKeywords(cc).Get().size()
+                 << " phrases with " << model_path.value();
+
+  int chunk_ms = kDefaultChunkMs;
+  if (kInChunkMs(cc).IsConnected() && !kInChunkMs(cc).IsEmpty()) {
+    chunk_ms = kInChunkMs(cc).Get();
+  }
+  chunk_size_ = kSampleRate * chunk_ms / 1000;
+  chunk_.reserve(chunk_size_);
+  return absl::OkStatus();
+}
+
+absl::Status KeywordSpotterCalculator::Process(
+    mediapipe::CalculatorContext *cc) {
+  if (!spotter_) {
+    return absl::OkStatus();
+  }
+  if (!kInAudio(cc).IsEmpty()) {
+    auto status = AppendAudio(cc, kInAudio(cc).Get());
+    if (!status.ok()) {
+      return status;
+    }
+    if (chunk_.size() >= chunk_size_) {
+      status = Decode(cc, /*flush=*/false);
+      if (!status.ok()) {
+        return status;
+      }
+    }
+  }
+
+  if (kInSpeechActivity(cc).IsConnected() &&
+      !kInSpeechActivity(cc).IsEmpty()) {
+    const bool speech_active = kInSpeechActivity(cc).Get();
+    if (speech_active_ && !speech_active) {
+      auto status = Decode(cc, /*flush=*/true);
+      if (!status.ok()) {
+        return status;
+      }
+    }
+    speech_active_ = speech_active;
+  }
+
+  // Audio still in the chunk completes with a later input.
+  const auto bound = cc->InputTimestamp().NextAllowedInStream();
+  if (next_timestamp_ == mediapipe::Timestamp::Unset() ||
+      next_timestamp_ < bound) {
+    next_timestamp_ = bound;
+  }
+  kOutKeyword(cc).SetNextTimestampBound(next_timestamp_);
+  return absl::OkStatus();
+}
+
+absl::Status KeywordSpotterCalculator::Close(mediapipe::CalculatorContext *cc) {
+  if (spotter_ && last_timestamp_ != mediapipe::Timestamp::Unset()) {
+    return Decode(cc, /*flush=*/true);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status KeywordSpotterCalculator::AppendAudio(
+    mediapipe::CalculatorContext *cc, const media::AudioFrame &audio_frame) {
+  last_timestamp_ = cc->InputTimestamp();
+  const int64_t first_sample = num_samples_ + chunk_.size();
+  const int64_t timestamp_us = cc->InputTimestamp().Microseconds();
+  // Continuous audio needs no new segment.
+  const bool continues =
+      !segments_.empty() &&
+      std::abs(segments_.back().timestamp_us +
+               (first_sample - segments_.back().first_sample) * 1000000 /
+                   kSampleRate -
+               timestamp_us) <= 1000000 / kSampleRate;
+  if (!continues) {
+    segments_.push_back({first_sample, timestamp_us});
+  }
+
+  const auto format = audio_frame.c_frame()->format;
+  if (format == AV_SAMPLE_FMT_S16 || format == AV_SAMPLE_FMT_S16P) {
+    return audio_frame.AppendAudioData(chunk_);
+  }
+  float_buffer_.clear();
+  auto status = audio_frame.AppendAudioData(float_buffer_);
+  if (!status.ok()) {
+    return status;
+  }
+  std::transform(float_buffer_.begin(), float_buffer_.end(),
+                 std::back_inserter(chunk_), [](float x) {
+                   return static_cast<int16_t>(std::clamp(x, -1.0f, 1.0f) *
+                                               32767.0f);
+                 });
+  return absl::OkStatus();
+}
+
+absl::Status KeywordSpotterCalculator::Decode(mediapipe::CalculatorContext *cc,
+                                              bool flush) {
+  if (!chunk_.empty()) {
+    auto status = (*spotter_)(chunk_, hits_);
+    if (!status.ok()) {
+      return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+             << status.message();
+    }
+    num_samples_ += chunk_.size();
+    chunk_.clear();
+  }
+  if (flush) {
+    auto status = spotter_->Flush(hits_);
+    if (!status.ok()) {
+      return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+             << status.message();
+    }
+  }
+  SendHits(cc);
+  if (flush) {
+    // Next phrases are after the audio decoded so far.
+    while (segments_.size() > 1 &&
+           segments_[1].first_sample <= num_samples_) {
+      segments_.pop_front();
+    }
+  }
+  return absl::OkStatus();
+}
+
+void KeywordSpotterCalculator::SendHits(mediapipe::CalculatorContext *cc) {
+  for (const auto &hit : hits_) {
+    aikit::KeywordEvent event;
+    event.set_phrase(hit.phrase);
+    event.set_start_timestamp_us(TimestampUs(hit.start));
+    event.set_end_timestamp_us(TimestampUs(hit.end));
+    event.set_confidence(hit.conf);
+    ABSL_LOG(INFO) << "Spotted \"" << hit.phrase << "\" at "
+                   << event.start_timestamp_us() << " us";
+    // A chunk may complete several phrases, and a flush comes after the
+    // bound of the input which completed the chunk is already set.
+    auto timestamp = last_timestamp_;
+    if (next_timestamp_ != mediapipe::Timestamp::Unset() &&
+        timestamp < next_timestamp_) {
+      timestamp = next_timestamp_;
+    }
+    next_timestamp_ = timestamp.NextAllowedInStream();
+    kOutKeyword(cc).Send(std::move(event), timestamp);
+  }
+  hits_.clear();
+}
+
+int64_t KeywordSpotterCalculator::TimestampUs(float seconds) const {
+  const int64_t sample = std::llround(seconds * kSampleRate);
+  // The last segment which starts not after the sample.
+  auto segment = std::upper_bound(
+      segments_.begin(), segments_.end(), sample,
+      [](int64_t sample, const Segment &segment) {
+        return sample < segment.first_sample;
+      });
+  if (segment != segments_.begin()) {
+    --segment;
+  }
+  return segment->timestamp_us +
+         (sample - segment->first_sample) * 1000000 / kSampleRate;
+}
+
+} // namespace aikit
@@ -1,5 +1,6 @@
 
 #include <memory>
+#include "absl/log/absl_log.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/packet.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -15,10 +16,14 @@ namespace aikit {
 // This Calculator applies OCR
 // model to the given frames.
 //
+// With a non-empty ORT_PROFILE_PREFIX the ops of the model are profiled
+// to <ORT_PROFILE_PREFIX>_ocr_<date>.json, written on Close.
+//
 // Example config:
 // node {
 //   calculator: "OCRCalculator"
 //   input_side_packet: "OCR_MODEL_PATH:ocr_model_path"
+//   input_side_packet: "ORT_PROFILE_PREFIX:ort_profile_prefix"
 //   input_stream: "IMAGE_FRAME:image_frame"
 //   output_stream: "STRING:string"
 // }
@@ -26,14 +31,18 @@ class OCRCalculator : public mediapipe::api2::Node {
 public:
   static constexpr mediapipe::api2::SideInput<std::string> kInOCRModelPath{
       "OCR_MODEL_PATH"};
+  static constexpr mediapipe::api2::SideInput<std::string>::Optional
+      kInOrtProfilePrefix{"ORT_PROFILE_PREFIX"};
   static constexpr mediapipe::api2::Input<mediapipe::ImageFrame> kInImage{
       "IMAGE_FRAME"};
   static constexpr mediapipe::api2::Output<std::string> kOutDetections{
       "STRING"};
-  MEDIAPIPE_NODE_CONTRACT(kInOCRModelPath, kInImage, kOutDetections);
+  MEDIAPIPE_NODE_CONTRACT(kInOCRModelPath, kInOrtProfilePrefix, kInImage,
+                          kOutDetections);
 
   absl::Status Open(mediapipe::CalculatorContext *cc) override;
   absl::Status Process(mediapipe::CalculatorContext *cc) override;
+  absl::Status Close(mediapipe::CalculatorContext *cc) override;
 
 private:
   std::unique_ptr<ml::OCR> model_;
@@ -42,7 +51,13 @@ MEDIAPIPE_REGISTER_NODE(OCRCalculator);
 
 absl::Status OCRCalculator::Open(mediapipe::CalculatorContext *cc) {
   const std::string &model_path = kInOCRModelPath(cc).Get();
-  model_ = std::make_unique<ml::OCR>(model_path);
+  ml::OCROptions options;
+  if (kInOrtProfilePrefix(cc).IsConnected() &&
+      !kInOrtProfilePrefix(cc).IsEmpty() &&
+      !kInOrtProfilePrefix(cc).Get().empty()) {
+    options.profile_prefix = kInOrtProfilePrefix(cc).Get() + "_ocr";
+  }
+  model_ = std::make_unique<ml::OCR>(model_path, options);
 
   return absl::OkStatus();
 }
@@ -61,4 +76,14 @@ absl::Status OCRCalculator::Process(mediapipe::CalculatorContext *cc) {
   return absl::OkStatus();
 }
 
+absl::Status OCRCalculator::Close(mediapipe::CalculatorContext *cc) {
+  if (model_) {
+    const auto profile = model_->EndProfiling();
+    if (!profile.empty()) {
+      ABSL_LOG(INFO) << "OCR profile written to " << profile;
+    }
+  }
+  return absl::OkStatus();
+}
+
 } // namespace aikit
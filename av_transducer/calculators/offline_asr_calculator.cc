@@ -0,0 +1,224 @@
+#include "absl/log/absl_log.h"
+#include "absl/time/clock.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "ml/asr/offline.h"
+#include "ml/asr/profile.h"
+#include "av_transducer/utils/audio.h"
+#include "av_transducer/formats/asr.pb.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace aikit {
+
+// This Calculator transcribes a recording of 16kHz mono audio (S16 or
+// FLT) on all cores, it's the counterpart of ASRCalculator for files.
+//
+// AUDIO is collected in memory (about 115 MB per hour) and transcribed
+// when the stream is closed: the recording is split on silence and the
+// segments are decoded concurrently by NUM_WORKERS recognizers (all
+// cores by default), see ml::TranscribeOffline. So results come only at
+// the end, but the whole file takes a fraction of its duration.
+//
+// Results are sent to ASR_RESULT in the order of time, at the timestamp
+// of the end of their last word. Words have timestamps of the input
+// media timeline, the gaps in AUDIO are taken into account. Speaker
+// embeddings are kept, so DiarizationCalculator can follow. There are no
+// partial results, PARTIAL_ASR_RESULT is declared only to match the
+// interface of ASRCalculator.
+//
+// PROFILE is "offline-accurate" by default, its chunk size and decoder
+// search apply (see ml::ASRProfile), long speech is cut into utterances
+// of at most its endpoint_max_utterance.
+//
+// Example config:
+// node {
+//   calculator: "OfflineASRCalculator"
+//   input_side_packet: "ASR_MODEL_PATH:asr_model_path"
+//   input_side_packet: "SPK_MODEL_PATH:spk_model_path"
+//   input_side_packet: "PROFILE:asr_profile"
+//   input_side_packet: "NUM_WORKERS:asr_num_workers"
+//   input_stream: "AUDIO:audio"
+//   output_stream: "ASR_RESULT:asr_result"
+// }
+class OfflineASRCalculator : public mediapipe::api2::Node {
+public:
+  static constexpr mediapipe::api2::SideInput<std::string> kInASRModelPath{
+      "ASR_MODEL_PATH"};
+  static constexpr mediapipe::api2::SideInput<std::string> kInSPKModelPath{
+      "SPK_MODEL_PATH"};
+  static constexpr mediapipe::api2::SideInput<std::string>::Optional
+      kInProfile{"PROFILE"};
+  static constexpr mediapipe::api2::SideInput<int>::Optional kInNumWorkers{
+      "NUM_WORKERS"};
+  static constexpr mediapipe::api2::Input<media::AudioFrame> kInAudio{"AUDIO"};
+  static constexpr mediapipe::api2::Output<aikit::ASRResult> kOutASRResult{
+      "ASR_RESULT"};
+  static constexpr mediapipe::api2::Output<aikit::ASRPartialResult>::Optional
+      kOutPartialASRResult{"PARTIAL_ASR_RESULT"};
+  MEDIAPIPE_NODE_CONTRACT(kInASRModelPath, kInSPKModelPath, kInProfile,
+                          kInNumWorkers, kInAudio, kOutASRResult,
+                          kOutPartialASRResult,
+                          mediapipe::api2::TimestampChange::Arbitrary());
+
+  absl::Status Open(mediapipe::CalculatorContext *cc) override;
+  absl::Status Process(mediapipe::CalculatorContext *cc) override;
+  absl::Status Close(mediapipe::CalculatorContext *cc) override;
+
+private:
+  // Position of the sample `first_sample` on the input timeline.
+  struct Segment {
+    int64_t first_sample;
+    int64_t timestamp_us;
+  };
+
+  absl::Status AppendAudio(mediapipe::CalculatorContext *cc,
+                           const media::AudioFrame &audio_frame);
+  int64_t TimestampUs(float seconds) const;
+
+  ml::OfflineASROptions options_;
+  std::vector<int16_t> audio_;
+  std::vector<float> float_buffer_;
+  std::vector<Segment> segments_;
+
+  static constexpr int kSampleRate = 16000;
+};
+MEDIAPIPE_REGISTER_NODE(OfflineASRCalculator);
+
+absl::Status OfflineASRCalculator::Open(mediapipe::CalculatorContext *cc) {
+  std::string profile_name = "offline-accurate";
+  if (kInProfile(cc).IsConnected() && !kInProfile(cc).IsEmpty()) {
+    profile_name = kInProfile(cc).Get();
+  }
+  auto profile = ml::GetASRProfile(profile_name);
+  if (!profile.ok()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << profile.status().message();
+  }
+  auto model_path =
+      ml::PrepareModelForProfile(kInASRModelPath(cc).Get(), profile.value());
+  if (!model_path.ok()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Failed to apply ASR profile " << profile_name << ": "
+           << model_path.status().message();
+  }
+
+  options_.model_path = model_path.value();
+  options_.spk_model_path = kInSPKModelPath(cc).Get();
+  options_.sample_rate = kSampleRate;
+  options_.chunk_ms = profile->chunk_ms;
+  if (profile->endpoint_max_utterance.has_value()) {
+    options_.split.max_segment_sec = profile->endpoint_max_utterance.value();
+  }
+  if (kInNumWorkers(cc).IsConnected() && !kInNumWorkers(cc).IsEmpty() &&
+      kInNumWorkers(cc).Get() > 0) {
+    options_.num_workers = kInNumWorkers(cc).Get();
+  }
+  ABSL_LOG(INFO) << "Offline ASR profile " << profile_name << ", model "
+                 << options_.model_path << ", " << options_.num_workers
+                 << " workers";
+  return absl::OkStatus();
+}
+
+absl::Status OfflineASRCalculator::Process(mediapipe::CalculatorContext *cc) {
+  if (kInAudio(cc).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  return AppendAudio(cc, kInAudio(cc).Get());
+}
+
+absl::Status OfflineASRCalculator::Close(mediapipe::CalculatorContext *cc) {
+  if (audio_.empty()) {
+    return absl::OkStatus();
+  }
+  const auto start = absl::Now();
+  auto results = ml::TranscribeOffline(audio_, options_);
+  if (!results.ok()) {
+    return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+           << results.status().message();
+  }
+  const auto elapsed = absl::Now() - start;
+  ABSL_LOG(INFO) << "Transcribed " << audio_.size() / kSampleRate << " s in "
+                 << elapsed << ", real time factor "
+                 << absl::ToDoubleSeconds(elapsed) * kSampleRate /
+                        audio_.size();
+
+  mediapipe::Timestamp last_timestamp = mediapipe::Timestamp::Unset();
+  for (const auto &result : results.value()) {
+    aikit::ASRResult asr_result;
+    asr_result.set_transcription(result.text);
+    asr_result.mutable_spk_embedding()->Assign(result.spk_embedding.begin(),
+                                               result.spk_embedding.end());
+    int64_t end_us = 0;
+    for (const auto &word : result.words) {
+      auto *asr_word = asr_result.add_words();
+      asr_word->set_word(word.word);
+      asr_word->set_start_timestamp_us(TimestampUs(word.start));
+      asr_word->set_end_timestamp_us(TimestampUs(word.end));
+      asr_word->set_confidence(word.conf);
+      end_us = std::max(end_us, asr_word->end_timestamp_us());
+    }
+
+    auto timestamp = mediapipe::Timestamp(end_us);
+    if (last_timestamp != mediapipe::Timestamp::Unset() &&
+        timestamp <= last_timestamp) {
+      timestamp = last_timestamp.NextAllowedInStream();
+    }
+    last_timestamp = timestamp;
+    kOutASRResult(cc).Send(std::move(asr_result), timestamp);
+  }
+  audio_ = std::vector<int16_t>();
+  return absl::OkStatus();
+}
+
+absl::Status OfflineASRCalculator::AppendAudio(
+    mediapipe::CalculatorContext *cc, const media::AudioFrame &audio_frame) {
+  const int64_t first_sample = audio_.size();
+  const int64_t timestamp_us = cc->InputTimestamp().Microseconds();
+  // Continuous audio needs no new segment.
+  const bool continues =
+      !segments_.empty() &&
+      std::abs(segments_.back().timestamp_us +
+               (first_sample - segments_.back().first_sample) * 1000000 /
+                   kSampleRate -
+               timestamp_us) <= 1000000 / kSampleRate;
+  if (!continues) {
+    segments_.push_back({first_sample, timestamp_us});
+  }
+
+  const auto format = audio_frame.c_frame()->format;
+  if (format == AV_SAMPLE_FMT_S16 || format == AV_SAMPLE_FMT_S16P) {
+    return audio_frame.AppendAudioData(audio_);
+  }
+  float_buffer_.clear();
+  auto status = audio_frame.AppendAudioData(float_buffer_);
+  if (!status.ok()) {
+    return status;
+  }
+  std::transform(float_buffer_.begin(), float_buffer_.end(),
+                 std::back_inserter(audio_), [](float x) {
+                   return static_cast<int16_t>(std::clamp(x, -1.0f, 1.0f) *
+                                               32767.0f);
+                 });
+  return absl::OkStatus();
+}
+
+int64_t OfflineASRCalculator::TimestampUs(float seconds) const {
+  const int64_t sample = std::llround(seconds * kSampleRate);
+  // The last segment which starts not after the sample.
+  auto segment = std::upper_bound(
+      segments_.begin(), segments_.end(), sample,
+      [](int64_t sample, const Segment &segment) {
+        return sample < segment.first_sample;
+      });
+  if (segment != segments_.begin()) {
+    --segment;
+  }
+  return segment->timestamp_us +
+         (sample - segment->first_sample) * 1000000 / kSampleRate;
+}
+
+} // namespace aikit
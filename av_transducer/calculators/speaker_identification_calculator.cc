@@ -0,0 +1,101 @@
+#include "absl/log/absl_log.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "ml/diarization/speaker_index.h"
+#include "av_transducer/formats/asr.pb.h"
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace aikit {
+
+// This Calculator sets the speaker_name and speaker_score of ASR results.
+//
+// The speaker embedding of the result is looked up in the speaker index
+// at INDEX_PATH (see ml::SpeakerIndex), which keeps the voices of the
+// people enrolled in the earlier meetings. The nearest voice is attached
+// if its cosine similarity is at least MIN_SCORE (0.5 by default).
+// Results are forwarded as they are if INDEX_PATH is empty or not
+// connected, or the result has no embedding.
+//
+// Example config:
+// node {
+//   calculator: "SpeakerIdentificationCalculator"
+//   input_side_packet: "INDEX_PATH:speaker_index_path"
+//   input_side_packet: "MIN_SCORE:speaker_min_score"
+//   input_stream: "ASR_RESULT:asr_result"
+//   output_stream: "ASR_RESULT:identified_asr_result"
+// }
+class SpeakerIdentificationCalculator : public mediapipe::api2::Node {
+public:
+  static constexpr mediapipe::api2::SideInput<std::string>::Optional
+      kInIndexPath{"INDEX_PATH"};
+  static constexpr mediapipe::api2::SideInput<float>::Optional kInMinScore{
+      "MIN_SCORE"};
+  static constexpr mediapipe::api2::Input<ASRResult> kInASRResult{
+      "ASR_RESULT"};
+  static constexpr mediapipe::api2::Output<ASRResult> kOutASRResult{
+      "ASR_RESULT"};
+  MEDIAPIPE_NODE_CONTRACT(kInIndexPath, kInMinScore, kInASRResult,
+                          kOutASRResult);
+
+  absl::Status Open(mediapipe::CalculatorContext *cc) override;
+  absl::Status Process(mediapipe::CalculatorContext *cc) override;
+
+private:
+  std::string index_path_;
+  float min_score_ = 0.5f;
+  // Opened on the first embedding, its size depends on the speaker model.
+  std::optional<ml::SpeakerIndex> index_;
+  std::vector<ml::SpeakerMatch> matches_;
+};
+MEDIAPIPE_REGISTER_NODE(SpeakerIdentificationCalculator);
+
+absl::Status
+SpeakerIdentificationCalculator::Open(mediapipe::CalculatorContext *cc) {
+  if (kInIndexPath(cc).IsConnected() && !kInIndexPath(cc).IsEmpty()) {
+    index_path_ = kInIndexPath(cc).Get();
+  }
+  if (kInMinScore(cc).IsConnected() && !kInMinScore(cc).IsEmpty()) {
+    min_score_ = kInMinScore(cc).Get();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status
+SpeakerIdentificationCalculator::Process(mediapipe::CalculatorContext *cc) {
+  const auto &embedding = kInASRResult(cc).Get().spk_embedding();
+  if (index_path_.empty() || embedding.empty()) {
+    kOutASRResult(cc).Send(kInASRResult(cc).packet());
+    return absl::OkStatus();
+  }
+  if (!index_) {
+    auto index = ml::SpeakerIndex::Open(
+        index_path_, {.embedding_size = embedding.size()});
+    if (!index.ok()) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << index.status().message();
+    }
+    index_.emplace(std::move(index).value());
+    ABSL_LOG(INFO) << "Speaker index " << index_path_ << " has "
+                   << index_->size() << " voices";
+  }
+
+  auto status = index_->Search(
+      absl::MakeConstSpan(embedding.data(), embedding.size()), 1, matches_);
+  if (!status.ok()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << status.message();
+  }
+  if (matches_.empty() || matches_[0].score < min_score_) {
+    kOutASRResult(cc).Send(kInASRResult(cc).packet());
+    return absl::OkStatus();
+  }
+  ASRResult asr_result = kInASRResult(cc).Get();
+  asr_result.set_speaker_name(std::string(matches_[0].name));
+  asr_result.set_speaker_score(matches_[0].score);
+  kOutASRResult(cc).Send(std::move(asr_result));
+  return absl::OkStatus();
+}
+
+} // namespace aikit
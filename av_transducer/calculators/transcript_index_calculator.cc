@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <grpcpp/security/server_credentials.h>
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/log/absl_log.h"
+#include "absl/strings/str_split.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/packet.h"
+
+#include "av_transducer/formats/asr.pb.h"
+#include "meeting_bot/evaluator/evaluator.grpc.pb.h"
+#include "ml/asr/transcript_index.h"
+
+namespace aikit {
+
+namespace {
+// Answers the searches of the evaluator from the gRPC threads.
+class TranscriptService : public aikit::evaluator::Transcript::Service {
+public:
+  explicit TranscriptService(const ml::TranscriptIndex &index)
+      : index_(index) {}
+
+  grpc::Status Search(grpc::ServerContext *context,
+                      const aikit::evaluator::TranscriptSearchRequest *request,
+                      aikit::evaluator::TranscriptSearchReply *reply) override {
+    const int64_t to_timestamp = request->to_timestamp() > 0
+                                     ? request->to_timestamp()
+                                     : std::numeric_limits<int64_t>::max();
+    std::vector<ml::TranscriptHit> hits;
+    const auto num_hits = index_.Search(
+        request->phrase(), request->from_timestamp(), to_timestamp,
+        std::max(request->max_hits(), 0), hits);
+    // Saturates, num_hits of the reply is int32.
+    reply->set_num_hits(static_cast<int32_t>(std::min<size_t>(
+        num_hits, std::numeric_limits<int32_t>::max())));
+    for (const auto &hit : hits) {
+      auto *h = reply->add_hits();
+      h->set_start_timestamp(hit.start_us);
+      h->set_end_timestamp(hit.end_us);
+      h->set_speaker_id(hit.speaker_id);
+      h->set_speaker_name(hit.speaker_name);
+    }
+    return grpc::Status::OK;
+  }
+
+private:
+  const ml::TranscriptIndex &index_;
+};
+} // namespace
+
+// This Calculator indexes the words of ASR results and serves phrase
+// searches of the transcript over gRPC (aikit.evaluator.Transcript).
+//
+// The index is updated as the results arrive (see ml::TranscriptIndex),
+// so the evaluator queries the whole meeting so far without keeping and
+// rescanning the text. The service listens at ADDRESS, e.g.
+// unix:///tmp/transcript.sock, it's not started if ADDRESS is empty or
+// not connected. The words of results without word timestamps are
+// indexed at the timestamp of the result.
+//
+// Example config:
+// node {
+//   calculator: "TranscriptIndexCalculator"
+//   input_side_packet: "ADDRESS:transcript_address"
+//   input_stream: "ASR_RESULT:asr_result"
+// }
+class TranscriptIndexCalculator : public mediapipe::api2::Node {
+public:
+  static constexpr mediapipe::api2::SideInput<std::string>::Optional
+      kInAddress{"ADDRESS"};
+  static constexpr mediapipe::api2::Input<ASRResult> kInASRResult{
+      "ASR_RESULT"};
+  MEDIAPIPE_NODE_CONTRACT(kInAddress, kInASRResult);
+
+  absl::Status Open(mediapipe::CalculatorContext *cc) override;
+  absl::Status Process(mediapipe::CalculatorContext *cc) override;
+  absl::Status Close(mediapipe::CalculatorContext *cc) override;
+
+private:
+  ml::TranscriptIndex index_;
+  TranscriptService service_{index_};
+  std::unique_ptr<grpc::Server> server_;
+  std::vector<ml::TranscriptWord> words_;
+};
+MEDIAPIPE_REGISTER_NODE(TranscriptIndexCalculator);
+
+absl::Status TranscriptIndexCalculator::Open(mediapipe::CalculatorContext *cc) {
+  if (!kInAddress(cc).IsConnected() || kInAddress(cc).IsEmpty() ||
+      kInAddress(cc).Get().empty()) {
+    return absl::OkStatus();
+  }
+  const auto &address = kInAddress(cc).Get();
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort(address, grpc::InsecureServerCredentials());
+  builder.RegisterService(&service_);
+  server_ = builder.BuildAndStart();
+  if (!server_) {
+    return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+           << "Can't start the transcript service at " << address;
+  }
+  ABSL_LOG(INFO) << "Transcript service started at " << address;
+  return absl::OkStatus();
+}
+
+absl::Status
+TranscriptIndexCalculator::Process(mediapipe::CalculatorContext *cc) {
+  const auto &asr_result = kInASRResult(cc).Get();
+  words_.clear();
+  if (asr_result.words().empty()) {
+    const int64_t timestamp = cc->InputTimestamp().Microseconds();
+    for (absl::string_view word :
+         absl::StrSplit(asr_result.transcription(), ' ', absl::SkipEmpty())) {
+      words_.push_back({word, timestamp, timestamp});
+    }
+  } else {
+    for (const auto &word : asr_result.words()) {
+      words_.push_back(
+          {word.word(), word.start_timestamp_us(), word.end_timestamp_us()});
+    }
+  }
+  index_.Add(words_, asr_result.speaker_id(), asr_result.speaker_name());
+  return absl::OkStatus();
+}
+
+absl::Status TranscriptIndexCalculator::Close(mediapipe::CalculatorContext *cc) {
+  if (server_) {
+    server_->Shutdown();
+    server_.reset();
+  }
+  ABSL_LOG(INFO) << "Transcript index has " << index_.num_words()
+                 << " words of " << index_.num_utterances() << " utterances";
+  return absl::OkStatus();
+}
+
+} // namespace aikit
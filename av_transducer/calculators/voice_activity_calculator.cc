@@ -0,0 +1,126 @@
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "av_transducer/utils/audio.h"
+#include "av_transducer/utils/vad.h"
+#include <deque>
+#include <optional>
+
+namespace aikit {
+
+// This Calculator drops audio frames without speech.
+//
+// Every input frame gets the speech activity decision in SPEECH_ACTIVITY.
+// Frames with speech (including hangover after it) are passed to AUDIO,
+// together with the frames of PREROLL_MS before the speech start, so
+// the beginning of the first word is not cut. Frames are forwarded as
+// is, they keep their timestamps.
+//
+// Supports mono S16 and FLT frames.
+//
+// Example config:
+// node {
+//   calculator: "VoiceActivityCalculator"
+//   input_side_packet: "HANGOVER_MS:hangover_ms"
+//   input_side_packet: "PREROLL_MS:preroll_ms"
+//   input_stream: "AUDIO:audio"
+//   output_stream: "AUDIO:speech_audio"
+//   output_stream: "SPEECH_ACTIVITY:speech_activity"
+// }
+class VoiceActivityCalculator : public mediapipe::api2::Node {
+public:
+  static constexpr mediapipe::api2::SideInput<int>::Optional kInHangoverMs{
+      "HANGOVER_MS"};
+  static constexpr mediapipe::api2::SideInput<int>::Optional kInPrerollMs{
+      "PREROLL_MS"};
+  static constexpr mediapipe::api2::Input<media::AudioFrame> kInAudio{"AUDIO"};
+  static constexpr mediapipe::api2::Output<media::AudioFrame> kOutAudio{
+      "AUDIO"};
+  static constexpr mediapipe::api2::Output<bool>::Optional kOutSpeechActivity{
+      "SPEECH_ACTIVITY"};
+  MEDIAPIPE_NODE_CONTRACT(kInHangoverMs, kInPrerollMs, kInAudio, kOutAudio,
+                          kOutSpeechActivity,
+                          mediapipe::api2::TimestampChange::Arbitrary());
+
+  absl::Status Open(mediapipe::CalculatorContext *cc) override;
+  absl::Status Process(mediapipe::CalculatorContext *cc) override;
+
+private:
+  std::optional<media::VoiceActivityDetector> vad_;
+  int64_t preroll_us_ = 0;
+  // Recent frames without speech, sent if speech starts soon.
+  std::deque<mediapipe::api2::Packet<media::AudioFrame>> preroll_;
+
+  static constexpr int kDefaultPrerollMs = 300;
+};
+MEDIAPIPE_REGISTER_NODE(VoiceActivityCalculator);
+
+absl::Status VoiceActivityCalculator::Open(mediapipe::CalculatorContext *cc) {
+  media::VoiceActivityDetectorOptions options;
+  if (kInHangoverMs(cc).IsConnected() && !kInHangoverMs(cc).IsEmpty()) {
+    options.hangover_ms = kInHangoverMs(cc).Get();
+  }
+  int preroll_ms = kDefaultPrerollMs;
+  if (kInPrerollMs(cc).IsConnected() && !kInPrerollMs(cc).IsEmpty()) {
+    preroll_ms = kInPrerollMs(cc).Get();
+  }
+  preroll_us_ = static_cast<int64_t>(preroll_ms) * 1000;
+  vad_.emplace(options);
+  return absl::OkStatus();
+}
+
+absl::Status VoiceActivityCalculator::Process(mediapipe::CalculatorContext *cc) {
+  const auto &audio_frame = kInAudio(cc).Get();
+  const auto *c_frame = audio_frame.c_frame();
+  if (c_frame->ch_layout.nb_channels != 1) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Voice activity detection expects mono audio.";
+  }
+
+  bool is_active = false;
+  switch (c_frame->format) {
+  case AV_SAMPLE_FMT_S16:
+  case AV_SAMPLE_FMT_S16P:
+    is_active = vad_->Process(
+        reinterpret_cast<const int16_t *>(c_frame->extended_data[0]),
+        c_frame->nb_samples);
+    break;
+  case AV_SAMPLE_FMT_FLT:
+  case AV_SAMPLE_FMT_FLTP:
+    is_active = vad_->Process(
+        reinterpret_cast<const float *>(c_frame->extended_data[0]),
+        c_frame->nb_samples);
+    break;
+  default:
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Voice activity detection supports only S16 and FLT audio.";
+  }
+
+  kOutSpeechActivity(cc).Send(is_active);
+
+  if (is_active) {
+    while (!preroll_.empty()) {
+      kOutAudio(cc).Send(std::move(preroll_.front()));
+      preroll_.pop_front();
+    }
+    kOutAudio(cc).Send(kInAudio(cc).packet());
+    return absl::OkStatus();
+  }
+
+  preroll_.push_back(kInAudio(cc).packet());
+  while (!preroll_.empty() &&
+         (cc->InputTimestamp() - preroll_.front().Timestamp()).Value() >=
+             preroll_us_) {
+    preroll_.pop_front();
+  }
+  // Frames of the preroll may still be sent, so downstream can't
+  // go further than the oldest of them.
+  if (preroll_.empty()) {
+    kOutAudio(cc).SetNextTimestampBound(
+        cc->InputTimestamp().NextAllowedInStream());
+  } else {
+    kOutAudio(cc).SetNextTimestampBound(preroll_.front().Timestamp());
+  }
+  return absl::OkStatus();
+}
+
+} // namespace aikit
@@ -0,0 +1,257 @@
+#include "absl/log/absl_log.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "ml/whisper/model.h"
+#include "ml/whisper/transcript.h"
+#include "av_transducer/utils/audio.h"
+#include "av_transducer/formats/asr.pb.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace aikit {
+
+// This Calculator transcribes speech with Whisper, it can be used in
+// place of ASRCalculator.
+//
+// AUDIO must be 16kHz mono, S16 or FLT. Audio is decoded in 30 s windows.
+// Segments which end in the last OVERLAP_SEC of a window are not sent,
+// the next window starts at the end of the last sent segment, so words
+// cut by the window border are decoded again with the full context, see
+// ml::CommitWhisperSegments.
+// Results are sent to ASR_RESULT, one per segment, at the timestamp of
+// the segment end. The timestamp bound of ASR_RESULT follows the oldest
+// buffered sample, so the nodes downstream don't wait for a window to be
+// decoded. Whisper has no partial results, there is no PARTIAL_ASR_RESULT.
+//
+// If SPEECH_ACTIVITY is connected, the buffered audio is decoded as soon
+// as the speech activity ends, without waiting for the window to fill up.
+//
+// Example config:
+// node {
+//   calculator: "WhisperCalculator"
+//   input_side_packet: "MODEL_PATH:whisper_model_path"
+//   input_side_packet: "OVERLAP_SEC:whisper_overlap_sec"
+//   input_side_packet: "NUM_THREADS:whisper_num_threads"
+//   input_stream: "AUDIO:audio"
+//   input_stream: "SPEECH_ACTIVITY:speech_activity"
+//   output_stream: "ASR_RESULT:asr_result"
+// }
+class WhisperCalculator : public mediapipe::api2::Node {
+public:
+  static constexpr mediapipe::api2::SideInput<std::string> kInModelPath{
+      "MODEL_PATH"};
+  static constexpr mediapipe::api2::SideInput<float>::Optional kInOverlapSec{
+      "OVERLAP_SEC"};
+  static constexpr mediapipe::api2::SideInput<int>::Optional kInNumThreads{
+      "NUM_THREADS"};
+  static constexpr mediapipe::api2::Input<media::AudioFrame> kInAudio{"AUDIO"};
+  static constexpr mediapipe::api2::Input<bool>::Optional kInSpeechActivity{
+      "SPEECH_ACTIVITY"};
+  static constexpr mediapipe::api2::Output<aikit::ASRResult> kOutASRResult{
+      "ASR_RESULT"};
+  MEDIAPIPE_NODE_CONTRACT(kInModelPath, kInOverlapSec, kInNumThreads, kInAudio,
+                          kInSpeechActivity, kOutASRResult,
+                          mediapipe::api2::TimestampChange::Arbitrary());
+
+  absl::Status Open(mediapipe::CalculatorContext *cc) override;
+  absl::Status Process(mediapipe::CalculatorContext *cc) override;
+  absl::Status Close(mediapipe::CalculatorContext *cc) override;
+
+private:
+  // Position of the buffer sample `offset` on the input timeline.
+  struct Segment {
+    size_t offset;
+    int64_t timestamp_us;
+  };
+
+  absl::Status AppendAudio(mediapipe::CalculatorContext *cc,
+                           const media::AudioFrame &audio_frame);
+  // Decodes the buffered audio, `flush` sends all the segments.
+  absl::Status Decode(mediapipe::CalculatorContext *cc, bool flush);
+  // Results come at the timestamps of the buffered samples or later.
+  void UpdateTimestampBound(mediapipe::CalculatorContext *cc);
+  int64_t TimestampUs(size_t offset) const;
+  // Drops the first `num_samples` of the buffer.
+  void Consume(size_t num_samples);
+
+  std::unique_ptr<ml::Whisper> model_;
+  std::vector<float> buffer_;
+  std::vector<Segment> segments_;
+  float overlap_sec_ = kDefaultOverlapSec;
+  bool speech_active_ = false;
+  mediapipe::Timestamp last_result_timestamp_ = mediapipe::Timestamp::Unset();
+
+  static constexpr float kDefaultOverlapSec = 5.0f;
+  static constexpr size_t kWindowSize =
+      static_cast<size_t>(ml::Whisper::kWindowSec * ml::Whisper::kSampleRate);
+};
+MEDIAPIPE_REGISTER_NODE(WhisperCalculator);
+
+absl::Status WhisperCalculator::Open(mediapipe::CalculatorContext *cc) {
+  ml::WhisperOptions options;
+  if (kInNumThreads(cc).IsConnected() && !kInNumThreads(cc).IsEmpty()) {
+    options.num_threads = kInNumThreads(cc).Get();
+  }
+  if (kInOverlapSec(cc).IsConnected() && !kInOverlapSec(cc).IsEmpty()) {
+    overlap_sec_ = kInOverlapSec(cc).Get();
+  }
+  if (overlap_sec_ < 0.0f || overlap_sec_ >= ml::Whisper::kWindowSec / 2) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "OVERLAP_SEC must be in [0, " << ml::Whisper::kWindowSec / 2
+           << ").";
+  }
+  model_ = std::make_unique<ml::Whisper>(kInModelPath(cc).Get(), options);
+  buffer_.reserve(kWindowSize);
+  return absl::OkStatus();
+}
+
+absl::Status WhisperCalculator::Process(mediapipe::CalculatorContext *cc) {
+  if (!kInAudio(cc).IsEmpty()) {
+    auto status = AppendAudio(cc, kInAudio(cc).Get());
+    if (!status.ok()) {
+      return status;
+    }
+    while (buffer_.size() >= kWindowSize) {
+      status = Decode(cc, /*flush=*/false);
+      if (!status.ok()) {
+        return status;
+      }
+    }
+  }
+
+  if (kInSpeechActivity(cc).IsConnected() &&
+      !kInSpeechActivity(cc).IsEmpty()) {
+    const bool speech_active = kInSpeechActivity(cc).Get();
+    if (speech_active_ && !speech_active && !buffer_.empty()) {
+      auto status = Decode(cc, /*flush=*/true);
+      if (!status.ok()) {
+        return status;
+      }
+    }
+    speech_active_ = speech_active;
+  }
+  UpdateTimestampBound(cc);
+  return absl::OkStatus();
+}
+
+absl::Status WhisperCalculator::Close(mediapipe::CalculatorContext *cc) {
+  if (!buffer_.empty()) {
+    auto status = Decode(cc, /*flush=*/true);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  model_.reset();
+  return absl::OkStatus();
+}
+
+absl::Status
+WhisperCalculator::AppendAudio(mediapipe::CalculatorContext *cc,
+                               const media::AudioFrame &audio_frame) {
+  const auto *c_frame = audio_frame.c_frame();
+  if (c_frame->ch_layout.nb_channels != 1 ||
+      c_frame->sample_rate != ml::Whisper::kSampleRate) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Whisper expects 16kHz mono audio.";
+  }
+  segments_.push_back({buffer_.size(), cc->InputTimestamp().Microseconds()});
+  if (c_frame->format == AV_SAMPLE_FMT_S16 ||
+      c_frame->format == AV_SAMPLE_FMT_S16P) {
+    std::vector<int16_t> pcm;
+    auto status = audio_frame.AppendAudioData(pcm);
+    if (!status.ok()) {
+      return status;
+    }
+    std::transform(pcm.begin(), pcm.end(), std::back_inserter(buffer_),
+                   [](int16_t x) { return x / 32768.0f; });
+    return absl::OkStatus();
+  }
+  return audio_frame.AppendAudioData(buffer_);
+}
+
+absl::Status WhisperCalculator::Decode(mediapipe::CalculatorContext *cc,
+                                       bool flush) {
+  const size_t window_size = std::min(buffer_.size(), kWindowSize);
+  auto segments = (*model_)(absl::MakeConstSpan(buffer_.data(), window_size));
+  if (!segments.ok()) {
+    return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+           << segments.status().message();
+  }
+
+  // Segments ending in the overlap may be cut, they are decoded again
+  // in the next window.
+  const float window_sec =
+      static_cast<float>(window_size) / ml::Whisper::kSampleRate;
+  const auto commit =
+      flush ? ml::WhisperCommit{segments->size(), window_sec}
+            : ml::CommitWhisperSegments(segments.value(),
+                                        window_sec - overlap_sec_);
+  for (size_t i = 0; i < commit.num_segments; ++i) {
+    const auto &segment = (*segments)[i];
+    const size_t end_offset = std::min(
+        window_size,
+        static_cast<size_t>(segment.end * ml::Whisper::kSampleRate));
+    aikit::ASRResult asr_result;
+    asr_result.set_transcription(segment.text);
+
+    auto timestamp = mediapipe::Timestamp(TimestampUs(end_offset));
+    if (last_result_timestamp_ != mediapipe::Timestamp::Unset() &&
+        timestamp <= last_result_timestamp_) {
+      timestamp = last_result_timestamp_.NextAllowedInStream();
+    }
+    last_result_timestamp_ = timestamp;
+    kOutASRResult(cc).Send(std::move(asr_result), timestamp);
+  }
+  Consume(flush ? window_size
+                : std::min(window_size,
+                           static_cast<size_t>(commit.end_sec *
+                                               ml::Whisper::kSampleRate)));
+  return absl::OkStatus();
+}
+
+void WhisperCalculator::UpdateTimestampBound(
+    mediapipe::CalculatorContext *cc) {
+  auto bound = buffer_.empty() ? cc->InputTimestamp()
+                               : mediapipe::Timestamp(TimestampUs(0));
+  if (last_result_timestamp_ != mediapipe::Timestamp::Unset()) {
+    bound = std::max(bound, last_result_timestamp_.NextAllowedInStream());
+  }
+  kOutASRResult(cc).SetNextTimestampBound(bound);
+}
+
+int64_t WhisperCalculator::TimestampUs(size_t offset) const {
+  auto segment = std::upper_bound(
+      segments_.begin(), segments_.end(), offset,
+      [](size_t offset, const Segment &segment) {
+        return offset < segment.offset;
+      });
+  if (segment == segments_.begin()) {
+    return 0;
+  }
+  --segment;
+  return segment->timestamp_us +
+         static_cast<int64_t>(offset - segment->offset) * 1000000 /
+             ml::Whisper::kSampleRate;
+}
+
+void WhisperCalculator::Consume(size_t num_samples) {
+  num_samples = std::min(num_samples, buffer_.size());
+  buffer_.erase(buffer_.begin(), buffer_.begin() + num_samples);
+
+  // The segment which contains the new first sample starts the timeline.
+  std::vector<Segment> segments;
+  for (const auto &segment : segments_) {
+    if (segment.offset <= num_samples) {
+      segments.assign(1, {0, TimestampUs(num_samples)});
+    } else {
+      segments.push_back({segment.offset - num_samples, segment.timestamp_us});
+    }
+  }
+  segments_ = std::move(segments);
+  if (buffer_.empty()) {
+    segments_.clear();
+  }
+}
+
+} // namespace aikit
@@ -8,11 +8,40 @@
 #include "mediapipe/framework/api2/builder.h"
 #include "mediapipe/framework/calculator_graph.h"
 #include "mediapipe/util/color.pb.h"
+#include "ml/common/ort_runtime.h"
 #include <string>
 
 ABSL_FLAG(std::string, input_file_path, "", "Full path of video to read.");
 ABSL_FLAG(std::string, output_file_path, "", "Full path of video to save.");
-ABSL_FLAG(bool, profile, false, "Full path of video to save.");
+ABSL_FLAG(bool, profile, false,
+          "Trace the calculators to /tmp/mediapipe_trace_*.binarypb and "
+          "profile the ops of the visual models, see tools/merge_traces.py.");
+ABSL_FLAG(int, asr_num_workers, 0,
+          "Number of recognizers transcribing the file in parallel, all "
+          "cores when 0.");
+ABSL_FLAG(std::string, speaker_index_path, "",
+          "Index of known voices to identify the speakers, made by "
+          "//ml/diarization:enroll_speaker. Empty for none.");
+ABSL_FLAG(int, ort_intra_op_threads, 0,
+          "Threads of the ONNX Runtime pool shared by the models, 0 for half "
+          "of the cores.");
+ABSL_FLAG(bool, ort_allow_spinning, false,
+          "Let idle ONNX Runtime threads spin waiting for work, it cuts the "
+          "latency but keeps the cores busy between the inferences.");
+ABSL_FLAG(std::string, ort_thread_affinity, "",
+          "Cores of the ONNX Runtime threads but the caller, e.g. \"1;2;3\" "
+          "for 4 threads. Empty to not pin them.");
+ABSL_FLAG(bool, ort_per_session_threads, false,
+          "Give every model its own ONNX Runtime thread pools instead of the "
+          "shared ones.");
+ABSL_FLAG(std::string, ort_optimized_model_dir, "/tmp/aikit_ort_models",
+          "Directory to keep the optimized visual models in, so they're "
+          "optimized on the first start only. Empty to optimize them on "
+          "every start.");
+ABSL_FLAG(std::string, ort_profile_prefix, "",
+          "Prefix of the ONNX Runtime profiles of the ops of CDetr and OCR, "
+          "e.g. /tmp/ort_profile. Empty to not profile them, unless "
+          "--profile is set, which uses /tmp/ort_profile.");
 
 mediapipe::CalculatorGraphConfig BuildGraph() {
   mediapipe::api2::builder::Graph graph;
@@ -51,12 +80,16 @@ mediapipe::CalculatorGraphConfig BuildGraph() {
           .SetName("ocr_model_path")
           .Cast<std::string>() >>
       visual_subgraph.SideIn("OCR_MODEL_PATH");
+  graph.SideIn("ORT_PROFILE_PREFIX")
+          .SetName("ort_profile_prefix")
+          .Cast<std::string>() >>
+      visual_subgraph.SideIn("ORT_PROFILE_PREFIX");
   yuv_video_stream >> visual_subgraph.In("IN_VIDEO");
   auto detections_stream = visual_subgraph.Out("DETECTIONS");
   auto speaker_name_stream = visual_subgraph.Out("STRING");
 
-  // audio
-  auto &audio_subgraph = graph.AddNode("AudioGraph");
+  // audio, the file is transcribed at once on all cores
+  auto &audio_subgraph = graph.AddNode("OfflineAudioGraph");
   audio_header >> audio_subgraph.SideIn("IN_AUDIO_HEADER");
   audio_stream >> audio_subgraph.In("IN_AUDIO");
     graph.SideIn("OUT_ASR_AUDIO_HEADER")
@@ -72,6 +105,18 @@ mediapipe::CalculatorGraphConfig BuildGraph() {
           .SetName("spk_model_path")
           .Cast<std::string>() >>
       audio_subgraph.SideIn("SPK_MODEL_PATH");
+  graph.SideIn("ASR_NUM_WORKERS")
+          .SetName("asr_num_workers")
+          .Cast<int>() >>
+      audio_subgraph.SideIn("ASR_NUM_WORKERS");
+  graph.SideIn("ASR_PROFILE")
+          .SetName("asr_profile")
+          .Cast<std::string>() >>
+      audio_subgraph.SideIn("ASR_PROFILE");
+  graph.SideIn("SPEAKER_INDEX_PATH")
+          .SetName("speaker_index_path")
+          .Cast<std::string>() >>
+      audio_subgraph.SideIn("SPEAKER_INDEX_PATH");
   auto transcription = audio_subgraph.Out("TRANSCRIPTION");
 
   // Debug graph
@@ -162,6 +207,8 @@ absl::Status RunMPPGraph() {
 
   aikit::media::AudioStreamParameters asr_audio_stream_parameters;
   asr_audio_stream_parameters.sample_rate = 16000;
+  // The recognizer consumes 16 bit PCM natively.
+  asr_audio_stream_parameters.format = AV_SAMPLE_FMT_S16;
   input_side_packets["out_asr_audio_header"] =
       mediapipe::MakePacket<aikit::media::AudioStreamParameters>(
           asr_audio_stream_parameters);
@@ -183,7 +230,14 @@ absl::Status RunMPPGraph() {
       mediapipe::MakePacket<std::string>("ml/asr/models/vosk-model-ru-0.42");
   input_side_packets["spk_model_path"] =
       mediapipe::MakePacket<std::string>("ml/asr/models/vosk-model-spk-0.4");
+  input_side_packets["asr_profile"] =
+      mediapipe::MakePacket<std::string>("offline-accurate");
+  input_side_packets["asr_num_workers"] =
+      mediapipe::MakePacket<int>(absl::GetFlag(FLAGS_asr_num_workers));
+  input_side_packets["speaker_index_path"] = mediapipe::MakePacket<std::string>(
+      absl::GetFlag(FLAGS_speaker_index_path));
 
+  std::string ort_profile_prefix = absl::GetFlag(FLAGS_ort_profile_prefix);
   if (absl::GetFlag(FLAGS_profile)) {
     // Enable profiling
     mediapipe::ProfilerConfig *profilerConfig =
@@ -192,7 +246,21 @@ absl::Status RunMPPGraph() {
     profilerConfig->set_enable_profiler(true);
     profilerConfig->set_trace_log_disabled(false);
     profilerConfig->set_trace_log_count(10);
+    profilerConfig->set_trace_log_path("/tmp/mediapipe_trace_");
+    if (ort_profile_prefix.empty()) {
+      ort_profile_prefix = "/tmp/ort_profile";
+    }
   }
+  input_side_packets["ort_profile_prefix"] =
+      mediapipe::MakePacket<std::string>(ort_profile_prefix);
+
+  MP_RETURN_IF_ERROR(aikit::ml::OrtRuntime::Configure({
+      .intra_op_num_threads = absl::GetFlag(FLAGS_ort_intra_op_threads),
+      .allow_spinning = absl::GetFlag(FLAGS_ort_allow_spinning),
+      .intra_op_thread_affinity = absl::GetFlag(FLAGS_ort_thread_affinity),
+      .per_session_threads = absl::GetFlag(FLAGS_ort_per_session_threads),
+      .optimized_model_dir = absl::GetFlag(FLAGS_ort_optimized_model_dir),
+  }));
 
   ABSL_LOG(INFO) << "Initialize the calculator graph.";
   mediapipe::CalculatorGraph graph;
@@ -3,6 +3,8 @@
 #include <csignal>
 #include <cstdlib>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
@@ -10,6 +12,7 @@
 #include "absl/log/absl_log.h"
 #include "av_transducer/utils/audio.h"
 #include "av_transducer/utils/video.h"
+#include "ml/common/ort_runtime.h"
 #include "mediapipe/framework/api2/builder.h"
 #include "mediapipe/framework/calculator_graph.h"
 
@@ -29,7 +32,12 @@ void SignalHandler(int signal) {
 ABSL_FLAG(
     std::string, cdetr_model_path,
     "/meeting_bot/meeting_bot.runfiles/_main/ml/detection/models/model.onnx",
-    "Specify path to the CDETR model.");
+    "Specify path to the CDETR model, model.onnx or the INT8 "
+    "model_int8.onnx.");
+ABSL_FLAG(std::vector<std::string>, cdetr_reduced_model_paths, {},
+          "Comma separated CDETR variants at lower resolutions, from the "
+          "highest to the lowest, e.g. model_960x540.onnx,model_640x360.onnx. "
+          "Frames after trivial layouts are inferred by them.");
 ABSL_FLAG(
     std::string, ocr_model_path,
     "/meeting_bot/meeting_bot.runfiles/_main/ml/ocr/models/model.onnx",
@@ -43,6 +51,57 @@ ABSL_FLAG(
     std::string, spk_model_path,
     "/meeting_bot/meeting_bot.runfiles/_main/ml/asr/models/vosk-model-spk-0.4",
     "Specify path to the SPK model.");
+ABSL_FLAG(std::string, final_asr_model_path, "",
+          "Specify path to the large ASR model, which re-decodes utterances "
+          "found by the --asr_model_path one. Empty for the single pass ASR.");
+ABSL_FLAG(
+    std::string, kws_model_path,
+    "/meeting_bot/meeting_bot.runfiles/_main/ml/asr/models/vosk-model-small-ru-0.22",
+    "Specify path to the keyword spotting model. The grammar mode needs a "
+    "model shipped with the runtime graph (graph/HCLr.fst and graph/Gr.fst, "
+    "e.g. the small models), models with a static HCLG.fst don't work.");
+ABSL_FLAG(std::vector<std::string>, keywords, {},
+          "Comma separated phrases to spot in the speech.");
+ABSL_FLAG(std::string, asr_profile, "balanced",
+          "ASR profile: live-low-latency, balanced or offline-accurate.");
+ABSL_FLAG(int, vad_hangover_ms, 800,
+          "Audio after the speech which still goes to the recognizer, so "
+          "pauses between words don't split utterances.");
+ABSL_FLAG(int, vad_preroll_ms, 300,
+          "Audio before the speech start which goes to the recognizer, so "
+          "the beginning of the first word is not cut.");
+ABSL_FLAG(std::string, asr_engine, "vosk",
+          "Speech recognizer: vosk or whisper.");
+ABSL_FLAG(std::string, whisper_model_path, "",
+          "Specify path to the Whisper model, used with --asr_engine=whisper.");
+ABSL_FLAG(std::string, speaker_index_path, "",
+          "Specify path to the index of known voices, results get the name "
+          "of the nearest one. The index is made by "
+          "//ml/diarization:enroll_speaker. Empty to not identify speakers.");
+
+ABSL_FLAG(int, ort_intra_op_threads, 0,
+          "Threads of the ONNX Runtime pool shared by the models, 0 for half "
+          "of the cores.");
+ABSL_FLAG(bool, ort_allow_spinning, false,
+          "Let idle ONNX Runtime threads spin waiting for work, it cuts the "
+          "latency but keeps the cores busy between the inferences.");
+ABSL_FLAG(std::string, ort_thread_affinity, "",
+          "Cores of the ONNX Runtime threads but the caller, e.g. \"1;2;3\" "
+          "for 4 threads. Empty to not pin them.");
+ABSL_FLAG(bool, ort_per_session_threads, false,
+          "Give every model its own ONNX Runtime thread pools instead of the "
+          "shared ones.");
+ABSL_FLAG(std::string, ort_optimized_model_dir, "/tmp/aikit_ort_models",
+          "Directory to keep the optimized visual models in, so they're "
+          "optimized on the first start only. Empty to optimize them on "
+          "every start.");
+ABSL_FLAG(std::string, ort_profile_prefix, "",
+          "Prefix of the ONNX Runtime profiles of the ops of CDetr and OCR, "
+          "e.g. /tmp/ort_profile. Empty to not profile them.");
+
+ABSL_FLAG(std::string, transcript_address, "unix:///tmp/transcript.sock",
+          "Address of the service searching the transcript of the meeting, "
+          "empty to not serve it.");
 
 ABSL_FLAG(std::string, output_file_path, "", "Full path of video to save.");
 
@@ -82,7 +141,9 @@ mediapipe::CalculatorGraphConfig BuildGraph() {
   // Processing
 
   // audio
-  auto &audio_subgraph = graph.AddNode("AudioGraph");
+  const bool use_whisper = absl::GetFlag(FLAGS_asr_engine) == "whisper";
+  auto &audio_subgraph =
+      graph.AddNode(use_whisper ? "WhisperAudioGraph" : "AudioGraph");
   audio_header >> audio_subgraph.SideIn("IN_AUDIO_HEADER");
   audio_stream >> audio_subgraph.In("IN_AUDIO");
     graph.SideIn("OUT_ASR_AUDIO_HEADER")
@@ -90,14 +151,49 @@ mediapipe::CalculatorGraphConfig BuildGraph() {
           .Cast<aikit::media::AudioStreamParameters>() >>
       audio_subgraph.SideIn("OUT_AUDIO_HEADER");
 
-  graph.SideIn("ASR_MODEL_PATH")
-          .SetName("asr_model_path")
-          .Cast<std::string>() >>
-      audio_subgraph.SideIn("ASR_MODEL_PATH");
-  graph.SideIn("SPK_MODEL_PATH")
-          .SetName("spk_model_path")
+  if (use_whisper) {
+    graph.SideIn("WHISPER_MODEL_PATH")
+            .SetName("whisper_model_path")
+            .Cast<std::string>() >>
+        audio_subgraph.SideIn("WHISPER_MODEL_PATH");
+  } else {
+    graph.SideIn("ASR_MODEL_PATH")
+            .SetName("asr_model_path")
+            .Cast<std::string>() >>
+        audio_subgraph.SideIn("ASR_MODEL_PATH");
+    graph.SideIn("SPK_MODEL_PATH")
+            .SetName("spk_model_path")
+            .Cast<std::string>() >>
+        audio_subgraph.SideIn("SPK_MODEL_PATH");
+    graph.SideIn("FINAL_ASR_MODEL_PATH")
+            .SetName("final_asr_model_path")
+            .Cast<std::string>() >>
+        audio_subgraph.SideIn("FINAL_ASR_MODEL_PATH");
+    graph.SideIn("KWS_MODEL_PATH")
+            .SetName("kws_model_path")
+            .Cast<std::string>() >>
+        audio_subgraph.SideIn("KWS_MODEL_PATH");
+    graph.SideIn("KEYWORDS")
+            .SetName("keywords")
+            .Cast<std::vector<std::string>>() >>
+        audio_subgraph.SideIn("KEYWORDS");
+    graph.SideIn("ASR_PROFILE")
+            .SetName("asr_profile")
+            .Cast<std::string>() >>
+        audio_subgraph.SideIn("ASR_PROFILE");
+  }
+  graph.SideIn("VAD_HANGOVER_MS")
+          .SetName("vad_hangover_ms")
+          .Cast<int>() >>
+      audio_subgraph.SideIn("VAD_HANGOVER_MS");
+  graph.SideIn("VAD_PREROLL_MS")
+          .SetName("vad_preroll_ms")
+          .Cast<int>() >>
+      audio_subgraph.SideIn("VAD_PREROLL_MS");
+  graph.SideIn("SPEAKER_INDEX_PATH")
+          .SetName("speaker_index_path")
           .Cast<std::string>() >>
-      audio_subgraph.SideIn("SPK_MODEL_PATH");
+      audio_subgraph.SideIn("SPEAKER_INDEX_PATH");
   auto transcription_stream = audio_subgraph.Out("TRANSCRIPTION");
 
   // visual
@@ -110,10 +206,18 @@ mediapipe::CalculatorGraphConfig BuildGraph() {
           .SetName("detection_model_path")
           .Cast<std::string>() >>
       visual_subgraph.SideIn("DETECTION_MODEL_PATH");
+  graph.SideIn("DETECTION_REDUCED_MODEL_PATHS")
+          .SetName("detection_reduced_model_paths")
+          .Cast<std::vector<std::string>>() >>
+      visual_subgraph.SideIn("DETECTION_REDUCED_MODEL_PATHS");
   graph.SideIn("OCR_MODEL_PATH")
           .SetName("ocr_model_path")
           .Cast<std::string>() >>
       visual_subgraph.SideIn("OCR_MODEL_PATH");
+  graph.SideIn("ORT_PROFILE_PREFIX")
+          .SetName("ort_profile_prefix")
+          .Cast<std::string>() >>
+      visual_subgraph.SideIn("ORT_PROFILE_PREFIX");
   yuv_video_stream >> visual_subgraph.In("IN_VIDEO");
   auto detections_stream = visual_subgraph.Out("DETECTIONS");
   auto speaker_name_stream = visual_subgraph.Out("STRING");
@@ -125,6 +229,20 @@ mediapipe::CalculatorGraphConfig BuildGraph() {
   detections_stream >> evaluator_client_node.In("DETECTIONS");
   speaker_name_stream >> evaluator_client_node.In("SPEAKER_NAME");
   transcription_stream >> evaluator_client_node.In("ASR_RESULT");
+  // Whisper has no partial results and no keyword spotting.
+  if (!use_whisper) {
+    audio_subgraph.Out("PARTIAL_TRANSCRIPTION") >>
+        evaluator_client_node.In("PARTIAL_ASR_RESULT");
+    audio_subgraph.Out("KEYWORD") >> evaluator_client_node.In("KEYWORD");
+  }
+
+  // Index the transcript for the evaluator
+  auto &transcript_index_node = graph.AddNode("TranscriptIndexCalculator");
+  graph.SideIn("TRANSCRIPT_ADDRESS")
+          .SetName("transcript_address")
+          .Cast<std::string>() >>
+      transcript_index_node.SideIn("ADDRESS");
+  transcription_stream >> transcript_index_node.In("ASR_RESULT");
 
   // Write audio
   auto &sink_video_node = graph.AddNode("FFMPEGSinkVideoCalculator");
@@ -163,6 +281,8 @@ absl::Status RunMPPGraph() {
 
   aikit::media::AudioStreamParameters asr_audio_stream_parameters;
   asr_audio_stream_parameters.sample_rate = 16000;
+  // The recognizer consumes 16 bit PCM natively.
+  asr_audio_stream_parameters.format = AV_SAMPLE_FMT_S16;
   input_side_packets["out_asr_audio_header"] =
       mediapipe::MakePacket<aikit::media::AudioStreamParameters>(
           asr_audio_stream_parameters);
@@ -173,13 +293,50 @@ absl::Status RunMPPGraph() {
           video_stream_parameters);
   input_side_packets["detection_model_path"] =
       mediapipe::MakePacket<std::string>(absl::GetFlag(FLAGS_cdetr_model_path));
+  input_side_packets["detection_reduced_model_paths"] =
+      mediapipe::MakePacket<std::vector<std::string>>(
+          absl::GetFlag(FLAGS_cdetr_reduced_model_paths));
   input_side_packets["ocr_model_path"] =
         mediapipe::MakePacket<std::string>(absl::GetFlag(FLAGS_ocr_model_path));
+  input_side_packets["ort_profile_prefix"] = mediapipe::MakePacket<std::string>(
+      absl::GetFlag(FLAGS_ort_profile_prefix));
 
   input_side_packets["asr_model_path"] =
       mediapipe::MakePacket<std::string>(absl::GetFlag(FLAGS_asr_model_path));
   input_side_packets["spk_model_path"] =
       mediapipe::MakePacket<std::string>(absl::GetFlag(FLAGS_spk_model_path));
+  input_side_packets["final_asr_model_path"] = mediapipe::MakePacket<std::string>(
+      absl::GetFlag(FLAGS_final_asr_model_path));
+  input_side_packets["asr_profile"] =
+      mediapipe::MakePacket<std::string>(absl::GetFlag(FLAGS_asr_profile));
+  input_side_packets["kws_model_path"] =
+      mediapipe::MakePacket<std::string>(absl::GetFlag(FLAGS_kws_model_path));
+  input_side_packets["keywords"] = mediapipe::MakePacket<std::vector<std::string>>(
+      absl::GetFlag(FLAGS_keywords));
+  input_side_packets["vad_hangover_ms"] =
+      mediapipe::MakePacket<int>(absl::GetFlag(FLAGS_vad_hangover_ms));
+  input_side_packets["vad_preroll_ms"] =
+      mediapipe::MakePacket<int>(absl::GetFlag(FLAGS_vad_preroll_ms));
+  input_side_packets["speaker_index_path"] = mediapipe::MakePacket<std::string>(
+      absl::GetFlag(FLAGS_speaker_index_path));
+  input_side_packets["transcript_address"] = mediapipe::MakePacket<std::string>(
+      absl::GetFlag(FLAGS_transcript_address));
+  if (absl::GetFlag(FLAGS_asr_engine) == "whisper") {
+    if (absl::GetFlag(FLAGS_whisper_model_path).empty()) {
+      return absl::InvalidArgumentError(
+          "--whisper_model_path is required with --asr_engine=whisper.");
+    }
+    input_side_packets["whisper_model_path"] = mediapipe::MakePacket<std::string>(
+        absl::GetFlag(FLAGS_whisper_model_path));
+  }
+
+  MP_RETURN_IF_ERROR(aikit::ml::OrtRuntime::Configure({
+      .intra_op_num_threads = absl::GetFlag(FLAGS_ort_intra_op_threads),
+      .allow_spinning = absl::GetFlag(FLAGS_ort_allow_spinning),
+      .intra_op_thread_affinity = absl::GetFlag(FLAGS_ort_thread_affinity),
+      .per_session_threads = absl::GetFlag(FLAGS_ort_per_session_threads),
+      .optimized_model_dir = absl::GetFlag(FLAGS_ort_optimized_model_dir),
+  }));
 
   ABSL_LOG(INFO) << "Initialize the calculator graph.";
   mediapipe::CalculatorGraph graph;
@@ -1,6 +1,8 @@
 #include "mediapipe/framework/api2/builder.h"
 #include "mediapipe/framework/subgraph.h"
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "av_transducer/utils/audio.h"
 
@@ -18,12 +20,24 @@ public:
   static constexpr std::string_view kInAudio = "IN_AUDIO";
   static constexpr std::string_view kOutAudioHeader = "OUT_AUDIO_HEADER";
   static constexpr std::string_view kOutTranscription = "TRANSCRIPTION";
+  static constexpr std::string_view kOutPartialTranscription =
+      "PARTIAL_TRANSCRIPTION";
+  static constexpr std::string_view kOutKeyword = "KEYWORD";
 
   absl::StatusOr<mediapipe::CalculatorGraphConfig>
   GetConfig(mediapipe::SubgraphContext *sc) override {
+    return BuildConfig(Engine::kVosk);
+  }
+
+protected:
+  enum class Engine { kVosk, kVoskOffline, kWhisper };
+
+  static absl::StatusOr<mediapipe::CalculatorGraphConfig>
+  BuildConfig(Engine engine) {
     mediapipe::api2::builder::Graph graph;
 
-    // Convert to 16kHz FLT
+    // Convert to the format of OUT_AUDIO_HEADER, 16kHz S16 is the native
+    // format of the recognizer.
     auto &audio_converter_node = graph.AddNode("AudioConverterCalculator");
     graph.SideIn(kInAudioHeader)
         .SetName("in_audio_header")
@@ -34,11 +48,63 @@ public:
         .Cast<aikit::media::AudioStreamParameters>() >> audio_converter_node.SideIn("OUT_AUDIO_HEADER");
 
     graph.In(kInAudio) >> audio_converter_node.In("IN_AUDIO");
-    auto float_16kHz_audio_stream = audio_converter_node.Out("OUT_AUDIO");
+    auto asr_audio_stream = audio_converter_node.Out("OUT_AUDIO");
+
+    if (engine == Engine::kVoskOffline) {
+      // The whole track is transcribed at once, split on its own silences,
+      // so the recognizer gets all of the audio.
+      auto &offline_asr_node = graph.AddNode("OfflineASRCalculator");
+      asr_audio_stream >> offline_asr_node.In("AUDIO");
+      graph.SideIn("ASR_MODEL_PATH")
+              .SetName("asr_model_path")
+              .Cast<std::string>() >>
+          offline_asr_node.SideIn("ASR_MODEL_PATH");
+      graph.SideIn("SPK_MODEL_PATH")
+              .SetName("spk_model_path")
+              .Cast<std::string>() >>
+          offline_asr_node.SideIn("SPK_MODEL_PATH");
+      graph.SideIn("ASR_PROFILE")
+              .SetName("asr_profile")
+              .Cast<std::string>() >>
+          offline_asr_node.SideIn("PROFILE");
+      graph.SideIn("ASR_NUM_WORKERS")
+              .SetName("asr_num_workers")
+              .Cast<int>() >>
+          offline_asr_node.SideIn("NUM_WORKERS");
+      return FinishConfig(graph, offline_asr_node, /*partial_results=*/false);
+    }
+
+    // Only speech goes to the recognizer, decoding of silence and
+    // background noise is a waste of CPU. VAD_HANGOVER_MS and
+    // VAD_PREROLL_MS are optional, see VoiceActivityCalculator.
+    auto &vad_node = graph.AddNode("VoiceActivityCalculator");
+    graph.SideIn("VAD_HANGOVER_MS")
+            .SetName("vad_hangover_ms")
+            .Cast<int>() >>
+        vad_node.SideIn("HANGOVER_MS");
+    graph.SideIn("VAD_PREROLL_MS")
+            .SetName("vad_preroll_ms")
+            .Cast<int>() >>
+        vad_node.SideIn("PREROLL_MS");
+    asr_audio_stream >> vad_node.In("AUDIO");
+    auto speech_audio_stream = vad_node.Out("AUDIO");
+    auto speech_activity = vad_node.Out("SPEECH_ACTIVITY");
 
     // apply ASR
+    if (engine == Engine::kWhisper) {
+      auto &whisper_node = graph.AddNode("WhisperCalculator");
+      speech_audio_stream >> whisper_node.In("AUDIO");
+      speech_activity >> whisper_node.In("SPEECH_ACTIVITY");
+      graph.SideIn("WHISPER_MODEL_PATH")
+              .SetName("whisper_model_path")
+              .Cast<std::string>() >>
+          whisper_node.SideIn("MODEL_PATH");
+      return FinishConfig(graph, whisper_node, /*partial_results=*/false);
+    }
+
     auto &asr_node = graph.AddNode("ASRCalculator");
-    float_16kHz_audio_stream >> asr_node.In("AUDIO");
+    speech_audio_stream >> asr_node.In("AUDIO");
+    speech_activity >> asr_node.In("SPEECH_ACTIVITY");
 
     graph.SideIn("ASR_MODEL_PATH")
           .SetName("asr_model_path")
@@ -50,11 +116,93 @@ public:
           .Cast<std::string>() >>
       asr_node.SideIn("SPK_MODEL_PATH");
 
-    auto transcription = asr_node.Out("ASR_RESULT");
+    // Empty for the single pass recognition.
+    graph.SideIn("FINAL_ASR_MODEL_PATH")
+          .SetName("final_asr_model_path")
+          .Cast<std::string>() >>
+      asr_node.SideIn("FINAL_ASR_MODEL_PATH");
+
+    graph.SideIn("ASR_PROFILE")
+          .SetName("asr_profile")
+          .Cast<std::string>() >>
+      asr_node.SideIn("PROFILE");
+
+    // Spoken commands, nothing is done when KEYWORDS is empty.
+    auto &kws_node = graph.AddNode("KeywordSpotterCalculator");
+    speech_audio_stream >> kws_node.In("AUDIO");
+    speech_activity >> kws_node.In("SPEECH_ACTIVITY");
+    graph.SideIn("KWS_MODEL_PATH")
+          .SetName("kws_model_path")
+          .Cast<std::string>() >>
+      kws_node.SideIn("MODEL_PATH");
+    graph.SideIn("KEYWORDS")
+          .SetName("keywords")
+          .Cast<std::vector<std::string>>() >>
+      kws_node.SideIn("KEYWORDS");
+    graph.SideIn("ASR_PROFILE")
+          .SetName("asr_profile")
+          .Cast<std::string>() >>
+      kws_node.SideIn("PROFILE");
+    kws_node.Out("KEYWORD") >> graph.Out(kOutKeyword);
+
+    return FinishConfig(graph, asr_node, /*partial_results=*/true);
+  }
+
+  // Outputs of the ASR node to the outputs of the graph. Without
+  // `partial_results` there is no PARTIAL_TRANSCRIPTION.
+  static absl::StatusOr<mediapipe::CalculatorGraphConfig>
+  FinishConfig(mediapipe::api2::builder::Graph &graph,
+               mediapipe::api2::builder::GenericNode &asr_node,
+               bool partial_results) {
+    // Who said it
+    auto &diarization_node = graph.AddNode("DiarizationCalculator");
+    asr_node.Out("ASR_RESULT") >> diarization_node.In("ASR_RESULT");
+
+    // Who of the known people it is, nothing is done when
+    // SPEAKER_INDEX_PATH is empty.
+    auto &identification_node =
+        graph.AddNode("SpeakerIdentificationCalculator");
+    graph.SideIn("SPEAKER_INDEX_PATH")
+            .SetName("speaker_index_path")
+            .Cast<std::string>() >>
+        identification_node.SideIn("INDEX_PATH");
+    diarization_node.Out("ASR_RESULT") >> identification_node.In("ASR_RESULT");
+
+    auto transcription = identification_node.Out("ASR_RESULT");
     transcription >> graph.Out(kOutTranscription);
+    if (partial_results) {
+      asr_node.Out("PARTIAL_ASR_RESULT") >>
+          graph.Out(kOutPartialTranscription);
+    }
 
     return graph.GetConfig();
   }
 };
 REGISTER_MEDIAPIPE_GRAPH(AudioGraph);
+
+// Same as AudioGraph, but the speech is transcribed by Whisper, see
+// WhisperCalculator. Takes WHISPER_MODEL_PATH instead of the Vosk side
+// packets, there is no PARTIAL_TRANSCRIPTION output.
+class WhisperAudioGraph : public AudioGraph {
+public:
+  absl::StatusOr<mediapipe::CalculatorGraphConfig>
+  GetConfig(mediapipe::SubgraphContext *sc) override {
+    return BuildConfig(Engine::kWhisper);
+  }
+};
+REGISTER_MEDIAPIPE_GRAPH(WhisperAudioGraph);
+
+// Same as AudioGraph, but for recorded files: the whole track is
+// transcribed at the end of the stream on all cores, see
+// OfflineASRCalculator. Takes ASR_MODEL_PATH, SPK_MODEL_PATH,
+// ASR_PROFILE and optional ASR_NUM_WORKERS, there is no keyword spotting
+// and there is no PARTIAL_TRANSCRIPTION output.
+class OfflineAudioGraph : public AudioGraph {
+public:
+  absl::StatusOr<mediapipe::CalculatorGraphConfig>
+  GetConfig(mediapipe::SubgraphContext *sc) override {
+    return BuildConfig(Engine::kVoskOffline);
+  }
+};
+REGISTER_MEDIAPIPE_GRAPH(OfflineAudioGraph);
 } // namespace aikit
@@ -55,6 +55,10 @@ public:
             .SetName("ocr_model_path")
             .Cast<std::string>() >>
         ocr_node.SideIn("OCR_MODEL_PATH");
+    graph.SideIn("ORT_PROFILE_PREFIX")
+            .SetName("ort_profile_prefix")
+            .Cast<std::string>() >>
+        ocr_node.SideIn("ORT_PROFILE_PREFIX");
     scaled_image_frame_stream >> ocr_node.In("IMAGE_FRAME");
     ocr_node.Out("STRING") >> graph.Out(kOutText);
 
@@ -3,7 +3,9 @@
 #include "mediapipe/framework/api2/builder.h"
 #include "mediapipe/framework/formats/yuv_image.h"
 #include "mediapipe/framework/subgraph.h"
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "av_transducer/utils/audio.h"
 #include "av_transducer/utils/video.h"
@@ -14,6 +16,12 @@ namespace aikit {
 // Inputs:
 //   VIDEO - media::VideoFrame
 //     Image (stream of images, so video) to extract thumbnails from
+// Input side packets:
+//   DETECTION_REDUCED_MODEL_PATHS - std::vector<std::string>, optional
+//     CDetr variants at lower resolutions, see DetectionCalculator
+//   ORT_PROFILE_PREFIX - std::string, optional
+//     Prefix of the ONNX Runtime profiles of CDetr and OCR, empty to not
+//     profile them
 // Outputs:
 //   Detections - vector of detections
 class VisualGraph : public mediapipe::Subgraph {
@@ -60,6 +68,14 @@ public:
             .SetName("model_path")
             .Cast<std::string>() >>
         cdetr_node.SideIn("MODEL_PATH");
+    graph.SideIn("DETECTION_REDUCED_MODEL_PATHS")
+            .SetName("reduced_model_paths")
+            .Cast<std::vector<std::string>>() >>
+        cdetr_node.SideIn("REDUCED_MODEL_PATHS");
+    auto ort_profile_prefix = graph.SideIn("ORT_PROFILE_PREFIX")
+                                  .SetName("ort_profile_prefix")
+                                  .Cast<std::string>();
+    ort_profile_prefix >> cdetr_node.SideIn("ORT_PROFILE_PREFIX");
     images_stream >> cdetr_node.In("IMAGE");
     auto detections = cdetr_node.Out("DETECTIONS");
     detections >> graph.Out(kOutDetections);
@@ -77,6 +93,7 @@ public:
             .SetName("ocr_model_path")
             .Cast<std::string>() >>
         ocr_node.SideIn("OCR_MODEL_PATH");
+    ort_profile_prefix >> ocr_node.SideIn("ORT_PROFILE_PREFIX");
     auto speaker_name = ocr_node.Out("STRING");
     speaker_name >> graph.Out(kOutSpeakerName);
 
@@ -123,6 +123,51 @@ absl::Status AudioFrame::AppendAudioData(std::vector<float> &audio_data) const {
   return absl::OkStatus();
 }
 
+absl::Status AudioFrame::FillAudioData(std::vector<int16_t> &audio_data) {
+  if (c_frame_->format != AV_SAMPLE_FMT_S16 &&
+      c_frame_->format != AV_SAMPLE_FMT_S16P) {
+    return absl::AbortedError(
+        "Filling audio frame with int16 data supported "
+        "only for AV_SAMPLE_FMT_S16 format. Please "
+        "convert the frame to the AV_SAMPLE_FMT_S16 format");
+  }
+
+  if (c_frame_->ch_layout.nb_channels != 1) {
+    return absl::AbortedError(
+        "The existing frame expects more then 1 channel of data.");
+  }
+
+  c_frame_->nb_samples = audio_data.size();
+  uint8_t *ptr = nullptr;
+  ptr = reinterpret_cast<uint8_t *>(audio_data.data());
+  av_samples_copy(c_frame_->extended_data, &ptr, 0, 0, audio_data.size(), 1,
+                  AV_SAMPLE_FMT_S16P);
+
+  return absl::OkStatus();
+}
+
+absl::Status
+AudioFrame::AppendAudioData(std::vector<int16_t> &audio_data) const {
+  if (c_frame_->format != AV_SAMPLE_FMT_S16 &&
+      c_frame_->format != AV_SAMPLE_FMT_S16P) {
+    return absl::AbortedError(
+        "Appending audio frame with int16 data supported "
+        "only for AV_SAMPLE_FMT_S16 format. Please "
+        "convert the frame to the AV_SAMPLE_FMT_S16 format");
+  }
+
+  if (c_frame_->ch_layout.nb_channels != 1) {
+    return absl::AbortedError(
+        "Number of channels in the frame expected to be 1, but it's not.");
+  }
+
+  const auto *samples =
+      reinterpret_cast<const int16_t *>(c_frame_->extended_data[0]);
+  audio_data.insert(audio_data.end(), samples, samples + c_frame_->nb_samples);
+
+  return absl::OkStatus();
+}
+
 absl::StatusOr<AudioStreamContext> AudioStreamContext::CreateAudioStreamContext(
     const AVFormatContext *format_context, const AVCodec *codec,
     const AVCodecParameters *codec_parameters, AVCodecContext *codec_context,
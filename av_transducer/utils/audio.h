@@ -47,6 +47,9 @@ public:
   absl::Status FillAudioData(std::vector<float> &audio_data);
   // Copies frames data to the given vector.
   absl::Status AppendAudioData(std::vector<float> &audio_data) const;
+  // The same as above, but for the frames in S16 format.
+  absl::Status FillAudioData(std::vector<int16_t> &audio_data);
+  absl::Status AppendAudioData(std::vector<int16_t> &audio_data) const;
 
   int64_t GetPTS() const { return c_frame_->pts; }
   void SetPTS(int64_t pts) { c_frame_->pts = pts; }
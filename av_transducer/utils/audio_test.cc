@@ -87,3 +87,32 @@ TEST(TestAudioUtils, CheckAppendAudioData) {
     EXPECT_FLOAT_EQ(audio_data[i], copied_audio_data[i]);
   }
 }
+
+TEST(TestAudioUtils, CheckAppendS16AudioData) {
+  std::vector<int16_t> audio_data(16);
+  for (auto i = 0; i < 16; ++i) {
+    audio_data[i] = static_cast<int16_t>(i * 1000 - 8000);
+  }
+
+  AVChannelLayout in_channel_layout = AV_CHANNEL_LAYOUT_MONO;
+  auto in_frame_or = aikit::media::AudioFrame::CreateAudioFrame(
+      AV_SAMPLE_FMT_S16, &in_channel_layout, 16, 16);
+  EXPECT_TRUE(in_frame_or);
+  auto status = in_frame_or->FillAudioData(audio_data);
+  EXPECT_TRUE(status.ok()) << status.message();
+  EXPECT_EQ(in_frame_or->c_frame()->linesize[0], 32);
+
+  std::vector<int16_t> copied_audio_data;
+  status = in_frame_or->AppendAudioData(copied_audio_data);
+  EXPECT_TRUE(status.ok()) << status.message();
+  status = in_frame_or->AppendAudioData(copied_audio_data);
+  EXPECT_TRUE(status.ok()) << status.message();
+  ASSERT_EQ(copied_audio_data.size(), 32);
+  for (auto i = 0; i < 32; ++i) {
+    EXPECT_EQ(audio_data[i % 16], copied_audio_data[i]);
+  }
+
+  std::vector<float> float_audio_data;
+  status = in_frame_or->AppendAudioData(float_audio_data);
+  EXPECT_TRUE(absl::IsAborted(status));
+}
@@ -0,0 +1,106 @@
+#include "av_transducer/utils/vad.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace aikit {
+namespace media {
+namespace {
+// Independent accumulators let the compiler vectorize the loop without
+// reordering of float additions (no -ffast-math needed).
+constexpr size_t kLanes = 8;
+
+template <typename T>
+float SumOfSquares(const T *samples, size_t nb_samples) {
+  float lanes[kLanes] = {};
+  size_t i = 0;
+  for (; i + kLanes <= nb_samples; i += kLanes) {
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      const auto x = static_cast<float>(samples[i + lane]);
+      lanes[lane] += x * x;
+    }
+  }
+  float sum = 0.0f;
+  for (; i < nb_samples; ++i) {
+    const auto x = static_cast<float>(samples[i]);
+    sum += x * x;
+  }
+  for (size_t lane = 0; lane < kLanes; ++lane) {
+    sum += lanes[lane];
+  }
+  return sum;
+}
+} // namespace
+
+VoiceActivityDetector::VoiceActivityDetector(
+    const VoiceActivityDetectorOptions &options)
+    : options_(options),
+      frame_size_(std::max(1, options.sample_rate *
+                                  options.frame_duration_ms / 1000)),
+      hangover_frames_(options.hangover_ms /
+                       std::max(1, options.frame_duration_ms)),
+      noise_floor_rise_db_per_frame_(options.noise_floor_rise_db_per_sec *
+                                     options.frame_duration_ms / 1000.0f) {}
+
+bool VoiceActivityDetector::Process(const int16_t *samples,
+                                    size_t nb_samples) {
+  constexpr float kScale = 1.0f / (32768.0f * 32768.0f);
+  return ProcessSamples(samples, nb_samples, kScale);
+}
+
+bool VoiceActivityDetector::Process(const float *samples, size_t nb_samples) {
+  return ProcessSamples(samples, nb_samples, 1.0f);
+}
+
+template <typename T>
+bool VoiceActivityDetector::ProcessSamples(const T *samples,
+                                           size_t nb_samples, float scale) {
+  // Samples are active if speech was active at any moment of them.
+  bool was_active = is_active_;
+  while (nb_samples > 0) {
+    const size_t take =
+        std::min(nb_samples, frame_size_ - accumulated_samples_);
+    accumulated_energy_ += SumOfSquares(samples, take) * scale;
+    accumulated_samples_ += take;
+    samples += take;
+    nb_samples -= take;
+
+    if (accumulated_samples_ == frame_size_) {
+      ProcessFrame(accumulated_energy_ / frame_size_);
+      was_active = was_active || is_active_;
+      accumulated_samples_ = 0;
+      accumulated_energy_ = 0.0f;
+    }
+  }
+  return was_active;
+}
+
+void VoiceActivityDetector::ProcessFrame(float mean_square) {
+  const float energy_db = 10.0f * std::log10(mean_square + 1e-10f);
+  if (!noise_floor_initialized_) {
+    noise_floor_db_ = energy_db;
+    noise_floor_initialized_ = true;
+  }
+
+  const bool is_speech = energy_db > noise_floor_db_ + options_.threshold_db &&
+                         energy_db > options_.min_energy_db;
+
+  // The floor follows quieter frames immediately and rises slowly, so
+  // it settles on the background level even if it becomes louder.
+  if (energy_db < noise_floor_db_) {
+    noise_floor_db_ = energy_db;
+  } else {
+    noise_floor_db_ =
+        std::min(energy_db, noise_floor_db_ + noise_floor_rise_db_per_frame_);
+  }
+
+  if (is_speech) {
+    frames_since_speech_ = 0;
+    is_active_ = true;
+  } else if (is_active_ && ++frames_since_speech_ > hangover_frames_) {
+    is_active_ = false;
+  }
+}
+
+} // namespace media
+} // namespace aikit
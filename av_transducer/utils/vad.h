@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace aikit {
+namespace media {
+
+struct VoiceActivityDetectorOptions {
+  int sample_rate = 16000;
+  // Audio is analysed in frames of this duration.
+  int frame_duration_ms = 20;
+  // Frame is speech when its energy is that much above the noise floor.
+  float threshold_db = 9.0f;
+  // and above this absolute level (dBFS), so digital silence and
+  // very quiet noise are never speech.
+  float min_energy_db = -55.0f;
+  // Speed of the noise floor adaptation to the louder background.
+  float noise_floor_rise_db_per_sec = 1.0f;
+  // Speech stays active for that long after the last speech frame,
+  // so short pauses between words don't split the utterance.
+  int hangover_ms = 800;
+};
+
+// Energy based voice activity detector.
+//
+// It tracks the noise floor of the signal and reports speech when the
+// energy of the frame is noticeably above it. It costs one pass over the
+// samples, so it's cheap to run in front of the recognizer.
+class VoiceActivityDetector {
+public:
+  explicit VoiceActivityDetector(
+      const VoiceActivityDetectorOptions &options = {});
+
+  // Analyses the given samples and returns true when speech is active
+  // (speech frame was found in them or hangover is not over yet).
+  bool Process(const int16_t *samples, size_t nb_samples);
+  bool Process(const float *samples, size_t nb_samples);
+
+  float noise_floor_db() const { return noise_floor_db_; }
+
+private:
+  template <typename T>
+  bool ProcessSamples(const T *samples, size_t nb_samples, float scale);
+  // Updates the state with one analysis frame, `mean_square` is
+  // normalized to [0, 1].
+  void ProcessFrame(float mean_square);
+
+  VoiceActivityDetectorOptions options_;
+  size_t frame_size_;
+  int hangover_frames_;
+  float noise_floor_rise_db_per_frame_;
+
+  // Not yet complete analysis frame.
+  size_t accumulated_samples_ = 0;
+  float accumulated_energy_ = 0.0f;
+
+  bool noise_floor_initialized_ = false;
+  float noise_floor_db_ = 0.0f;
+  int frames_since_speech_ = 0;
+  bool is_active_ = false;
+};
+
+} // namespace media
+} // namespace aikit
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "av_transducer/utils/vad.h"
+
+namespace {
+constexpr int kSampleRate = 16000;
+constexpr size_t kFrameSize = 1024;
+
+std::vector<int16_t> GenerateTone(size_t nb_samples, float amplitude) {
+  std::vector<int16_t> audio_data(nb_samples);
+  auto pi = 3.14159265358979323846;
+  for (size_t i = 0; i < nb_samples; ++i) {
+    audio_data[i] = static_cast<int16_t>(
+        amplitude * 32767.0 * std::sin(2.0 * pi * 220.0 * i / kSampleRate));
+  }
+  return audio_data;
+}
+
+std::vector<int16_t> GenerateNoise(size_t nb_samples, float amplitude) {
+  std::vector<int16_t> audio_data(nb_samples);
+  uint32_t state = 42;
+  for (auto &sample : audio_data) {
+    state = state * 1664525u + 1013904223u;
+    sample = static_cast<int16_t>(amplitude * static_cast<int16_t>(state >> 16));
+  }
+  return audio_data;
+}
+
+// Feeds audio by frames and returns activity decision of every frame.
+std::vector<bool> ProcessByFrames(aikit::media::VoiceActivityDetector &vad,
+                                  const std::vector<int16_t> &audio_data) {
+  std::vector<bool> activity;
+  for (size_t i = 0; i + kFrameSize <= audio_data.size(); i += kFrameSize) {
+    activity.push_back(vad.Process(audio_data.data() + i, kFrameSize));
+  }
+  return activity;
+}
+} // namespace
+
+TEST(TestVoiceActivityDetector, SilenceIsNotSpeech) {
+  aikit::media::VoiceActivityDetector vad;
+  for (bool active :
+       ProcessByFrames(vad, std::vector<int16_t>(kSampleRate * 5))) {
+    EXPECT_FALSE(active);
+  }
+}
+
+TEST(TestVoiceActivityDetector, StationaryNoiseIsNotSpeech) {
+  aikit::media::VoiceActivityDetector vad;
+  for (bool active :
+       ProcessByFrames(vad, GenerateNoise(kSampleRate * 5, 0.01f))) {
+    EXPECT_FALSE(active);
+  }
+}
+
+TEST(TestVoiceActivityDetector, DetectsSpeechOverNoiseWithHangover) {
+  aikit::media::VoiceActivityDetectorOptions options;
+  options.hangover_ms = 500;
+  aikit::media::VoiceActivityDetector vad(options);
+
+  auto noise = ProcessByFrames(vad, GenerateNoise(kSampleRate * 2, 0.01f));
+  EXPECT_FALSE(noise.back());
+
+  auto tone = ProcessByFrames(vad, GenerateTone(kSampleRate, 0.5f));
+  for (bool active : tone) {
+    EXPECT_TRUE(active);
+  }
+
+  auto tail = ProcessByFrames(vad, GenerateNoise(kSampleRate * 2, 0.01f));
+  // 500ms of hangover is 7 frames of 64ms.
+  for (size_t i = 0; i < 7; ++i) {
+    EXPECT_TRUE(tail[i]) << i;
+  }
+  EXPECT_FALSE(tail.back());
+}
+
+TEST(TestVoiceActivityDetector, FloatAndInt16AgreeOnDecision) {
+  aikit::media::VoiceActivityDetector int16_vad;
+  aikit::media::VoiceActivityDetector float_vad;
+
+  auto audio_data = GenerateNoise(kSampleRate, 0.01f);
+  auto tone = GenerateTone(kSampleRate, 0.3f);
+  audio_data.insert(audio_data.end(), tone.begin(), tone.end());
+
+  std::vector<float> float_audio_data(audio_data.size());
+  for (size_t i = 0; i < audio_data.size(); ++i) {
+    float_audio_data[i] = audio_data[i] / 32768.0f;
+  }
+
+  for (size_t i = 0; i + kFrameSize <= audio_data.size(); i += kFrameSize) {
+    EXPECT_EQ(int16_vad.Process(audio_data.data() + i, kFrameSize),
+              float_vad.Process(float_audio_data.data() + i, kFrameSize));
+  }
+}
@@ -21,12 +21,15 @@ class EvaluatorServicer(evaluator_pb2_grpc.EvaluatorServicer):
     def __init__(
         self,
         meeting_bot_address: str,
+        transcript_address: str,
         server: grpc.aio._server.Server,
         logger: logging.Logger,
     ):
         self.scheduler = sched.scheduler(time.time, asyncio.sleep)
 
         self.meeting_bot_client = grpc.aio.insecure_channel(meeting_bot_address)
+        # Transcript index of av_transducer, see TranscriptIndexCalculator.
+        self.transcript_client = grpc.aio.insecure_channel(transcript_address)
         self.server = server
         self.logger = logger
         self.leave_call_model = get_leave_call_model(self.logger)
@@ -37,11 +40,13 @@ class EvaluatorServicer(evaluator_pb2_grpc.EvaluatorServicer):
     async def create(
         cls,
         meeting_bot_address: str,
+        transcript_address: str,
         server: grpc.aio._server.Server,
         logger: logging.Logger,
     ) -> "EvaluatorServicer":
         return cls(
             meeting_bot_address=meeting_bot_address,
+            transcript_address=transcript_address,
             server=server,
             logger=logger,
         )
@@ -77,12 +82,86 @@ class EvaluatorServicer(evaluator_pb2_grpc.EvaluatorServicer):
                 "message": "Received ASR result",
                 "event_timestamp": request.event_timestamp,
                 "transcription": request.transcription,
-                "spk_embedding": request.spk_embedding,
+                "speaker_id": request.speaker_id,
+                "speaker_name": request.speaker_name,
+                "speaker_score": request.speaker_score,
             }
         )
 
         return evaluator_pb2.ASRResultReply()
 
+    async def PartialASRResult(
+        self, request: evaluator_pb2.PartialASRResultRequest, context
+    ) -> evaluator_pb2.PartialASRResultReply:
+
+        self.logger.info(
+            {
+                "message": "Received partial ASR result",
+                "event_timestamp": request.event_timestamp,
+                "stable_transcription": request.stable_transcription,
+                "unstable_transcription": request.unstable_transcription,
+            }
+        )
+
+        return evaluator_pb2.PartialASRResultReply()
+
+    async def Keyword(
+        self, request: evaluator_pb2.KeywordRequest, context
+    ) -> evaluator_pb2.KeywordReply:
+
+        # Earlier mentions of the phrase in the transcript, the final
+        # transcription of this one may come later.
+        try:
+            mentions = await self.search_transcript(
+                request.phrase, to_timestamp=request.start_timestamp, max_hits=0
+            )
+            num_mentions = mentions.num_hits
+        except grpc.aio.AioRpcError as error:
+            self.logger.warning(
+                {
+                    "message": "Could not search the transcript",
+                    "error": error.details(),
+                }
+            )
+            num_mentions = None
+
+        self.logger.info(
+            {
+                "message": "Received keyword",
+                "event_timestamp": request.event_timestamp,
+                "phrase": request.phrase,
+                "start_timestamp": request.start_timestamp,
+                "end_timestamp": request.end_timestamp,
+                "confidence": request.confidence,
+                "num_earlier_mentions": num_mentions,
+            }
+        )
+
+        return evaluator_pb2.KeywordReply()
+
+    async def search_transcript(
+        self,
+        phrase: str,
+        from_timestamp: int = 0,
+        to_timestamp: int = 0,
+        max_hits: int = 10,
+    ) -> evaluator_pb2.TranscriptSearchReply:
+        """Finds the phrase said in the meeting between the timestamps.
+
+        Timestamps are microseconds of the media, to_timestamp of 0 is
+        the end of the meeting so far.
+        """
+        stub = evaluator_pb2_grpc.TranscriptStub(self.transcript_client)
+        return await stub.Search(
+            evaluator_pb2.TranscriptSearchRequest(
+                phrase=phrase,
+                from_timestamp=from_timestamp,
+                to_timestamp=to_timestamp,
+                max_hits=max_hits,
+            ),
+            timeout=1.0,
+        )
+
     async def send_shutdown_signal(self):
         stub = meeting_bot_pb2_grpc.MeetingBotStub(self.meeting_bot_client)
         await stub.Shutdown(
@@ -121,6 +200,7 @@ async def serve(args: argparse.Namespace):
     server = grpc.aio.server()
     service = await EvaluatorServicer.create(
         meeting_bot_address=args.meeting_bot_address,
+        transcript_address=args.transcript_address,
         server=server,
         logger=logger,
     )
@@ -156,6 +236,11 @@ def parse_args():
         ),
         default="unix:///tmp/meeting_bot.sock",
     )
+    parser.add_argument(
+        "--transcript_address",
+        help="Specify the address of the av_transducer's transcript search.",
+        default="unix:///tmp/transcript.sock",
+    )
     parser.add_argument(
         "--working_dir",
         type=Path,
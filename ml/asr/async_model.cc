@@ -0,0 +1,449 @@
+#include "ml/asr/async_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+#include "absl/strings/str_cat.h"
+
+namespace aikit::ml {
+namespace {
+// Chunk gives at most two events (final result on endpoint and one more on
+// flush), so this is enough to not stop the worker as long as the events
+// are polled after every push.
+size_t EventsCapacity(size_t queue_capacity) {
+    return 2 * (queue_capacity + 1);
+}
+
+// Re-decoding of the finals must not take the CPU from the live decoding.
+void LowerThreadPriority() {
+#if defined(__linux__)
+    // Nice value is per thread on Linux.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#elif defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#endif
+}
+}  // namespace
+
+absl::StatusOr<ASROverflowPolicy> ParseASROverflowPolicy(std::string_view name) {
+    if (name == "block") {
+        return ASROverflowPolicy::kBlock;
+    }
+    if (name == "drop_oldest") {
+        return ASROverflowPolicy::kDropOldest;
+    }
+    if (name == "shed_partials") {
+        return ASROverflowPolicy::kShedPartials;
+    }
+    return absl::InvalidArgumentError(absl::StrCat("Unknown ASR overflow policy: ", name));
+}
+
+AsyncASRModel::AsyncASRModel(ASRModel model, Options options)
+    : model_(std::move(model)),
+      options_(options),
+      sample_rate_(model_.sample_rate()),
+      chunks_(options_.queue_capacity),
+      events_(EventsCapacity(chunks_.capacity())) {
+    worker_ = std::thread(&AsyncASRModel::WorkerLoop, this);
+}
+
+AsyncASRModel::AsyncASRModel(ASRModel fast_model, ASRModel final_model, Options options)
+    : model_(std::move(fast_model)),
+      final_model_(std::move(final_model)),
+      options_(options),
+      sample_rate_(model_.sample_rate()),
+      chunks_(options_.queue_capacity),
+      events_(EventsCapacity(chunks_.capacity()) + options_.max_pending_utterances) {
+    worker_ = std::thread(&AsyncASRModel::WorkerLoop, this);
+    final_worker_ = std::thread(&AsyncASRModel::FinalWorkerLoop, this);
+}
+
+AsyncASRModel::~AsyncASRModel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    worker_cv_.notify_one();
+    final_worker_cv_.notify_one();
+    worker_.join();
+    if (final_worker_.joinable()) {
+        final_worker_.join();
+    }
+}
+
+void AsyncASRModel::Push(ASRChunk chunk) {
+    while (!chunks_.TryPush(chunk)) {
+        if (options_.overflow_policy == ASROverflowPolicy::kDropOldest) {
+            if (auto dropped = chunks_.TryPop()) {
+                // The utterance of the dropped chunk still has to be finished.
+                chunk.flush = chunk.flush || dropped->flush;
+                dropped_chunks_.fetch_add(1, std::memory_order_relaxed);
+                in_flight_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        blocked_pushes_.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(mutex_);
+        producer_waiting_.store(true, std::memory_order_relaxed);
+        // Pairs with the fence in NotifyProducer: either the worker sees
+        // the flag or we see the free slot.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        producer_cv_.wait(lock, [this] { return chunks_.size() < chunks_.capacity(); });
+        producer_waiting_.store(false, std::memory_order_relaxed);
+    }
+    in_flight_.fetch_add(1, std::memory_order_relaxed);
+    pushed_timestamps_.push_back(chunk.timestamp_us);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker_waiting_.load(std::memory_order_relaxed)) {
+        // The worker holds the mutex until it sleeps, so the notification can't be lost.
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        worker_cv_.notify_one();
+    }
+}
+
+std::optional<ASREvent> AsyncASRModel::PollEvent() {
+    return events_.TryPop();
+}
+
+bool AsyncASRModel::WaitIdle(absl::Duration timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    producer_waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const bool idle = producer_cv_.wait_for(lock, absl::ToChronoMilliseconds(timeout), [this] {
+        return in_flight_.load(std::memory_order_relaxed) == 0 ||
+               events_.size() >= events_.capacity();
+    });
+    producer_waiting_.store(false, std::memory_order_relaxed);
+    return idle && in_flight_.load(std::memory_order_relaxed) == 0;
+}
+
+std::optional<int64_t> AsyncASRModel::PendingTimestampUs() {
+    // The queue is FIFO, so the chunks popped by the worker or dropped by
+    // Push are the first pushed ones. The last popped one may still be
+    // decoded, the worker publishes it before counting it as popped.
+    const uint64_t removed =
+        popped_chunks_.load(std::memory_order_acquire) + dropped_chunks_.load(std::memory_order_relaxed);
+    int64_t timestamp_us = decoding_timestamp_us_.load(std::memory_order_acquire);
+    while (num_removed_timestamps_ < removed && !pushed_timestamps_.empty()) {
+        pushed_timestamps_.pop_front();
+        ++num_removed_timestamps_;
+    }
+    if (!pushed_timestamps_.empty()) {
+        timestamp_us = std::min(timestamp_us, pushed_timestamps_.front());
+    }
+    if (final_model_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        timestamp_us = std::min(timestamp_us, redecoding_timestamp_us_);
+        if (!utterances_.empty()) {
+            timestamp_us = std::min(timestamp_us, utterances_.front().fast_event.timestamp_us);
+        }
+    }
+    if (timestamp_us == kNoTimestamp) {
+        return std::nullopt;
+    }
+    return timestamp_us;
+}
+
+AsyncASRModel::Counters AsyncASRModel::counters() const {
+    Counters counters;
+    counters.blocked_pushes = blocked_pushes_.load(std::memory_order_relaxed);
+    counters.dropped_chunks = dropped_chunks_.load(std::memory_order_relaxed);
+    counters.shed_partials = shed_partials_.load(std::memory_order_relaxed);
+    counters.skipped_second_passes = skipped_second_passes_.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void AsyncASRModel::NotifyProducer() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (producer_waiting_.load(std::memory_order_relaxed)) {
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        producer_cv_.notify_one();
+    }
+}
+
+void AsyncASRModel::WorkerLoop() {
+    while (!stopping_) {
+        auto chunk = chunks_.TryPop();
+        if (!chunk) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            worker_waiting_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            worker_cv_.wait(lock, [this] { return stopping_ || chunks_.size() > 0; });
+            worker_waiting_.store(false, std::memory_order_relaxed);
+            if (stopping_) {
+                return;
+            }
+            continue;
+        }
+        decoding_timestamp_us_.store(chunk->timestamp_us, std::memory_order_release);
+        popped_chunks_.fetch_add(1, std::memory_order_release);
+        // The slot is free now.
+        NotifyProducer();
+
+        Decode(*chunk);
+        decoding_timestamp_us_.store(kNoTimestamp, std::memory_order_release);
+        in_flight_.fetch_sub(1, std::memory_order_relaxed);
+        NotifyProducer();
+    }
+}
+
+void AsyncASRModel::FinalWorkerLoop() {
+    LowerThreadPriority();
+    while (true) {
+        Utterance utterance;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            final_worker_cv_.wait(lock, [this] { return stopping_ || !utterances_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            utterance = std::move(utterances_.front());
+            utterances_.pop_front();
+            num_queued_redecodes_ -= utterance.samples.empty() ? 0 : 1;
+            redecoding_timestamp_us_ = utterance.fast_event.timestamp_us;
+        }
+        if (utterance.samples.empty()) {
+            Emit(std::move(utterance.fast_event));
+        } else {
+            Redecode(utterance);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --num_pending_finals_;
+            redecoding_timestamp_us_ = kNoTimestamp;
+        }
+        in_flight_.fetch_sub(1, std::memory_order_relaxed);
+        NotifyProducer();
+    }
+}
+
+void AsyncASRModel::Decode(ASRChunk& chunk) {
+    for (const auto& segment : chunk.segments) {
+        AddSegment(decoded_samples_ + segment.offset, segment.timestamp_us);
+    }
+    decoded_samples_ += chunk.samples.size();
+    if (final_model_) {
+        utterance_samples_.insert(utterance_samples_.end(), chunk.samples.begin(), chunk.samples.end());
+    }
+
+    auto status = chunk.samples.empty() ? absl::UnavailableError("No audio") : model_(chunk.samples, result_);
+    if (status.ok()) {
+        FinishUtterance(chunk.timestamp_us);
+    } else if (absl::IsUnavailable(status) && chunk.partial && !chunk.flush) {
+        if (options_.overflow_policy == ASROverflowPolicy::kShedPartials && chunks_.size() > 0) {
+            shed_partials_.fetch_add(1, std::memory_order_relaxed);
+        } else if (auto partial = model_.PartialResult(); partial.ok()) {
+            ASREvent event;
+            event.type = ASREvent::Type::kPartial;
+            event.timestamp_us = chunk.timestamp_us;
+            event.partial = std::move(partial.value());
+            Emit(std::move(event));
+        }
+    }
+
+    if (chunk.flush && model_.Flush(result_).ok() && !result_.text.empty()) {
+        FinishUtterance(chunk.timestamp_us);
+    }
+    if (chunk.flush) {
+        // Nothing was recognized in the rest of the audio.
+        utterance_samples_.clear();
+        utterance_first_sample_ = decoded_samples_;
+    }
+}
+
+void AsyncASRModel::FinishUtterance(int64_t timestamp_us) {
+    ASREvent event;
+    event.type = ASREvent::Type::kFinal;
+    event.timestamp_us = timestamp_us;
+    event.word_timestamps.reserve(result_.words.size());
+    for (const auto& word : result_.words) {
+        event.word_timestamps.push_back({ToTimestampUs(segments_, std::llround(word.start * sample_rate_)),
+                                         ToTimestampUs(segments_, std::llround(word.end * sample_rate_))});
+    }
+
+    // The endpoint may be in the middle of the chunk, the audio after the
+    // last word starts the next utterance.
+    int64_t end_sample = decoded_samples_;
+    if (!result_.words.empty()) {
+        end_sample = std::clamp<int64_t>(std::llround(result_.words.back().end * sample_rate_),
+                                         utterance_first_sample_, decoded_samples_);
+    }
+    const auto utterance_end =
+        utterance_samples_.begin() + std::min<int64_t>(end_sample - utterance_first_sample_, utterance_samples_.size());
+    std::vector<int16_t> next_samples(utterance_end, utterance_samples_.end());
+    utterance_samples_.erase(utterance_end, utterance_samples_.end());
+
+    // Silence is not worth re-decoding.
+    std::optional<Utterance> utterance;
+    if (final_model_ && !result_.text.empty() && !utterance_samples_.empty()) {
+        utterance.emplace();
+        utterance->samples = std::move(utterance_samples_);
+        utterance->segments = UtteranceSegments();
+    }
+    utterance_samples_ = std::move(next_samples);
+    utterance_first_sample_ = end_sample;
+
+    // Next results start after the last word, so earlier segments
+    // are not needed anymore.
+    if (!result_.words.empty()) {
+        const int64_t last_sample = std::llround(result_.words.back().end * sample_rate_);
+        while (segments_.size() > 1 && segments_[1].first_sample <= last_sample) {
+            segments_.pop_front();
+        }
+    }
+
+    event.result = std::move(result_);
+    if (!final_model_) {
+        Emit(std::move(event));
+        return;
+    }
+
+    bool second_pass;
+    bool in_order;
+    {
+        // Only this thread adds utterances, so there is still room after the check.
+        std::lock_guard<std::mutex> lock(mutex_);
+        second_pass = utterance && num_queued_redecodes_ < options_.max_pending_utterances;
+        // Finals are emitted in order, so while the final model has pending
+        // utterances the other finals wait behind them.
+        in_order = second_pass || num_pending_finals_ > 0;
+    }
+    if (utterance && !second_pass) {
+        skipped_second_passes_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!in_order) {
+        Emit(std::move(event));
+        return;
+    }
+
+    Utterance pending;
+    if (second_pass) {
+        pending = std::move(utterance.value());
+    }
+    if (!event.result.text.empty()) {
+        event.type = ASREvent::Type::kFastFinal;
+        pending.fast_event = event;
+        Emit(std::move(event));
+        pending.fast_event.type = ASREvent::Type::kFinal;
+    } else {
+        pending.fast_event = std::move(event);
+    }
+
+    in_flight_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        num_queued_redecodes_ += second_pass ? 1 : 0;
+        ++num_pending_finals_;
+        utterances_.push_back(std::move(pending));
+    }
+    final_worker_cv_.notify_one();
+}
+
+void AsyncASRModel::Redecode(Utterance& utterance) {
+    // Word times of the recognizer count from the first audio it got.
+    const int64_t first_sample = final_decoded_samples_;
+    final_decoded_samples_ += utterance.samples.size();
+
+    ASREvent event;
+    event.type = ASREvent::Type::kFinal;
+    event.timestamp_us = utterance.fast_event.timestamp_us;
+    size_t max_piece_words = 0;
+    // Endpointing of the final model may split the utterance, the pieces are joined.
+    auto append = [&](ASRResult& piece) {
+        if (piece.words.empty()) {
+            return;
+        }
+        if (!event.result.text.empty()) {
+            event.result.text += ' ';
+        }
+        event.result.text += piece.text;
+        for (auto& word : piece.words) {
+            event.word_timestamps.push_back(
+                {ToTimestampUs(utterance.segments, std::llround(word.start * sample_rate_) - first_sample),
+                 ToTimestampUs(utterance.segments, std::llround(word.end * sample_rate_) - first_sample)});
+            event.result.words.push_back(std::move(word));
+        }
+        if (piece.words.size() > max_piece_words) {
+            max_piece_words = piece.words.size();
+            event.result.spk_embedding = std::move(piece.spk_embedding);
+        }
+    };
+    if ((*final_model_)(utterance.samples, final_result_).ok()) {
+        append(final_result_);
+    }
+    if (final_model_->Flush(final_result_).ok()) {
+        append(final_result_);
+    }
+
+    Emit(event.result.words.empty() ? std::move(utterance.fast_event) : std::move(event));
+}
+
+void AsyncASRModel::Emit(ASREvent event) {
+    while (!events_.TryPush(event)) {
+        // Consumer is late, it's not expected when it polls after
+        // every push (see EventsCapacity).
+        NotifyProducer();
+        if (stopping_) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void AsyncASRModel::AddSegment(int64_t first_sample, int64_t timestamp_us) {
+    const int64_t sample_rate = sample_rate_;
+    if (!segments_.empty()) {
+        // Audio continues the previous segment, no need for a new one.
+        const auto& last = segments_.back();
+        const int64_t expected_us = last.timestamp_us + (first_sample - last.first_sample) * 1000000 / sample_rate;
+        if (std::abs(timestamp_us - expected_us) <= 1000000 / sample_rate) {
+            return;
+        }
+    }
+    segments_.push_back({first_sample, timestamp_us});
+}
+
+std::deque<AsyncASRModel::TimelineSegment> AsyncASRModel::UtteranceSegments() const {
+    const int64_t sample_rate = sample_rate_;
+    std::deque<TimelineSegment> segments;
+    for (const auto& segment : segments_) {
+        const int64_t first_sample = segment.first_sample - utterance_first_sample_;
+        if (first_sample <= 0) {
+            // Starts before the utterance, the last such one covers its start.
+            segments.clear();
+            segments.push_back({0, segment.timestamp_us - first_sample * 1000000 / sample_rate});
+        } else {
+            segments.push_back({first_sample, segment.timestamp_us});
+        }
+    }
+    return segments;
+}
+
+int64_t AsyncASRModel::ToTimestampUs(const std::deque<TimelineSegment>& segments, int64_t sample) const {
+    const int64_t sample_rate = sample_rate_;
+    if (segments.empty()) {
+        return sample * 1000000 / sample_rate;
+    }
+    // The last segment which starts not after the sample.
+    auto it = std::upper_bound(segments.begin(), segments.end(), sample,
+                               [](int64_t sample, const TimelineSegment& segment) {
+                                   return sample < segment.first_sample;
+                               });
+    if (it != segments.begin()) {
+        --it;
+    }
+    return it->timestamp_us + (sample - it->first_sample) * 1000000 / sample_rate;
+}
+
+}  // namespace aikit::ml
@@ -0,0 +1,222 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "ml/asr/bounded_queue.h"
+#include "ml/asr/model.h"
+
+namespace aikit::ml {
+
+// Continuous piece of audio of a chunk, `offset` is the index of its
+// first sample in the chunk.
+struct ASRAudioSegment {
+    int64_t offset;
+    int64_t timestamp_us;
+};
+
+struct ASRChunk {
+    std::vector<int16_t> samples;
+    // Position of the samples on the media timeline, the first segment
+    // starts at offset 0.
+    std::vector<ASRAudioSegment> segments;
+    // Results of the chunk get this timestamp, usually it's the timestamp
+    // of the input which completed the chunk.
+    int64_t timestamp_us = 0;
+    // Finish the utterance after the chunk.
+    bool flush = false;
+    // Compute the partial hypothesis after the chunk, if it didn't finish
+    // the utterance.
+    bool partial = false;
+};
+
+struct ASRWordTimestamp {
+    int64_t start_us;
+    int64_t end_us;
+};
+
+struct ASREvent {
+    // kFastFinal is the result of the fast model in the two-pass mode, the
+    // kFinal of the same utterance follows when the final model re-decodes it.
+    enum class Type { kFinal, kPartial, kFastFinal };
+    Type type;
+    int64_t timestamp_us;
+    // Set for kFinal and kFastFinal.
+    ASRResult result;
+    // Position of result.words on the media timeline.
+    std::vector<ASRWordTimestamp> word_timestamps;
+    // Set for kPartial.
+    ASRPartialResult partial;
+};
+
+// What Push does when the decoder falls behind and the queue is full.
+enum class ASROverflowPolicy {
+    // Wait until the worker takes a chunk.
+    kBlock,
+    // Drop the oldest queued chunk, the transcription gets a gap, but the
+    // latency stays bounded.
+    kDropOldest,
+    // Wait as kBlock, and don't compute partial hypotheses while there are
+    // queued chunks, they would be stale anyway.
+    kShedPartials,
+};
+
+// Parses "block", "drop_oldest" or "shed_partials".
+absl::StatusOr<ASROverflowPolicy> ParseASROverflowPolicy(std::string_view name);
+
+// AsyncASRModel runs ASRModel on its own thread.
+//
+// Audio is passed to the worker through a bounded lock-free queue of chunks
+// and the results come back through another one, so the producer never
+// waits for the decoder unless the queue is full and the policy is to block.
+// The mutex is used only to park the threads when there is nothing to do.
+//
+// In the two-pass mode a small fast model decodes the stream and gives
+// partial hypotheses and kFastFinal results with low latency, and the
+// audio of every finished utterance is re-decoded by the large final
+// model on another thread with lower priority, which gives the kFinal
+// result. If the final model falls behind by max_pending_utterances,
+// the fast result becomes final. Finals are emitted in the order of
+// the utterances either way.
+//
+// Push, PollEvent and WaitIdle must be called from one thread.
+class AsyncASRModel {
+public:
+  struct Options {
+    size_t queue_capacity = 16;
+    ASROverflowPolicy overflow_policy = ASROverflowPolicy::kBlock;
+    // Utterances waiting for the final model in the two-pass mode.
+    size_t max_pending_utterances = 4;
+  };
+
+  struct Counters {
+    // Push had to wait for a free slot in the queue.
+    uint64_t blocked_pushes = 0;
+    // Chunks dropped by ASROverflowPolicy::kDropOldest.
+    uint64_t dropped_chunks = 0;
+    // Partial hypotheses skipped by ASROverflowPolicy::kShedPartials.
+    uint64_t shed_partials = 0;
+    // Utterances of the two-pass mode finalized by the fast model, because
+    // the final model was behind.
+    uint64_t skipped_second_passes = 0;
+  };
+
+  AsyncASRModel(ASRModel model, Options options);
+  // Two-pass mode, see above.
+  AsyncASRModel(ASRModel fast_model, ASRModel final_model, Options options);
+  // Stops the workers, queued chunks and utterances are not decoded.
+  ~AsyncASRModel();
+
+  AsyncASRModel(const AsyncASRModel&) = delete;
+  AsyncASRModel& operator=(const AsyncASRModel&) = delete;
+
+  void Push(ASRChunk chunk);
+  // Returns the next result, if there is one.
+  std::optional<ASREvent> PollEvent();
+  // Waits up to `timeout` until all pushed chunks are decoded, returns true
+  // if they are. Events have to be polled meanwhile, the worker stops when
+  // there is no room for them.
+  bool WaitIdle(absl::Duration timeout);
+  // Timestamp of the oldest pushed chunk or utterance which is not decoded
+  // yet, the results still to come have it or a later one. Empty when all
+  // pushed chunks are decoded.
+  std::optional<int64_t> PendingTimestampUs();
+
+  Counters counters() const;
+
+private:
+  // Position of a continuous piece of the decoded audio on the timeline.
+  struct TimelineSegment {
+    int64_t first_sample;
+    int64_t timestamp_us;
+  };
+
+  // Audio of a finished utterance for the final model. An utterance without
+  // samples is not re-decoded, it keeps its fast_event in order with the
+  // finals of the earlier utterances.
+  struct Utterance {
+    std::vector<int16_t> samples;
+    // Timeline of the samples, first_sample is relative to the utterance.
+    std::deque<TimelineSegment> segments;
+    // The fast result, it's final if the final model finds nothing.
+    ASREvent fast_event;
+  };
+
+  void WorkerLoop();
+  void FinalWorkerLoop();
+  void Decode(ASRChunk& chunk);
+  // Emits result_ of the fast worker.
+  void FinishUtterance(int64_t timestamp_us);
+  void Redecode(Utterance& utterance);
+  void Emit(ASREvent event);
+  void AddSegment(int64_t first_sample, int64_t timestamp_us);
+  // Segments of the current utterance of the two-pass mode.
+  std::deque<TimelineSegment> UtteranceSegments() const;
+  int64_t ToTimestampUs(const std::deque<TimelineSegment>& segments, int64_t sample) const;
+  // Wakes up the producer if it waits in Push or WaitIdle.
+  void NotifyProducer();
+
+  ASRModel model_;
+  std::optional<ASRModel> final_model_;
+  Options options_;
+  size_t sample_rate_;
+  BoundedQueue<ASRChunk> chunks_;
+  BoundedQueue<ASREvent> events_;
+
+  // Pushed and not yet decoded (or dropped) chunks.
+  std::atomic<size_t> in_flight_{0};
+  // Timestamps of the pushed chunks, the first ones are taken from the
+  // queue already, owned by the producer.
+  std::deque<int64_t> pushed_timestamps_;
+  // Chunks taken from the queue by the worker, the one it decodes, if any.
+  std::atomic<uint64_t> popped_chunks_{0};
+  std::atomic<int64_t> decoding_timestamp_us_{kNoTimestamp};
+  static constexpr int64_t kNoTimestamp = INT64_MAX;
+  std::atomic<bool> stopping_{false};
+  std::atomic<uint64_t> blocked_pushes_{0};
+  std::atomic<uint64_t> dropped_chunks_{0};
+  std::atomic<uint64_t> shed_partials_{0};
+  std::atomic<uint64_t> skipped_second_passes_{0};
+
+  std::mutex mutex_;
+  std::condition_variable worker_cv_;
+  std::condition_variable producer_cv_;
+  std::condition_variable final_worker_cv_;
+  std::atomic<bool> worker_waiting_{false};
+  std::atomic<bool> producer_waiting_{false};
+
+  // Owned by the worker.
+  int64_t decoded_samples_ = 0;
+  std::deque<TimelineSegment> segments_;
+  ASRResult result_;
+  // Audio of the current utterance and its first sample, two-pass mode only.
+  std::vector<int16_t> utterance_samples_;
+  int64_t utterance_first_sample_ = 0;
+
+  // Waiting for the final model, guarded by mutex_.
+  std::deque<Utterance> utterances_;
+  // Utterances of utterances_ with samples, limited by max_pending_utterances.
+  size_t num_queued_redecodes_ = 0;
+  // Utterances which are queued or being re-decoded, the finals emitted by
+  // the fast worker wait behind them.
+  size_t num_pending_finals_ = 0;
+  // Timestamp of the utterance being re-decoded.
+  int64_t redecoding_timestamp_us_ = kNoTimestamp;
+  // Chunks removed from pushed_timestamps_, owned by the producer.
+  uint64_t num_removed_timestamps_ = 0;
+  // Owned by the final worker.
+  int64_t final_decoded_samples_ = 0;
+  ASRResult final_result_;
+
+  std::thread worker_;
+  std::thread final_worker_;
+};
+
+}  // namespace aikit::ml
@@ -0,0 +1,153 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ml/asr/async_model.h"
+#include "ml/asr/test_audio.h"
+
+#include "absl/log/absl_log.h"
+
+namespace {
+// The audio is split into `num_utterances` parts, every part is flushed.
+std::vector<aikit::ml::ASREvent> Transcribe(aikit::ml::AsyncASRModel& model, const std::vector<int16_t>& audio,
+                                           size_t num_utterances = 1) {
+    std::vector<aikit::ml::ASREvent> events;
+    auto poll = [&] {
+        while (auto event = model.PollEvent()) {
+            events.push_back(std::move(event.value()));
+        }
+    };
+
+    // 200 ms chunks, timestamps are in microseconds from the start of the audio.
+    constexpr size_t chunk_size = 3200;
+    const size_t utterance_chunks = (audio.size() + chunk_size * num_utterances - 1) / (chunk_size * num_utterances);
+    for (size_t i = 0; i < audio.size(); i += chunk_size) {
+        aikit::ml::ASRChunk chunk;
+        chunk.samples.assign(audio.begin() + i, audio.begin() + std::min(audio.size(), i + chunk_size));
+        chunk.segments.push_back({0, static_cast<int64_t>(i) * 1000000 / 16000});
+        chunk.timestamp_us = static_cast<int64_t>(i + chunk.samples.size()) * 1000000 / 16000;
+        chunk.partial = true;
+        chunk.flush = i + chunk_size >= audio.size() || (i / chunk_size + 1) % utterance_chunks == 0;
+        model.Push(std::move(chunk));
+        poll();
+    }
+    while (!model.WaitIdle(absl::Milliseconds(100))) {
+        poll();
+    }
+    poll();
+    return events;
+}
+}  // namespace
+
+TEST(TestMLASRAsyncModel, ParsesOverflowPolicy) {
+    EXPECT_EQ(aikit::ml::ParseASROverflowPolicy("block").value(), aikit::ml::ASROverflowPolicy::kBlock);
+    EXPECT_EQ(aikit::ml::ParseASROverflowPolicy("drop_oldest").value(), aikit::ml::ASROverflowPolicy::kDropOldest);
+    EXPECT_EQ(aikit::ml::ParseASROverflowPolicy("shed_partials").value(),
+              aikit::ml::ASROverflowPolicy::kShedPartials);
+    EXPECT_FALSE(aikit::ml::ParseASROverflowPolicy("drop_newest").ok());
+}
+
+TEST(TestMLASRAsyncModel, DecodesAllChunksWhenBlocking) {
+    auto model = aikit::ml::AsyncASRModel(
+        aikit::ml::ASRModel("ml/asr/models/vosk-model-ru-0.42", "ml/asr/models/vosk-model-spk-0.4"),
+        {.queue_capacity = 4, .overflow_policy = aikit::ml::ASROverflowPolicy::kBlock});
+    auto events = Transcribe(model, aikit::ml::ReadTestAudio());
+
+    int64_t prev_timestamp_us = 0;
+    int64_t prev_word_end_us = 0;
+    size_t num_finals = 0;
+    for (const auto& event : events) {
+        EXPECT_LE(prev_timestamp_us, event.timestamp_us);
+        prev_timestamp_us = event.timestamp_us;
+        if (event.type != aikit::ml::ASREvent::Type::kFinal) {
+            continue;
+        }
+        ++num_finals;
+        ABSL_LOG(INFO) << event.result.text;
+        ASSERT_EQ(event.word_timestamps.size(), event.result.words.size());
+        for (const auto& word : event.word_timestamps) {
+            EXPECT_LE(prev_word_end_us, word.start_us);
+            EXPECT_LE(word.start_us, word.end_us);
+            EXPECT_LE(word.end_us, event.timestamp_us);
+            prev_word_end_us = word.end_us;
+        }
+    }
+    EXPECT_GT(num_finals, 0);
+    EXPECT_EQ(model.counters().dropped_chunks, 0);
+    EXPECT_EQ(model.counters().shed_partials, 0);
+}
+
+TEST(TestMLASRAsyncModel, DropsOldestChunksWhenBehind) {
+    auto model = aikit::ml::AsyncASRModel(
+        aikit::ml::ASRModel("ml/asr/models/vosk-model-ru-0.42", "ml/asr/models/vosk-model-spk-0.4"),
+        {.queue_capacity = 2, .overflow_policy = aikit::ml::ASROverflowPolicy::kDropOldest});
+    // Audio is pushed much faster than real time, so the decoder can't keep up.
+    Transcribe(model, aikit::ml::ReadTestAudio());
+
+    EXPECT_GT(model.counters().dropped_chunks, 0);
+    EXPECT_EQ(model.counters().blocked_pushes, 0);
+}
+
+TEST(TestMLASRAsyncModel, TwoPassReplacesFastFinals) {
+    auto model = aikit::ml::AsyncASRModel(
+        aikit::ml::ASRModel("ml/asr/models/vosk-model-small-ru-0.22", "ml/asr/models/vosk-model-spk-0.4"),
+        aikit::ml::ASRModel("ml/asr/models/vosk-model-ru-0.42", "ml/asr/models/vosk-model-spk-0.4"),
+        {.queue_capacity = 4, .overflow_policy = aikit::ml::ASROverflowPolicy::kBlock,
+         .max_pending_utterances = 64});
+    auto events = Transcribe(model, aikit::ml::ReadTestAudio());
+
+    size_t num_fast_finals = 0;
+    size_t num_finals = 0;
+    for (const auto& event : events) {
+        if (event.type == aikit::ml::ASREvent::Type::kFastFinal) {
+            ++num_fast_finals;
+            // The final of the utterance comes after its fast result.
+            EXPECT_GT(num_fast_finals, num_finals);
+        } else if (event.type == aikit::ml::ASREvent::Type::kFinal) {
+            ++num_finals;
+            ABSL_LOG(INFO) << event.result.text;
+            ASSERT_EQ(event.word_timestamps.size(), event.result.words.size());
+            for (const auto& word : event.word_timestamps) {
+                EXPECT_LE(word.start_us, word.end_us);
+                EXPECT_LE(word.end_us, event.timestamp_us);
+            }
+        }
+    }
+    EXPECT_GT(num_fast_finals, 0);
+    EXPECT_EQ(num_finals, num_fast_finals);
+    EXPECT_EQ(model.counters().skipped_second_passes, 0);
+}
+
+TEST(TestMLASRAsyncModel, TwoPassKeepsFinalsInOrder) {
+    auto model = aikit::ml::AsyncASRModel(
+        aikit::ml::ASRModel("ml/asr/models/vosk-model-small-ru-0.22", "ml/asr/models/vosk-model-spk-0.4"),
+        aikit::ml::ASRModel("ml/asr/models/vosk-model-ru-0.42", "ml/asr/models/vosk-model-spk-0.4"),
+        {.queue_capacity = 4, .overflow_policy = aikit::ml::ASROverflowPolicy::kBlock,
+         .max_pending_utterances = 1});
+    // Flushes come faster than the final model re-decodes, so some
+    // utterances are finalized by the fast model.
+    auto events = Transcribe(model, aikit::ml::ReadTestAudio(), 3);
+
+    size_t num_fast_finals = 0;
+    size_t num_finals = 0;
+    int64_t prev_timestamp_us = 0;
+    int64_t prev_word_end_us = 0;
+    for (const auto& event : events) {
+        if (event.type == aikit::ml::ASREvent::Type::kFastFinal) {
+            ++num_fast_finals;
+        } else if (event.type == aikit::ml::ASREvent::Type::kFinal && !event.result.text.empty()) {
+            ++num_finals;
+            EXPECT_LE(num_finals, num_fast_finals);
+            EXPECT_LE(prev_timestamp_us, event.timestamp_us);
+            prev_timestamp_us = event.timestamp_us;
+            for (const auto& word : event.word_timestamps) {
+                EXPECT_LE(prev_word_end_us, word.start_us);
+                prev_word_end_us = word.end_us;
+            }
+        }
+    }
+    EXPECT_GE(num_finals, 3);
+    EXPECT_EQ(num_finals, num_fast_finals);
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace aikit::ml {
+
+// Bounded lock-free queue for many producers and many consumers
+// (D. Vyukov's bounded MPMC queue).
+//
+// Every cell has a sequence number, which tells whether the cell is free
+// for the producer of the given position or holds a value for the consumer
+// of it. Producers and consumers only race for the position counters, so
+// an operation is a couple of atomic operations and never blocks.
+//
+// Capacity is rounded up to the power of two.
+template <typename T>
+class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity)
+      : mask_(RoundUpToPowerOfTwo(capacity) - 1),
+        cells_(new Cell[mask_ + 1]) {
+    for (size_t i = 0; i <= mask_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~BoundedQueue() {
+    while (TryPop()) {
+    }
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  // Returns false and leaves `value` untouched when the queue is full.
+  bool TryPush(T& value) {
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[position & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+      if (diff == 0) {
+        if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+    new (&cell->storage) T(std::move(value));
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::optional<T> TryPop() {
+    size_t position = dequeue_position_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[position & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+      if (diff == 0) {
+        if (dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return std::nullopt;
+      } else {
+        position = dequeue_position_.load(std::memory_order_relaxed);
+      }
+    }
+    T* stored = std::launder(reinterpret_cast<T*>(&cell->storage));
+    std::optional<T> value(std::move(*stored));
+    stored->~T();
+    cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+    return value;
+  }
+
+  // Approximate number of values in the queue, exact when there are no
+  // concurrent operations.
+  size_t size() const {
+    const size_t enqueued = enqueue_position_.load(std::memory_order_acquire);
+    const size_t dequeued = dequeue_position_.load(std::memory_order_acquire);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+  };
+
+  static size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  // Producers and consumers update different counters, keep them
+  // on different cache lines.
+  static constexpr size_t kCacheLineSize = 64;
+
+  const size_t mask_;
+  const std::unique_ptr<Cell[]> cells_;
+  alignas(kCacheLineSize) std::atomic<size_t> enqueue_position_{0};
+  alignas(kCacheLineSize) std::atomic<size_t> dequeue_position_{0};
+};
+
+}  // namespace aikit::ml
@@ -0,0 +1,69 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ml/asr/bounded_queue.h"
+
+TEST(TestMLASRBoundedQueue, KeepsOrderAndCapacity) {
+    aikit::ml::BoundedQueue<std::unique_ptr<int>> queue(3);
+    EXPECT_EQ(queue.capacity(), 4);
+    EXPECT_FALSE(queue.TryPop());
+
+    for (int i = 0; i < 4; ++i) {
+        auto value = std::make_unique<int>(i);
+        EXPECT_TRUE(queue.TryPush(value));
+    }
+    auto extra = std::make_unique<int>(4);
+    EXPECT_FALSE(queue.TryPush(extra));
+    // Value is not consumed by the failed push.
+    ASSERT_TRUE(extra);
+    EXPECT_EQ(queue.size(), 4);
+
+    for (int i = 0; i < 4; ++i) {
+        auto value = queue.TryPop();
+        ASSERT_TRUE(value);
+        EXPECT_EQ(**value, i);
+    }
+    EXPECT_FALSE(queue.TryPop());
+    EXPECT_TRUE(queue.TryPush(extra));
+}
+
+TEST(TestMLASRBoundedQueue, ConcurrentProducersAndConsumers) {
+    constexpr int kThreads = 4;
+    constexpr int kValuesPerThread = 100000;
+    aikit::ml::BoundedQueue<int64_t> queue(64);
+
+    std::atomic<int64_t> sum{0};
+    std::atomic<int> popped{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&queue, t] {
+            for (int i = 0; i < kValuesPerThread; ++i) {
+                int64_t value = t * kValuesPerThread + i;
+                while (!queue.TryPush(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&queue, &sum, &popped] {
+            while (popped.load() < kThreads * kValuesPerThread) {
+                if (auto value = queue.TryPop()) {
+                    sum += *value;
+                    ++popped;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const int64_t n = kThreads * kValuesPerThread;
+    EXPECT_EQ(popped.load(), n);
+    EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+}
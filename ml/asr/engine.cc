@@ -0,0 +1,121 @@
+#include "ml/asr/engine.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace aikit::ml {
+
+ASREngine::ASREngine(Options options) : options_(std::move(options)) {
+    workers_.reserve(options_.num_workers);
+    for (size_t i = 0; i < options_.num_workers; ++i) {
+        workers_.emplace_back(&ASREngine::WorkerLoop, this);
+    }
+}
+
+ASREngine::~ASREngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+absl::StatusOr<ASREngine::SessionId> ASREngine::OpenSession(ResultCallback on_result) {
+    std::unique_ptr<Session> session;
+    try {
+        // Models are taken from the registry, so only recognizer is created here.
+        session = std::unique_ptr<Session>(new Session{
+            .id = 0,
+            .model = ASRModel(options_.model_path, options_.spk_model_path, options_.sample_rate),
+            .on_result = std::move(on_result),
+        });
+    } catch (const std::exception& e) {
+        return absl::InternalError(absl::StrCat("Failed to open ASR session: ", e.what()));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    session->id = next_session_id_++;
+    auto session_id = session->id;
+    sessions_.emplace(session_id, std::move(session));
+    return session_id;
+}
+
+absl::Status ASREngine::Submit(SessionId session_id, std::vector<int16_t> chunk) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = sessions_.find(session_id);
+        if (it == sessions_.end() || it->second->closing) {
+            return absl::NotFoundError(absl::StrCat("No open ASR session ", session_id));
+        }
+        auto* session = it->second.get();
+        if (session->pending.size() >= options_.max_pending_chunks) {
+            return absl::ResourceExhaustedError(
+                absl::StrCat("ASR session ", session_id, " has too many pending chunks"));
+        }
+        session->pending.push_back(std::move(chunk));
+        if (session->scheduled) {
+            return absl::OkStatus();
+        }
+        session->scheduled = true;
+        ready_.push_back(session);
+    }
+    ready_cv_.notify_one();
+    return absl::OkStatus();
+}
+
+absl::Status ASREngine::CloseSession(SessionId session_id) {
+    std::unique_ptr<Session> session;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = sessions_.find(session_id);
+        if (it == sessions_.end() || it->second->closing) {
+            return absl::NotFoundError(absl::StrCat("No open ASR session ", session_id));
+        }
+        auto* closing_session = it->second.get();
+        closing_session->closing = true;
+        progress_cv_.wait(lock, [closing_session] { return !closing_session->scheduled; });
+        session = std::move(it->second);
+        sessions_.erase(it);
+    }
+
+    auto result = session->model.Flush();
+    if (result.ok()) {
+        session->on_result(session->id, std::move(result.value()));
+    }
+    return absl::OkStatus();
+}
+
+void ASREngine::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        ready_cv_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+        if (stopping_) {
+            return;
+        }
+
+        auto* session = ready_.front();
+        ready_.pop_front();
+        auto chunk = std::move(session->pending.front());
+        session->pending.pop_front();
+
+        lock.unlock();
+        auto result = session->model(chunk);
+        if (result.ok()) {
+            session->on_result(session->id, std::move(result.value()));
+        }
+        lock.lock();
+
+        // Session goes to the end of the line, so others get their turn first.
+        if (session->pending.empty()) {
+            session->scheduled = false;
+        } else {
+            ready_.push_back(session);
+            ready_cv_.notify_one();
+        }
+        progress_cv_.notify_all();
+    }
+}
+
+}  // namespace aikit::ml
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "absl/status/statusor.h"
+#include "ml/asr/model.h"
+
+namespace aikit::ml {
+
+// ASREngine transcribes many audio streams (sessions) of the process on
+// a fixed pool of worker threads.
+//
+// Every session has its own recognizer over the shared models (see
+// VoskModelRegistry) and its own queue of audio chunks. Workers take
+// sessions in round-robin order and decode one chunk of a session at a
+// time, so a busy session can't starve the others. The recognizer state
+// is not thread safe, so a session is never decoded by two workers at once.
+//
+// Latency is bounded by the limit of pending chunks per session, Submit
+// fails with ResourceExhausted when a session falls behind for more than
+// max_pending_chunks chunks.
+class ASREngine {
+public:
+  struct Options {
+    std::string model_path;
+    std::string spk_model_path;
+    size_t sample_rate = 16000;
+    size_t num_workers = std::max(1u, std::thread::hardware_concurrency());
+    size_t max_pending_chunks = 32;
+  };
+
+  using SessionId = uint64_t;
+  // Called for every final result of the session, on a worker thread,
+  // and for the last utterance on the thread which calls CloseSession.
+  using ResultCallback = std::function<void(SessionId, ASRResult)>;
+
+  explicit ASREngine(Options options);
+  ~ASREngine();
+
+  ASREngine(const ASREngine&) = delete;
+  ASREngine& operator=(const ASREngine&) = delete;
+
+  absl::StatusOr<SessionId> OpenSession(ResultCallback on_result);
+  // Enqueues chunk of 16 bit PCM audio of the session.
+  absl::Status Submit(SessionId session_id, std::vector<int16_t> chunk);
+  // Waits until all submitted audio of the session is decoded, emits
+  // the last utterance and frees the recognizer.
+  absl::Status CloseSession(SessionId session_id);
+
+  size_t num_workers() const { return workers_.size(); }
+
+private:
+  struct Session {
+    SessionId id;
+    ASRModel model;
+    ResultCallback on_result;
+    std::deque<std::vector<int16_t>> pending;
+    // Session is either waiting in ready_ or decoded by a worker.
+    bool scheduled = false;
+    bool closing = false;
+  };
+
+  void WorkerLoop();
+
+  Options options_;
+
+  std::mutex mutex_;
+  // Notified when there is a new session in ready_ or on shutdown.
+  std::condition_variable ready_cv_;
+  // Notified when a worker finished a chunk.
+  std::condition_variable progress_cv_;
+  std::unordered_map<SessionId, std::unique_ptr<Session>> sessions_;
+  // Sessions with pending chunks in the order they will be served.
+  std::deque<Session*> ready_;
+  SessionId next_session_id_ = 0;
+  bool stopping_ = false;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace aikit::ml
@@ -0,0 +1,67 @@
+#include "benchmark/benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "ml/asr/engine.h"
+#include "ml/asr/test_audio.h"
+
+namespace {
+constexpr size_t kSampleRate = 16000;
+// 200ms chunks, like ASRCalculator feeds the recognizer.
+constexpr size_t kChunkSize = kSampleRate / 5;
+}  // namespace
+
+// Every session streams the same audio as fast as the engine accepts it.
+// aggregate_rtf is the wall time divided by the total duration of the
+// audio of all sessions, below 1 the engine is faster than real time.
+static void BM_ASREngine(benchmark::State& state) {
+    const size_t num_sessions = state.range(0);
+    auto engine = aikit::ml::ASREngine({
+        .model_path = "ml/asr/models/vosk-model-ru-0.42",
+        .spk_model_path = "ml/asr/models/vosk-model-spk-0.4",
+    });
+    auto audio = aikit::ml::ReadTestAudio();
+
+    std::atomic<size_t> num_results = 0;
+    double total_audio_sec = 0.0;
+    double total_wall_sec = 0.0;
+    for (auto _ : state) {
+        std::vector<aikit::ml::ASREngine::SessionId> sessions;
+        for (size_t i = 0; i < num_sessions; ++i) {
+            sessions.push_back(engine.OpenSession([&](auto, auto) { ++num_results; }).value());
+        }
+
+        auto start_time = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < audio.size(); i += kChunkSize) {
+            std::vector<int16_t> chunk(audio.begin() + i, audio.begin() + std::min(audio.size(), i + kChunkSize));
+            for (auto session_id : sessions) {
+                while (absl::IsResourceExhausted(engine.Submit(session_id, chunk))) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+        for (auto session_id : sessions) {
+            benchmark::DoNotOptimize(engine.CloseSession(session_id));
+        }
+        auto end_time = std::chrono::steady_clock::now();
+
+        total_wall_sec += std::chrono::duration<double>(end_time - start_time).count();
+        total_audio_sec += static_cast<double>(audio.size() * num_sessions) / kSampleRate;
+    }
+
+    state.counters["workers"] = engine.num_workers();
+    state.counters["aggregate_rtf"] = total_wall_sec / total_audio_sec;
+    state.counters["results"] = benchmark::Counter(num_results, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_ASREngine)
+    ->DenseRange(1, std::max(1u, std::thread::hardware_concurrency()))
+    ->MinWarmUpTime(2.0)
+    ->MinTime(5.0)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_MAIN();
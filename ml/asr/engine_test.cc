@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ml/asr/engine.h"
+#include "ml/asr/test_audio.h"
+
+#include "absl/log/absl_log.h"
+
+TEST(TestMLASREngine, DecodesConcurrentSessions) {
+    auto engine = aikit::ml::ASREngine({
+        .model_path = "ml/asr/models/vosk-model-ru-0.42",
+        .spk_model_path = "ml/asr/models/vosk-model-spk-0.4",
+        .num_workers = 2,
+    });
+
+    std::mutex mutex;
+    std::map<aikit::ml::ASREngine::SessionId, std::vector<std::string>> transcriptions;
+    auto on_result = [&](aikit::ml::ASREngine::SessionId session_id, aikit::ml::ASRResult result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        transcriptions[session_id].push_back(std::move(result.text));
+    };
+
+    std::vector<aikit::ml::ASREngine::SessionId> sessions;
+    for (int i = 0; i < 3; ++i) {
+        auto session_id = engine.OpenSession(on_result);
+        ASSERT_TRUE(session_id.ok()) << session_id.status().message();
+        sessions.push_back(session_id.value());
+    }
+
+    auto audio = aikit::ml::ReadTestAudio();
+    constexpr size_t chunk_size = 3200;
+    for (size_t i = 0; i < audio.size(); i += chunk_size) {
+        std::vector<int16_t> chunk(audio.begin() + i, audio.begin() + std::min(audio.size(), i + chunk_size));
+        for (auto session_id : sessions) {
+            auto status = engine.Submit(session_id, chunk);
+            while (absl::IsResourceExhausted(status)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                status = engine.Submit(session_id, chunk);
+            }
+            ASSERT_TRUE(status.ok()) << status.message();
+        }
+    }
+    for (auto session_id : sessions) {
+        EXPECT_TRUE(engine.CloseSession(session_id).ok());
+    }
+
+    // All sessions got the same audio, so they should agree.
+    ASSERT_EQ(transcriptions.size(), sessions.size());
+    for (auto session_id : sessions) {
+        EXPECT_EQ(transcriptions[session_id], transcriptions[sessions.front()]);
+        for (const auto& text : transcriptions[session_id]) {
+            ABSL_LOG(INFO) << session_id << ": " << text;
+        }
+    }
+    EXPECT_FALSE(engine.Submit(sessions.front(), {}).ok());
+}
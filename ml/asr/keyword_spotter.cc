@@ -0,0 +1,176 @@
+#include "ml/asr/keyword_spotter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+#include "absl/strings/str_cat.h"
+#include "ml/asr/model_registry.h"
+#include "ml/asr/result_parser.h"
+
+namespace aikit::ml {
+namespace {
+std::vector<std::string> SplitWords(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream stream(text);
+    std::string word;
+    while (stream >> word) {
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+// Vosk grammar is a JSON list of phrases, [unk] takes the rest of the speech.
+std::string Grammar(const std::vector<std::string>& phrases) {
+    std::string grammar = "[";
+    for (const auto& phrase : phrases) {
+        grammar += '"';
+        for (char c : phrase) {
+            if (c == '"' || c == '\\') {
+                grammar += '\\';
+            }
+            grammar += c;
+        }
+        grammar += "\", ";
+    }
+    grammar += "\"[unk]\"]";
+    return grammar;
+}
+
+bool HasRuntimeGraph(const std::string& model_path) {
+    std::error_code error;
+    return std::filesystem::exists(std::filesystem::path(model_path) / "graph" / "HCLr.fst", error) &&
+           std::filesystem::exists(std::filesystem::path(model_path) / "graph" / "Gr.fst", error);
+}
+}  // namespace
+
+absl::StatusOr<KeywordSpotter> KeywordSpotter::Create(const std::string& model_path,
+                                                      const std::vector<std::string>& phrases,
+                                                      size_t sample_rate) {
+    if (phrases.empty()) {
+        return absl::InvalidArgumentError("No phrases to spot");
+    }
+    for (const auto& phrase : phrases) {
+        if (SplitWords(phrase).empty()) {
+            return absl::InvalidArgumentError("Empty phrase to spot");
+        }
+    }
+    if (!HasRuntimeGraph(model_path)) {
+        return absl::InvalidArgumentError(
+            absl::StrCat(model_path, " has no runtime graph, keyword spotting needs a model with graph/HCLr.fst"));
+    }
+    auto model = VoskModelRegistry::Instance().GetModel(model_path);
+    if (!model.ok()) {
+        return model.status();
+    }
+    KeywordSpotter spotter(std::move(model).value(), phrases, sample_rate);
+    if (!spotter.recognizer_) {
+        return absl::InternalError(absl::StrCat("Failed to create keyword recognizer for ", model_path));
+    }
+    return spotter;
+}
+
+KeywordSpotter::KeywordSpotter(std::shared_ptr<VoskModel> model, std::vector<std::string> phrases,
+                               size_t sample_rate)
+    : model_(std::move(model)),
+      phrases_(std::move(phrases)),
+      sample_rate_(sample_rate),
+      recognizer_(vosk_recognizer_new_grm(model_.get(), sample_rate_, Grammar(phrases_).c_str()),
+                  vosk_recognizer_free) {
+    for (const auto& phrase : phrases_) {
+        phrase_words_.push_back(SplitWords(phrase));
+    }
+    if (recognizer_) {
+        vosk_recognizer_set_words(recognizer_.get(), 1);
+        vosk_recognizer_set_partial_words(recognizer_.get(), 1);
+    }
+}
+
+absl::Status KeywordSpotter::operator()(const std::vector<int16_t>& audio_buffer, std::vector<KeywordHit>& hits) {
+    static_assert(sizeof(int16_t) == sizeof(short));
+    const int final_status = vosk_recognizer_accept_waveform_s(
+        recognizer_.get(), reinterpret_cast<const short*>(audio_buffer.data()), audio_buffer.size());
+    if (final_status != 0) {
+        return OnFinalResult(vosk_recognizer_result(recognizer_.get()), hits);
+    }
+
+    auto status = ParseVoskResult(vosk_recognizer_partial_result(recognizer_.get()), result_);
+    if (!status.ok()) {
+        return absl::InternalError(status.message());
+    }
+    // Hypothesis is rewritten by the decoder, so only the matches it
+    // agrees on twice are trusted.
+    auto matches = FindMatches();
+    for (const auto& match : matches) {
+        if (std::find(prev_matches_.begin(), prev_matches_.end(), match) != prev_matches_.end()) {
+            Report(match, hits);
+        }
+    }
+    prev_matches_ = std::move(matches);
+    return absl::OkStatus();
+}
+
+absl::Status KeywordSpotter::Flush(std::vector<KeywordHit>& hits) {
+    return OnFinalResult(vosk_recognizer_final_result(recognizer_.get()), hits);
+}
+
+absl::Status KeywordSpotter::OnFinalResult(const char* json, std::vector<KeywordHit>& hits) {
+    auto status = ParseVoskResult(json, result_);
+    if (!status.ok()) {
+        return absl::InternalError(status.message());
+    }
+    for (const auto& match : FindMatches()) {
+        Report(match, hits);
+    }
+    // The next utterance starts.
+    prev_matches_.clear();
+    reported_.clear();
+    return absl::OkStatus();
+}
+
+std::vector<KeywordSpotter::Match> KeywordSpotter::FindMatches() const {
+    std::vector<Match> matches;
+    const auto& words = result_.words;
+    for (size_t first = 0; first < words.size();) {
+        bool matched = false;
+        for (size_t phrase = 0; phrase < phrase_words_.size() && !matched; ++phrase) {
+            const auto& phrase_words = phrase_words_[phrase];
+            matched = first + phrase_words.size() <= words.size() &&
+                      std::equal(phrase_words.begin(), phrase_words.end(), words.begin() + first,
+                                 [](const std::string& a, const ASRWord& b) { return a == b.word; });
+            if (matched) {
+                matches.emplace_back(phrase, first);
+                first += phrase_words.size();
+            }
+        }
+        if (!matched) {
+            ++first;
+        }
+    }
+    return matches;
+}
+
+void KeywordSpotter::Report(const Match& match, std::vector<KeywordHit>& hits) {
+    const auto [phrase, first] = match;
+    const size_t last = first + phrase_words_[phrase].size() - 1;
+    KeywordHit hit;
+    hit.phrase = phrases_[phrase];
+    hit.start = result_.words[first].start;
+    hit.end = result_.words[last].end;
+    hit.conf = result_.words[first].conf;
+    for (size_t i = first; i <= last; ++i) {
+        hit.conf = std::min(hit.conf, result_.words[i].conf);
+    }
+
+    // Words of the final result may be aligned a bit differently than
+    // the partial ones, so the same occurrence is the one which overlaps.
+    for (const auto& reported : reported_) {
+        if (reported.phrase == hit.phrase && reported.start < hit.end && hit.start < reported.end) {
+            return;
+        }
+    }
+    reported_.push_back(hit);
+    hits.push_back(std::move(hit));
+}
+
+}  // namespace aikit::ml
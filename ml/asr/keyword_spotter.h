@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "absl/status/statusor.h"
+#include "ml/asr/result.h"
+#include "vosk_api.h"
+
+namespace aikit::ml {
+
+struct KeywordHit {
+    // Phrase as it was given to the spotter.
+    std::string phrase;
+    // Seconds of the audio fed to the spotter.
+    float start = 0.0f;
+    float end = 0.0f;
+    // Minimal confidence of the words of the phrase.
+    float conf = 0.0f;
+};
+
+// KeywordSpotter finds given phrases in the audio.
+//
+// The recognizer's search is constrained to the grammar of the phrases
+// (any other speech is decoded as [unk]), so a chunk costs a fraction of
+// the full decoding. This needs a model with the runtime graph (e.g.
+// vosk-model-small-ru-0.22), large models with the static HCLG graph
+// can't be constrained. The model is taken from VoskModelRegistry, so
+// it's shared with the recognizers of the same model path.
+//
+// A phrase is reported as soon as it's in two partial hypotheses in a
+// row at the same position, without waiting for the endpoint, or at the
+// end of the utterance otherwise, once per occurrence.
+class KeywordSpotter {
+public:
+  static absl::StatusOr<KeywordSpotter> Create(const std::string& model_path,
+                                               const std::vector<std::string>& phrases,
+                                               size_t sample_rate = 16000);
+
+  KeywordSpotter(KeywordSpotter&&) noexcept = default;
+  KeywordSpotter& operator=(KeywordSpotter&&) noexcept = default;
+  KeywordSpotter(const KeywordSpotter&) = delete;
+  KeywordSpotter& operator=(const KeywordSpotter&) = delete;
+
+  // Feeds the audio, appends the phrases spotted so far to `hits`.
+  absl::Status operator()(const std::vector<int16_t>& audio_buffer, std::vector<KeywordHit>& hits);
+  // Finishes the utterance, e.g. when the speech is over.
+  absl::Status Flush(std::vector<KeywordHit>& hits);
+
+  size_t sample_rate() const { return sample_rate_; }
+
+private:
+  // Phrase index and its first word in the hypothesis.
+  using Match = std::pair<size_t, size_t>;
+
+  KeywordSpotter(std::shared_ptr<VoskModel> model, std::vector<std::string> phrases, size_t sample_rate);
+
+  // Matches of the phrases in result_.words, left to right, not overlapping.
+  std::vector<Match> FindMatches() const;
+  void Report(const Match& match, std::vector<KeywordHit>& hits);
+  absl::Status OnFinalResult(const char* json, std::vector<KeywordHit>& hits);
+
+  std::shared_ptr<VoskModel> model_;
+  std::vector<std::string> phrases_;
+  // Words of each phrase.
+  std::vector<std::vector<std::string>> phrase_words_;
+  size_t sample_rate_;
+  std::unique_ptr<VoskRecognizer, void (*)(VoskRecognizer*)> recognizer_;
+
+  ASRResult result_;
+  // Matches of the previous partial hypothesis.
+  std::vector<Match> prev_matches_;
+  // Hits of the current utterance.
+  std::vector<KeywordHit> reported_;
+};
+
+}  // namespace aikit::ml
@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "ml/asr/keyword_spotter.h"
+#include "ml/common/wav.h"
+
+namespace {
+constexpr char kModelPath[] = "ml/asr/models/vosk-model-small-ru-0.22";
+}  // namespace
+
+TEST(TestMLASRKeywordSpotter, SpotsPhrase) {
+    auto spotter = aikit::ml::KeywordSpotter::Create(kModelPath, {"огромный опыт", "стоп"});
+    ASSERT_TRUE(spotter.ok()) << spotter.status().message();
+    auto audio = aikit::ml::ReadWav("testdata/whisper_audio.wav");
+    ASSERT_TRUE(audio.ok()) << audio.status().message();
+    const auto samples = aikit::ml::ToPcm16(audio->samples);
+
+    std::vector<aikit::ml::KeywordHit> hits;
+    // 100 ms chunks.
+    for (size_t i = 0; i < samples.size(); i += 1600) {
+        std::vector<int16_t> chunk(samples.begin() + i, samples.begin() + std::min(samples.size(), i + 1600));
+        ASSERT_TRUE((*spotter)(chunk, hits).ok());
+    }
+    ASSERT_TRUE(spotter->Flush(hits).ok());
+
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_EQ(hits[0].phrase, "огромный опыт");
+    EXPECT_LT(hits[0].start, hits[0].end);
+    EXPECT_LT(hits[0].end, audio->duration_sec());
+}
+
+TEST(TestMLASRKeywordSpotter, RejectsBadSetup) {
+    EXPECT_FALSE(aikit::ml::KeywordSpotter::Create(kModelPath, {}).ok());
+    EXPECT_FALSE(aikit::ml::KeywordSpotter::Create(kModelPath, {" "}).ok());
+    // Static graph can't be constrained by a grammar.
+    EXPECT_FALSE(aikit::ml::KeywordSpotter::Create("ml/asr/models/vosk-model-ru-0.42", {"стоп"}).ok());
+}
@@ -0,0 +1,98 @@
+#include "ml/asr/mapped_files.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+
+namespace aikit::ml {
+
+absl::StatusOr<MappedModelFiles> MappedModelFiles::Map(const std::string& model_path, size_t min_file_size) {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    fs::recursive_directory_iterator entries(model_path, fs::directory_options::follow_directory_symlink, error);
+    if (error) {
+        return absl::NotFoundError(absl::StrCat("Can't list ", model_path, ": ", error.message()));
+    }
+
+    MappedModelFiles files;
+    for (const auto& entry : entries) {
+        if (!entry.is_regular_file(error)) {
+            continue;
+        }
+        const size_t size = entry.file_size(error);
+        if (error || size == 0 || size < min_file_size) {
+            continue;
+        }
+        const int fd = open(entry.path().c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return absl::NotFoundError(absl::StrCat("Can't open ", entry.path().string(), ": ", std::strerror(errno)));
+        }
+        void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        // The mapping keeps the file referenced.
+        close(fd);
+        if (data == MAP_FAILED) {
+            return absl::InternalError(absl::StrCat("Can't map ", entry.path().string(), ": ", std::strerror(errno)));
+        }
+        files.mappings_.push_back({data, size});
+        // Only a hint, the model loads without it just slower.
+        madvise(data, size, MADV_WILLNEED);
+    }
+    return files;
+}
+
+MappedModelFiles::MappedModelFiles(MappedModelFiles&& other) noexcept
+    : mappings_(std::exchange(other.mappings_, {})) {}
+
+MappedModelFiles& MappedModelFiles::operator=(MappedModelFiles&& other) noexcept {
+    if (this != &other) {
+        Unmap();
+        mappings_ = std::exchange(other.mappings_, {});
+    }
+    return *this;
+}
+
+MappedModelFiles::~MappedModelFiles() { Unmap(); }
+
+void MappedModelFiles::Unmap() {
+    for (const auto& mapping : mappings_) {
+        munmap(mapping.data, mapping.size);
+    }
+    mappings_.clear();
+}
+
+size_t MappedModelFiles::size() const {
+    size_t size = 0;
+    for (const auto& mapping : mappings_) {
+        size += mapping.size;
+    }
+    return size;
+}
+
+size_t MappedModelFiles::resident_size() const {
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t resident_size = 0;
+    std::vector<unsigned char> residency;
+    for (const auto& mapping : mappings_) {
+        const size_t num_pages = (mapping.size + page_size - 1) / page_size;
+        residency.resize(num_pages);
+        if (mincore(mapping.data, mapping.size, residency.data()) != 0) {
+            continue;
+        }
+        for (size_t i = 0; i < num_pages; ++i) {
+            if (residency[i] & 1) {
+                resident_size += std::min(page_size, mapping.size - i * page_size);
+            }
+        }
+    }
+    return resident_size;
+}
+
+}  // namespace aikit::ml
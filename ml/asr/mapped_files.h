@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "absl/status/statusor.h"
+
+namespace aikit::ml {
+
+// Read-only shared mappings of the large files of a model directory
+// (HCLG.fst, final.mdl, G.carpa, rnnlm, ivector extractor, ...).
+//
+// Mapping asks the kernel to read the files ahead (MADV_WILLNEED), so the
+// disk reads of all the files run in parallel with the model parsing
+// instead of blocking it file by file. While the mappings are alive their
+// pages stay in the active list and survive the memory pressure better than
+// the pages of closed files.
+//
+// The mappings themselves are not used by the model. Vosk maps the ConstFst
+// graphs written with --fst_align from the same page cache (see
+// third_party/vosk_api/src_model.patch), so only those are shared between
+// processes. Kaldi parses final.mdl, G.carpa and rnnlm into the heap of each
+// process.
+class MappedModelFiles {
+public:
+  // Files smaller than this are not worth a mapping.
+  static constexpr size_t kMinFileSize = 1 << 20;
+
+  static absl::StatusOr<MappedModelFiles> Map(const std::string& model_path,
+                                              size_t min_file_size = kMinFileSize);
+
+  MappedModelFiles(MappedModelFiles&& other) noexcept;
+  MappedModelFiles& operator=(MappedModelFiles&& other) noexcept;
+  MappedModelFiles(const MappedModelFiles&) = delete;
+  MappedModelFiles& operator=(const MappedModelFiles&) = delete;
+  ~MappedModelFiles();
+
+  size_t num_files() const { return mappings_.size(); }
+  // Total size of the mapped files, bytes.
+  size_t size() const;
+  // Number of bytes of the mapped files which are in the page cache.
+  size_t resident_size() const;
+
+private:
+  struct Mapping {
+    void* data;
+    size_t size;
+  };
+
+  MappedModelFiles() = default;
+  void Unmap();
+
+  std::vector<Mapping> mappings_;
+};
+
+}  // namespace aikit::ml
@@ -0,0 +1,44 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "ml/asr/mapped_files.h"
+
+namespace {
+namespace fs = std::filesystem;
+
+void WriteFile(const fs::path& path, size_t size) {
+    fs::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary) << std::string(size, 'x');
+}
+}  // namespace
+
+TEST(TestMLASRMappedFiles, MapsLargeFiles) {
+    const auto model_path = fs::path(::testing::TempDir()) / "mapped_model";
+    fs::remove_all(model_path);
+    WriteFile(model_path / "graph" / "HCLG.fst", 3 << 20);
+    WriteFile(model_path / "am" / "final.mdl", 2 << 20);
+    WriteFile(model_path / "conf" / "model.conf", 100);
+
+    auto files = aikit::ml::MappedModelFiles::Map(model_path.string());
+    ASSERT_TRUE(files.ok()) << files.status().message();
+    EXPECT_EQ(files->num_files(), 2);
+    EXPECT_EQ(files->size(), 5 << 20);
+    // Just written, so it's in the page cache.
+    EXPECT_GT(files->resident_size(), 0);
+    EXPECT_LE(files->resident_size(), files->size());
+
+    auto moved = std::move(files).value();
+    EXPECT_EQ(moved.num_files(), 2);
+
+    auto all_files = aikit::ml::MappedModelFiles::Map(model_path.string(), 0);
+    ASSERT_TRUE(all_files.ok());
+    EXPECT_EQ(all_files->num_files(), 3);
+}
+
+TEST(TestMLASRMappedFiles, FailsOnMissingModel) {
+    auto files = aikit::ml::MappedModelFiles::Map((fs::path(::testing::TempDir()) / "missing_model").string());
+    EXPECT_FALSE(files.ok());
+}
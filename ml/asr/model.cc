@@ -2,14 +2,46 @@
 #include <stdexcept>
 
 #include "ml/asr/model.h"
-#include "json.h"
+#include "ml/asr/model_registry.h"
+#include "ml/asr/result_parser.h"
 #include <algorithm>
+#include <string_view>
+#include <utility>
 
 namespace aikit::ml {
+namespace {
+constexpr std::string_view kSpaces = " \t\n\v\f\r";
+
+// Splits the text at whitespace into `words`, their strings are
+// overwritten in place and the vector is resized at the end.
+void SplitWords(std::string_view text, std::vector<std::string>& words) {
+    size_t num_words = 0;
+    for (size_t begin = text.find_first_not_of(kSpaces); begin != std::string_view::npos;) {
+        const size_t end = std::min(text.find_first_of(kSpaces, begin), text.size());
+        if (num_words == words.size()) {
+            words.emplace_back();
+        }
+        words[num_words++].assign(text.substr(begin, end - begin));
+        begin = text.find_first_not_of(kSpaces, end);
+    }
+    words.resize(num_words);
+}
+
+void JoinWords(std::vector<std::string>::const_iterator begin, std::vector<std::string>::const_iterator end,
+               std::string& text) {
+    text.clear();
+    for (auto it = begin; it != end; ++it) {
+        if (!text.empty()) {
+            text += ' ';
+        }
+        text += *it;
+    }
+}
+}  // namespace
 
 ASRModel::ASRModel(const std::string& model_path, const std::string& spk_model_path, size_t sample_rate)
     : model_path_(model_path), spk_model_path_(spk_model_path), sample_rate_(sample_rate),
-      model_(nullptr, vosk_model_free), spk_model_(nullptr, vosk_spk_model_free), recognizer_(nullptr, vosk_recognizer_free) {
+      recognizer_(nullptr, vosk_recognizer_free) {
     initialize();
 }
 
@@ -21,7 +53,10 @@ ASRModel::ASRModel(ASRModel&& other) noexcept
       sample_rate_(other.sample_rate_),
       model_(std::move(other.model_)),
       spk_model_(std::move(other.spk_model_)),
-      recognizer_(std::move(other.recognizer_)) {}
+      recognizer_(std::move(other.recognizer_)),
+      prev_partial_words_(std::move(other.prev_partial_words_)),
+      partial_words_(std::move(other.partial_words_)),
+      partial_(std::move(other.partial_)) {}
 
 ASRModel& ASRModel::operator=(ASRModel&& other) noexcept {
     if (this != &other) {
@@ -31,48 +66,134 @@ ASRModel& ASRModel::operator=(ASRModel&& other) noexcept {
         model_ = std::move(other.model_);
         spk_model_ = std::move(other.spk_model_);
         recognizer_ = std::move(other.recognizer_);
+        prev_partial_words_ = std::move(other.prev_partial_words_);
+        partial_words_ = std::move(other.partial_words_);
+        partial_ = std::move(other.partial_);
     }
     return *this;
 }
 
 void ASRModel::initialize() {
-    model_.reset(vosk_model_new(model_path_.c_str()));
-    if (!model_) {
+    auto model_or = VoskModelRegistry::Instance().GetModel(model_path_);
+    if (!model_or.ok()) {
         throw std::runtime_error("Failed to create model");
     }
+    model_ = std::move(model_or.value());
 
-    spk_model_.reset(vosk_spk_model_new(spk_model_path_.c_str()));
-    if (!spk_model_) {
+    auto spk_model_or = VoskModelRegistry::Instance().GetSpkModel(spk_model_path_);
+    if (!spk_model_or.ok()) {
         throw std::runtime_error("Failed to create speaker model");
     }
+    spk_model_ = std::move(spk_model_or.value());
 
     recognizer_.reset(vosk_recognizer_new_spk(model_.get(), sample_rate_, spk_model_.get()));
     if (!recognizer_) {
         throw std::runtime_error("Failed to create recognizer");
     }
+    // Word timings are needed to align the transcription with the video.
+    vosk_recognizer_set_words(recognizer_.get(), 1);
 }
 
 absl::StatusOr<ASRResult> ASRModel::operator()(std::vector<float>& audio_buffer) {
+    ASRResult result;
+    auto status = operator()(audio_buffer, result);
+    if (!status.ok()) {
+        return status;
+    }
+    return result;
+}
+
+absl::StatusOr<ASRResult> ASRModel::operator()(const std::vector<int16_t>& audio_buffer) {
+    ASRResult result;
+    auto status = operator()(audio_buffer, result);
+    if (!status.ok()) {
+        return status;
+    }
+    return result;
+}
+
+absl::Status ASRModel::operator()(std::vector<float>& audio_buffer, ASRResult& result) {
     std::for_each(audio_buffer.begin(), audio_buffer.end(), [](float& x) { x *= 32767.0f; });
     int final_status = vosk_recognizer_accept_waveform_f(recognizer_.get(), audio_buffer.data(), audio_buffer.size());
+    return GetResult(final_status, result);
+}
 
+absl::Status ASRModel::operator()(const std::vector<int16_t>& audio_buffer, ASRResult& result) {
+    static_assert(sizeof(int16_t) == sizeof(short));
+    int final_status = vosk_recognizer_accept_waveform_s(
+        recognizer_.get(), reinterpret_cast<const short*>(audio_buffer.data()), audio_buffer.size());
+    return GetResult(final_status, result);
+}
+
+absl::Status ASRModel::GetResult(int final_status, ASRResult& result) {
     if (final_status != 0) {
-        std::string result_str = vosk_recognizer_result(recognizer_.get());
-        ASRResult result;
-        try {
-            auto json_result = json::JSON::Load(result_str);
-            if (json_result.hasKey("text") && json_result.hasKey("spk")) {
-                result.text = json_result["text"].ToString();
-                for (auto& item : json_result["spk"].ArrayRange()) {
-                    result.spk_embedding.push_back(item.ToFloat());
-                }
-                return result;
-            }
-        } catch (const std::exception& e) {
-            return absl::InternalError("Error parsing JSON");
-        }
+        prev_partial_words_.clear();
+        return ParseResult(vosk_recognizer_result(recognizer_.get()), result);
     }
     return absl::UnavailableError("Result not ready");
 }
 
+absl::StatusOr<ASRResult> ASRModel::Flush() {
+    ASRResult result;
+    auto status = Flush(result);
+    if (!status.ok()) {
+        return status;
+    }
+    return result;
+}
+
+absl::Status ASRModel::Flush(ASRResult& result) {
+    prev_partial_words_.clear();
+    return ParseResult(vosk_recognizer_final_result(recognizer_.get()), result);
+}
+
+absl::Status ASRModel::ParseResult(const char* result_str, ASRResult& result) {
+    auto status = ParseVoskResult(result_str, result);
+    if (!status.ok()) {
+        return absl::InternalError(status.message());
+    }
+    // Vosk doesn't compute speaker embedding for utterances without speech.
+    if (result.spk_embedding.empty()) {
+        return absl::UnavailableError("Result not ready");
+    }
+    return absl::OkStatus();
+}
+
+void ASRModel::Reset() {
+    vosk_recognizer_reset(recognizer_.get());
+    prev_partial_words_.clear();
+}
+
+void ASRModel::SetPartialWords(bool enabled) {
+    vosk_recognizer_set_partial_words(recognizer_.get(), enabled ? 1 : 0);
+}
+
+absl::StatusOr<ASRPartialResult> ASRModel::PartialResult() {
+    ASRPartialResult result;
+    auto status = PartialResult(result);
+    if (!status.ok()) {
+        return status;
+    }
+    return result;
+}
+
+absl::Status ASRModel::PartialResult(ASRPartialResult& result) {
+    auto status = ParseVoskResult(vosk_recognizer_partial_result(recognizer_.get()), partial_);
+    if (!status.ok()) {
+        return absl::InternalError(status.message());
+    }
+    SplitWords(partial_.text, partial_words_);
+
+    // A word is stable when it did not change since the previous
+    // partial hypothesis.
+    auto stable_end = std::mismatch(partial_words_.cbegin(), partial_words_.cend(),
+                                    prev_partial_words_.cbegin(), prev_partial_words_.cend()).first;
+    JoinWords(partial_words_.cbegin(), stable_end, result.stable_text);
+    JoinWords(stable_end, partial_words_.cend(), result.unstable_text);
+    // The words of `result` are parsed over by the next call.
+    std::swap(result.words, partial_.words);
+    std::swap(partial_words_, prev_partial_words_);
+    return absl::OkStatus();
+}
+
 }  // namespace aikit::ml
@@ -1,18 +1,14 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
 #include "absl/status/statusor.h"
+#include "ml/asr/result.h"
 #include "vosk_api.h"
 
 namespace aikit::ml {
 
-struct ASRResult {
-    std::string text;
-    std::vector<float> spk_embedding;
-};
-
-
 class ASRModel {
 public:
   ASRModel(const std::string& model_path, const std::string& spk_model_path, size_t sample_rate = 16000);
@@ -25,16 +21,51 @@ public:
   ASRModel(const ASRModel&) = delete;
   ASRModel& operator=(const ASRModel&) = delete;
 
+  // Audio is expected to be in [-1, 1] range, the buffer is rescaled in place.
   absl::StatusOr<ASRResult> operator()(std::vector<float>& audio_buffer);
+  // Native format of the recognizer, audio is passed as is.
+  absl::StatusOr<ASRResult> operator()(const std::vector<int16_t>& audio_buffer);
+  // Same as above, but the result is decoded into `result` reusing its
+  // memory, so a caller which keeps `result` doesn't allocate per chunk.
+  // `result` is valid only when OK is returned.
+  absl::Status operator()(std::vector<float>& audio_buffer, ASRResult& result);
+  absl::Status operator()(const std::vector<int16_t>& audio_buffer, ASRResult& result);
+  // Returns the current hypothesis of the not yet finished utterance.
+  // Call it after operator() returned UnavailableError.
+  absl::StatusOr<ASRPartialResult> PartialResult();
+  // Same as above, but the hypothesis is written into `result` reusing
+  // its memory.
+  absl::Status PartialResult(ASRPartialResult& result);
+  // Makes PartialResult fill the word timings, off by default since
+  // the timings are not needed to show the text.
+  void SetPartialWords(bool enabled);
+  // Finishes the current utterance, e.g. when the stream is over.
+  absl::StatusOr<ASRResult> Flush();
+  absl::Status Flush(ASRResult& result);
+  // Drops the decoder state, so the next audio starts a new utterance.
+  void Reset();
+
+  size_t sample_rate() const { return sample_rate_; }
 private:
   const std::string log_id_ = "asr_model";
 
   std::string model_path_;
   std::string spk_model_path_;
   size_t sample_rate_;
-  std::unique_ptr<VoskModel, void(*)(VoskModel*)> model_;
-  std::unique_ptr<VoskSpkModel, void(*)(VoskSpkModel*)> spk_model_;
+  // Models are shared with other recognizers of the process,
+  // see VoskModelRegistry.
+  std::shared_ptr<VoskModel> model_;
+  std::shared_ptr<VoskSpkModel> spk_model_;
   std::unique_ptr<VoskRecognizer, void(*)(VoskRecognizer*)> recognizer_;
+  // Words of the previous partial hypothesis, used to find the stable prefix.
+  std::vector<std::string> prev_partial_words_;
+  // Words of the current partial hypothesis, swapped with the previous
+  // ones, so their strings are overwritten in place.
+  std::vector<std::string> partial_words_;
+  // Buffer for decoding of partial results.
+  ASRResult partial_;
   void initialize();
+  absl::Status GetResult(int final_status, ASRResult& result);
+  absl::Status ParseResult(const char* result_str, ASRResult& result);
 };
 }  // namespace aikit::ml
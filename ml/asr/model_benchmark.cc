@@ -1,43 +1,208 @@
 #include "benchmark/benchmark.h"
 
-#include <vector>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
-#include <fstream>
-#include <memory>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "ml/asr/model.h"
+#include "ml/common/wav.h"
+
+// Streaming benchmarks of the Vosk recognizer.
+//
+// Audio is 16 kHz WAV, testdata/whisper_audio.wav or the file set in
+// ASR_BENCHMARK_AUDIO. It's fed in chunks of the duration given by the
+// benchmark argument (ms), as fast as the recognizer accepts them.
+// Latencies are the ones of the real time stream: a chunk is complete
+// chunk duration after its first sample and is decoded in the measured
+// wall time.
+//
+// Counters:
+//   rtf - decoding wall time divided by the audio duration.
+//   time_to_partial_ms - from the start of the first word which changed
+//     in a partial hypothesis until the hypothesis is available.
+//   time_to_final_ms - from the end of the last word of an utterance
+//     until its final result is available.
+//   peak_rss_mb - peak resident memory of the process so far.
+
+namespace {
+constexpr char kModelPath[] = "ml/asr/models/vosk-model-ru-0.42";
+constexpr char kSpkModelPath[] = "ml/asr/models/vosk-model-spk-0.4";
+constexpr int kSampleRate = 16000;
+
+using Clock = std::chrono::steady_clock;
+
+double Seconds(Clock::duration duration) { return std::chrono::duration<double>(duration).count(); }
+
+double PeakRssMb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // Kilobytes on Linux.
+    return usage.ru_maxrss / 1024.0;
+}
+
+const std::vector<int16_t>& Audio() {
+    static const auto* audio = [] {
+        const char* path = std::getenv("ASR_BENCHMARK_AUDIO");
+        auto wav = aikit::ml::ReadWav(path != nullptr ? path : "testdata/whisper_audio.wav");
+        if (!wav.ok() || wav->sample_rate != kSampleRate) {
+            return new std::vector<int16_t>();
+        }
+        return new std::vector<int16_t>(aikit::ml::ToPcm16(wav->samples));
+    }();
+    return *audio;
+}
+
+std::vector<std::vector<int16_t>> Chunks(const std::vector<int16_t>& audio, int64_t chunk_ms) {
+    const size_t chunk_size = kSampleRate * chunk_ms / 1000;
+    std::vector<std::vector<int16_t>> chunks;
+    for (size_t i = 0; i < audio.size(); i += chunk_size) {
+        chunks.emplace_back(audio.begin() + i, audio.begin() + std::min(audio.size(), i + chunk_size));
+    }
+    return chunks;
+}
 
-std::unique_ptr<aikit::ml::ASRModel> g_model;
-std::vector<float> g_audio_buffer;
+// Keeps one model loaded for the benchmarks of decoding, so they don't
+// pay for the loading.
+aikit::ml::ASRModel& Model() {
+    static auto* model = new aikit::ml::ASRModel(kModelPath, kSpkModelPath);
+    return *model;
+}
+
+struct Latencies {
+    double sum_partial_sec = 0.0;
+    size_t num_partials = 0;
+    double sum_final_sec = 0.0;
+    size_t num_finals = 0;
+};
 
+// Streams the chunks, returns the decoding wall time.
+Clock::duration Stream(aikit::ml::ASRModel& model, const std::vector<std::vector<int16_t>>& chunks,
+                       Latencies& latencies) {
+    aikit::ml::ASRResult result;
+    std::vector<aikit::ml::ASRWord> prev_partial;
+    size_t num_fed_samples = 0;
+    Clock::duration total = Clock::duration::zero();
+    for (const auto& chunk : chunks) {
+        const auto start = Clock::now();
+        auto status = model(chunk, result);
+        std::optional<aikit::ml::ASRPartialResult> partial;
+        if (absl::IsUnavailable(status)) {
+            auto partial_or = model.PartialResult();
+            if (partial_or.ok()) {
+                partial = std::move(partial_or).value();
+            }
+        }
+        const double decode_sec = Seconds(Clock::now() - start);
+        total += Clock::now() - start;
+
+        num_fed_samples += chunk.size();
+        const double fed_sec = static_cast<double>(num_fed_samples) / kSampleRate;
+        if (status.ok() && !result.words.empty()) {
+            latencies.sum_final_sec += fed_sec - result.words.back().end + decode_sec;
+            ++latencies.num_finals;
+            prev_partial.clear();
+        } else if (partial.has_value()) {
+            // The new text starts at the first word which is not in the
+            // previous hypothesis.
+            const auto changed = std::mismatch(partial->words.begin(), partial->words.end(), prev_partial.begin(),
+                                               prev_partial.end(), [](const auto& word, const auto& prev_word) {
+                                                   return word.word == prev_word.word;
+                                               }).first;
+            if (changed != partial->words.end()) {
+                latencies.sum_partial_sec += fed_sec - changed->start + decode_sec;
+                ++latencies.num_partials;
+            }
+            prev_partial = std::move(partial->words);
+        }
+    }
+    return total;
+}
+
+void SetLatencyCounters(benchmark::State& state, const Latencies& latencies) {
+    if (latencies.num_partials > 0) {
+        state.counters["time_to_partial_ms"] = 1000.0 * latencies.sum_partial_sec / latencies.num_partials;
+    }
+    if (latencies.num_finals > 0) {
+        state.counters["time_to_final_ms"] = 1000.0 * latencies.sum_final_sec / latencies.num_finals;
+    }
+    state.counters["peak_rss_mb"] = PeakRssMb();
+}
+}  // namespace
 
-void SetupBenchmark(benchmark::State& state) {
-    g_model = std::make_unique<aikit::ml::ASRModel>("ml/asr/models/vosk-model-ru-0.42", "ml/asr/models/vosk-model-spk-0.4");
-    
-    std::ifstream wavin("testdata/meeting_audio.wav", std::ios::binary | std::ios::ate);
-    std::streamsize size = 16000 * 10;
-    wavin.seekg(44, std::ios::beg);
+// Cold start of a recognizer: the model files are likely in the page
+// cache after the first iteration, so it's mostly parsing.
+static void BM_ASR_ModelLoad(benchmark::State& state) {
+    for (auto _ : state) {
+        aikit::ml::ASRModel model(kModelPath, kSpkModelPath);
+        benchmark::DoNotOptimize(model.sample_rate());
+    }
+    state.counters["peak_rss_mb"] = PeakRssMb();
+}
 
-    g_audio_buffer.resize(size);
-    wavin.read(reinterpret_cast<char*>(g_audio_buffer.data()), size * sizeof(float));
+// Steady state decoding, the stream is not finalized.
+static void BM_ASR_StreamingDecode(benchmark::State& state) {
+    const auto& audio = Audio();
+    if (audio.empty()) {
+        state.SkipWithError("No 16 kHz test audio");
+        return;
+    }
+    const auto chunks = Chunks(audio, state.range(0));
+    auto& model = Model();
+    // Timings of the partial words for time_to_partial_ms.
+    model.SetPartialWords(true);
 
-    for (auto& sample : g_audio_buffer) {
-        sample *= 32767.0f;
+    Latencies latencies;
+    double decode_sec = 0.0;
+    for (auto _ : state) {
+        model.Reset();
+        decode_sec += Seconds(Stream(model, chunks, latencies));
     }
+    const double audio_sec = static_cast<double>(audio.size()) / kSampleRate;
+    state.counters["rtf"] = decode_sec / (audio_sec * state.iterations());
+    SetLatencyCounters(state, latencies);
 }
 
-static void BM_ASR_Inference(benchmark::State& state) {
-    if (!g_model || g_audio_buffer.empty()) {
-        SetupBenchmark(state);
+// Finishing of the stream: the time of Flush after the whole audio was
+// fed, e.g. when the speaker stops.
+static void BM_ASR_Finalize(benchmark::State& state) {
+    const auto& audio = Audio();
+    if (audio.empty()) {
+        state.SkipWithError("No 16 kHz test audio");
+        return;
     }
-    for (auto _ : state) {    
-        benchmark::DoNotOptimize(g_model->operator()(g_audio_buffer));
+    const auto chunks = Chunks(audio, state.range(0));
+    auto& model = Model();
+
+    aikit::ml::ASRResult result;
+    Latencies latencies;
+    for (auto _ : state) {
+        state.PauseTiming();
+        model.Reset();
+        Stream(model, chunks, latencies);
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(model.Flush(result));
     }
+    state.counters["peak_rss_mb"] = PeakRssMb();
 }
 
-BENCHMARK(BM_ASR_Inference)
-    ->MinWarmUpTime(2.0)
+BENCHMARK(BM_ASR_ModelLoad)->Iterations(3)->Unit(benchmark::kSecond);
+BENCHMARK(BM_ASR_StreamingDecode)
+    ->ArgName("chunk_ms")
+    ->Arg(100)
+    ->Arg(200)
+    ->Arg(500)
+    ->Arg(1000)
     ->MinTime(5.0)
-    ->Repetitions(10)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ASR_Finalize)
+    ->ArgName("chunk_ms")
+    ->Arg(200)
+    ->Iterations(5)
     ->Unit(benchmark::kMillisecond);
 BENCHMARK_MAIN();
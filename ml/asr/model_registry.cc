@@ -0,0 +1,68 @@
+#include "ml/asr/model_registry.h"
+
+#include "absl/log/absl_log.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "ml/asr/mapped_files.h"
+
+namespace aikit::ml {
+
+VoskModelRegistry& VoskModelRegistry::Instance() {
+    static auto* registry = new VoskModelRegistry();
+    return *registry;
+}
+
+template <typename Model>
+std::shared_ptr<VoskModelRegistry::Entry<Model>> VoskModelRegistry::GetEntry(Entries<Model>& entries,
+                                                                          const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = entries[path];
+    if (!entry) {
+        entry = std::make_shared<Entry<Model>>();
+    }
+    return entry;
+}
+
+absl::StatusOr<std::shared_ptr<VoskModel>> VoskModelRegistry::GetModel(const std::string& model_path) {
+    auto entry = GetEntry(models_, model_path);
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    if (auto model = entry->model.lock()) {
+        return model;
+    }
+
+    const absl::Time start = absl::Now();
+    // The mappings only read the files ahead, so the model loads without them.
+    std::shared_ptr<MappedModelFiles> shared_files;
+    if (auto files = MappedModelFiles::Map(model_path); files.ok()) {
+        shared_files = std::make_shared<MappedModelFiles>(std::move(files).value());
+    } else {
+        ABSL_LOG(WARNING) << "Loading " << model_path << " without read-ahead: " << files.status();
+    }
+    VoskModel* vosk_model = vosk_model_new(model_path.c_str());
+    if (vosk_model == nullptr) {
+        return absl::InternalError(absl::StrCat("Failed to create model from ", model_path));
+    }
+    ABSL_LOG(INFO) << "Loaded " << model_path << " in " << absl::Now() - start << ", "
+                   << (shared_files ? shared_files->size() / (1 << 20) : 0) << " MB of model files are mapped";
+    // Mappings live as long as the model, see MappedModelFiles.
+    std::shared_ptr<VoskModel> model(vosk_model, [shared_files](VoskModel* model) { vosk_model_free(model); });
+    entry->model = model;
+    return model;
+}
+
+absl::StatusOr<std::shared_ptr<VoskSpkModel>> VoskModelRegistry::GetSpkModel(const std::string& spk_model_path) {
+    auto entry = GetEntry(spk_models_, spk_model_path);
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    if (auto spk_model = entry->model.lock()) {
+        return spk_model;
+    }
+
+    std::shared_ptr<VoskSpkModel> spk_model(vosk_spk_model_new(spk_model_path.c_str()), vosk_spk_model_free);
+    if (!spk_model) {
+        return absl::InternalError(absl::StrCat("Failed to create speaker model from ", spk_model_path));
+    }
+    entry->model = spk_model;
+    return spk_model;
+}
+
+}  // namespace aikit::ml
@@ -0,0 +1,56 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "absl/status/statusor.h"
+#include "vosk_api.h"
+
+namespace aikit::ml {
+
+// Process wide cache of loaded Vosk models keyed by the model path.
+//
+// Loading vosk-model-ru-0.42 takes several GB of memory, so all
+// recognizers of the process share one instance of the model. A model
+// is freed when the last user releases it and loaded again on the
+// next request.
+//
+// Files of a model are mapped before it's loaded and stay mapped while
+// it's alive (see MappedModelFiles): the loading reads them from the
+// page cache shared by all the processes on the host.
+class VoskModelRegistry {
+public:
+  static VoskModelRegistry& Instance();
+
+  VoskModelRegistry(const VoskModelRegistry&) = delete;
+  VoskModelRegistry& operator=(const VoskModelRegistry&) = delete;
+
+  absl::StatusOr<std::shared_ptr<VoskModel>> GetModel(const std::string& model_path);
+  absl::StatusOr<std::shared_ptr<VoskSpkModel>> GetSpkModel(const std::string& spk_model_path);
+
+private:
+  VoskModelRegistry() = default;
+
+  // Cached model of a path. Model loading is slow, so it's done under
+  // the mutex of the entry: the same model is not loaded twice when
+  // several recognizers start at once, and models of different paths
+  // load in parallel.
+  template <typename Model>
+  struct Entry {
+    std::mutex mutex;
+    std::weak_ptr<Model> model;
+  };
+  template <typename Model>
+  using Entries = std::unordered_map<std::string, std::shared_ptr<Entry<Model>>>;
+
+  // Entry of the path, created if there is none.
+  template <typename Model>
+  std::shared_ptr<Entry<Model>> GetEntry(Entries<Model>& entries, const std::string& path);
+
+  // Guards the maps, not the entries.
+  std::mutex mutex_;
+  Entries<VoskModel> models_;
+  Entries<VoskSpkModel> spk_models_;
+};
+
+}  // namespace aikit::ml
@@ -0,0 +1,24 @@
+#include "gtest/gtest.h"
+
+#include "ml/asr/model_registry.h"
+
+TEST(TestMLASRModelRegistry, SharesModelsBetweenUsers) {
+    auto& registry = aikit::ml::VoskModelRegistry::Instance();
+
+    auto model = registry.GetModel("ml/asr/models/vosk-model-ru-0.42");
+    ASSERT_TRUE(model.ok()) << model.status().message();
+    auto same_model = registry.GetModel("ml/asr/models/vosk-model-ru-0.42");
+    ASSERT_TRUE(same_model.ok()) << same_model.status().message();
+    EXPECT_EQ(model->get(), same_model->get());
+
+    auto spk_model = registry.GetSpkModel("ml/asr/models/vosk-model-spk-0.4");
+    ASSERT_TRUE(spk_model.ok()) << spk_model.status().message();
+    auto same_spk_model = registry.GetSpkModel("ml/asr/models/vosk-model-spk-0.4");
+    ASSERT_TRUE(same_spk_model.ok()) << same_spk_model.status().message();
+    EXPECT_EQ(spk_model->get(), same_spk_model->get());
+}
+
+TEST(TestMLASRModelRegistry, ReportsMissingModel) {
+    auto model = aikit::ml::VoskModelRegistry::Instance().GetModel("ml/asr/models/does-not-exist");
+    EXPECT_FALSE(model.ok());
+}
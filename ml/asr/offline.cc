@@ -0,0 +1,184 @@
+#include "ml/asr/offline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iterator>
+#include <mutex>
+
+#include "absl/strings/str_cat.h"
+#include "ml/asr/engine.h"
+
+namespace aikit::ml {
+namespace {
+// Frames quieter than this share of the recording make the noise floor.
+constexpr float kNoiseFloorPercentile = 0.1f;
+
+std::vector<float> FrameEnergiesDb(absl::Span<const int16_t> audio, size_t frame_size) {
+    std::vector<float> energies;
+    energies.reserve((audio.size() + frame_size - 1) / frame_size);
+    for (size_t begin = 0; begin < audio.size(); begin += frame_size) {
+        const size_t end = std::min(audio.size(), begin + frame_size);
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            sum += static_cast<double>(audio[i]) * audio[i];
+        }
+        const double mean_square = sum / (end - begin) / (32768.0 * 32768.0);
+        energies.push_back(static_cast<float>(10.0 * std::log10(mean_square + 1e-10)));
+    }
+    return energies;
+}
+
+float NoiseFloorDb(std::vector<float> energies) {
+    auto nth = energies.begin() + static_cast<size_t>(kNoiseFloorPercentile * (energies.size() - 1));
+    std::nth_element(energies.begin(), nth, energies.end());
+    return *nth;
+}
+}  // namespace
+
+std::vector<SpeechSegment> SplitOnSilence(absl::Span<const int16_t> audio,
+                                          const SilenceSplitOptions& options) {
+    const size_t frame_size = std::max<size_t>(1, options.sample_rate * options.frame_ms / 1000);
+    const auto energies = FrameEnergiesDb(audio, frame_size);
+    if (energies.empty()) {
+        return {};
+    }
+    const float threshold_db = std::max(NoiseFloorDb(energies) + options.threshold_db, options.min_energy_db);
+    auto to_frames = [&](float sec) {
+        return static_cast<size_t>(std::lround(sec * 1000 / options.frame_ms));
+    };
+    const size_t min_silence = to_frames(options.min_silence_sec);
+    const size_t padding = to_frames(options.padding_sec);
+    const size_t max_length = std::max<size_t>(2, to_frames(options.max_segment_sec));
+
+    // Speech regions in frames, short pauses are bridged.
+    std::vector<SpeechSegment> regions;
+    for (size_t i = 0; i < energies.size(); ++i) {
+        if (energies[i] <= threshold_db) {
+            continue;
+        }
+        if (!regions.empty() && i - regions.back().end < min_silence) {
+            regions.back().end = i + 1;
+        } else {
+            regions.push_back({i, i + 1});
+        }
+    }
+
+    std::vector<SpeechSegment> segments;
+    size_t prev_end = 0;
+    for (size_t r = 0; r < regions.size(); ++r) {
+        const size_t next_begin = r + 1 < regions.size() ? regions[r + 1].begin : energies.size();
+        size_t begin = std::max(prev_end, regions[r].begin > padding ? regions[r].begin - padding : 0);
+        // Half of the pause at most, the rest is the padding of the next one.
+        const size_t end = std::min(regions[r].end + padding, (regions[r].end + next_begin + 1) / 2);
+        while (end - begin > max_length) {
+            // Cut at the quietest frame of the second half, so the pieces
+            // are not too short.
+            auto first = energies.begin() + begin + max_length / 2;
+            const size_t cut = std::min_element(first, energies.begin() + begin + max_length) - energies.begin();
+            segments.push_back({begin, cut});
+            begin = cut;
+        }
+        segments.push_back({begin, end});
+        prev_end = end;
+    }
+
+    for (auto& segment : segments) {
+        segment.begin *= frame_size;
+        segment.end = std::min(audio.size(), segment.end * frame_size);
+    }
+    return segments;
+}
+
+absl::StatusOr<std::vector<ASRResult>> TranscribeOffline(absl::Span<const int16_t> audio,
+                                                         const OfflineASROptions& options) {
+    if (options.num_workers == 0 || options.chunk_ms <= 0) {
+        return absl::InvalidArgumentError("num_workers and chunk_ms must be positive");
+    }
+    auto split = options.split;
+    split.sample_rate = options.sample_rate;
+    const auto segments = SplitOnSilence(audio, split);
+    if (segments.empty()) {
+        return std::vector<ASRResult>();
+    }
+
+    const size_t chunk_size = std::max<size_t>(1, options.sample_rate * options.chunk_ms / 1000);
+    size_t max_segment_chunks = 1;
+    for (const auto& segment : segments) {
+        max_segment_chunks = std::max(max_segment_chunks, (segment.end - segment.begin + chunk_size - 1) / chunk_size);
+    }
+
+    std::mutex mutex;
+    std::vector<std::vector<ASRResult>> segment_results(segments.size());
+    // Declared after the results, so the workers are stopped before those
+    // are destroyed.
+    ASREngine engine({
+        .model_path = options.model_path,
+        .spk_model_path = options.spk_model_path,
+        .sample_rate = options.sample_rate,
+        .num_workers = std::min(options.num_workers, segments.size()),
+        // The whole segment is submitted at once.
+        .max_pending_chunks = max_segment_chunks,
+    });
+
+    // Enough sessions are open to keep all the workers busy, but not all
+    // of them, every one holds a recognizer and its audio.
+    const size_t max_open_sessions = 2 * engine.num_workers();
+    std::deque<ASREngine::SessionId> open_sessions;
+    absl::Status status;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        if (open_sessions.size() >= max_open_sessions) {
+            status = engine.CloseSession(open_sessions.front());
+            open_sessions.pop_front();
+            if (!status.ok()) {
+                break;
+            }
+        }
+
+        const auto& segment = segments[i];
+        const double offset_sec = static_cast<double>(segment.begin) / options.sample_rate;
+        auto session_id = engine.OpenSession([&, i, offset_sec](ASREngine::SessionId, ASRResult result) {
+            if (result.text.empty()) {
+                return;
+            }
+            for (auto& word : result.words) {
+                word.start = static_cast<float>(word.start + offset_sec);
+                word.end = static_cast<float>(word.end + offset_sec);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            segment_results[i].push_back(std::move(result));
+        });
+        if (!session_id.ok()) {
+            status = session_id.status();
+            break;
+        }
+        open_sessions.push_back(session_id.value());
+
+        for (size_t begin = segment.begin; begin < segment.end && status.ok(); begin += chunk_size) {
+            const size_t end = std::min(segment.end, begin + chunk_size);
+            status = engine.Submit(session_id.value(),
+                                   std::vector<int16_t>(audio.begin() + begin, audio.begin() + end));
+        }
+        if (!status.ok()) {
+            break;
+        }
+    }
+    // Sessions are closed even on error, results are not touched after that.
+    for (auto session_id : open_sessions) {
+        auto close_status = engine.CloseSession(session_id);
+        if (status.ok()) {
+            status = close_status;
+        }
+    }
+    if (!status.ok()) {
+        return absl::Status(status.code(), absl::StrCat("Offline transcription failed: ", status.message()));
+    }
+
+    std::vector<ASRResult> results;
+    for (auto& segment_result : segment_results) {
+        std::move(segment_result.begin(), segment_result.end(), std::back_inserter(results));
+    }
+    return results;
+}
+
+}  // namespace aikit::ml
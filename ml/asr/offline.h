@@ -0,0 +1,65 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ml/asr/result.h"
+
+namespace aikit::ml {
+
+// Piece of the audio, [begin, end) in samples.
+struct SpeechSegment {
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+struct SilenceSplitOptions {
+    size_t sample_rate = 16000;
+    // Audio is analysed in frames of this duration.
+    int frame_ms = 30;
+    // Frame is speech when its energy is that much above the noise floor...
+    float threshold_db = 9.0f;
+    // ...and above this absolute level (dBFS).
+    float min_energy_db = -55.0f;
+    // Shorter pauses don't split the speech.
+    float min_silence_sec = 0.5f;
+    // Silence kept around the speech, so the recognizer sees the onsets
+    // and the endings of the words.
+    float padding_sec = 0.2f;
+    // Longer speech is cut at its quietest frame.
+    float max_segment_sec = 30.0f;
+};
+
+// Returns the speech segments of the recording in the order of time.
+//
+// The whole recording is known, so unlike the streaming
+// VoiceActivityDetector the noise floor is a low percentile of the frame
+// energies of the recording, it doesn't have to adapt.
+std::vector<SpeechSegment> SplitOnSilence(absl::Span<const int16_t> audio,
+                                          const SilenceSplitOptions& options = {});
+
+struct OfflineASROptions {
+    std::string model_path;
+    std::string spk_model_path;
+    size_t sample_rate = 16000;
+    size_t num_workers = std::max(1u, std::thread::hardware_concurrency());
+    // Audio is fed to the recognizer in chunks of this duration.
+    int chunk_ms = 1000;
+    SilenceSplitOptions split;
+};
+
+// Transcribes the recording on all cores.
+//
+// The recording is split on silence (see SplitOnSilence), the segments
+// are independent utterances, so they are decoded concurrently by an
+// ASREngine, each by its own recognizer. Results are returned in the
+// order of time, word times are in seconds of `audio` and every result
+// keeps the speaker embedding of its utterance. Empty results are dropped.
+absl::StatusOr<std::vector<ASRResult>> TranscribeOffline(absl::Span<const int16_t> audio,
+                                                         const OfflineASROptions& options);
+
+}  // namespace aikit::ml
@@ -0,0 +1,94 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "ml/asr/offline.h"
+#include "ml/asr/test_audio.h"
+
+#include "absl/log/absl_log.h"
+
+namespace {
+// Tone of the given duration appended to the audio, silence when
+// amplitude is 0.
+void AppendTone(std::vector<int16_t>& audio, float duration_sec, float amplitude) {
+    const size_t size = static_cast<size_t>(duration_sec * 16000);
+    for (size_t i = 0; i < size; ++i) {
+        audio.push_back(static_cast<int16_t>(amplitude * 32767.0f * std::sin(0.1f * i)));
+    }
+}
+}  // namespace
+
+TEST(TestMLASROffline, SplitsOnSilence) {
+    std::vector<int16_t> audio;
+    AppendTone(audio, 1.0f, 0.0f);
+    AppendTone(audio, 2.0f, 0.3f);
+    // Too short to split.
+    AppendTone(audio, 0.2f, 0.0f);
+    AppendTone(audio, 1.0f, 0.3f);
+    AppendTone(audio, 2.0f, 0.0f);
+    AppendTone(audio, 1.0f, 0.3f);
+    AppendTone(audio, 1.0f, 0.0f);
+
+    const auto segments = aikit::ml::SplitOnSilence(audio);
+    ASSERT_EQ(segments.size(), 2);
+    // Speech with the padding around it.
+    EXPECT_NEAR(segments[0].begin / 16000.0, 0.8, 0.05);
+    EXPECT_NEAR(segments[0].end / 16000.0, 4.4, 0.05);
+    EXPECT_NEAR(segments[1].begin / 16000.0, 6.0, 0.05);
+    EXPECT_NEAR(segments[1].end / 16000.0, 7.4, 0.05);
+
+    EXPECT_TRUE(aikit::ml::SplitOnSilence({}).empty());
+}
+
+TEST(TestMLASROffline, CutsLongSpeech) {
+    std::vector<int16_t> audio;
+    for (int i = 0; i < 10; ++i) {
+        AppendTone(audio, 1.0f, 0.3f);
+        // Pauses are too short to split, the fifth one is the quietest.
+        AppendTone(audio, 0.3f, i == 4 ? 0.01f : 0.05f);
+    }
+    const auto segments = aikit::ml::SplitOnSilence(audio, {.max_segment_sec = 8.0f});
+    ASSERT_EQ(segments.size(), 2);
+    EXPECT_EQ(segments[0].end, segments[1].begin);
+    EXPECT_GE(segments[0].end / 16000.0, 6.2);
+    EXPECT_LE(segments[0].end / 16000.0, 6.5);
+    EXPECT_NEAR(segments[1].end / 16000.0, 12.9, 0.05);
+}
+
+TEST(TestMLASROffline, ParallelMatchesSequential) {
+    const auto audio = aikit::ml::ReadTestAudio();
+    aikit::ml::OfflineASROptions options{
+        .model_path = "ml/asr/models/vosk-model-ru-0.42",
+        .spk_model_path = "ml/asr/models/vosk-model-spk-0.4",
+        .num_workers = 1,
+    };
+    auto sequential = aikit::ml::TranscribeOffline(audio, options);
+    ASSERT_TRUE(sequential.ok()) << sequential.status().message();
+    options.num_workers = 4;
+    auto parallel = aikit::ml::TranscribeOffline(audio, options);
+    ASSERT_TRUE(parallel.ok()) << parallel.status().message();
+
+    ASSERT_FALSE(parallel->empty());
+    ASSERT_EQ(parallel->size(), sequential->size());
+    float prev_word_end = 0.0f;
+    for (size_t i = 0; i < parallel->size(); ++i) {
+        const auto& result = parallel->at(i);
+        ABSL_LOG(INFO) << result.text;
+        EXPECT_EQ(result.text, sequential->at(i).text);
+        EXPECT_FALSE(result.spk_embedding.empty());
+        for (const auto& word : result.words) {
+            EXPECT_LE(prev_word_end, word.start);
+            EXPECT_LE(word.start, word.end);
+            EXPECT_LE(word.end, audio.size() / 16000.0f);
+            prev_word_end = word.end;
+        }
+    }
+}
+
+TEST(TestMLASROffline, FailsOnMissingModel) {
+    auto results = aikit::ml::TranscribeOffline(aikit::ml::ReadTestAudio(), {.model_path = "ml/asr/models/missing"});
+    EXPECT_FALSE(results.ok());
+}
@@ -0,0 +1,219 @@
+#include "ml/asr/profile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <unistd.h>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+
+namespace aikit::ml {
+namespace {
+namespace fs = std::filesystem;
+
+ASRProfile LiveLowLatencyProfile() {
+    ASRProfile profile;
+    profile.name = "live-low-latency";
+    profile.chunk_ms = 100;
+    profile.beam = 10.0f;
+    profile.max_active = 3000;
+    profile.lattice_beam = 4.0f;
+    profile.endpoint_trailing_silence = 0.3f;
+    profile.endpoint_start_max = 3.0f;
+    profile.endpoint_max_utterance = 10.0f;
+    profile.rescoring = false;
+    // Late transcription is useless for the live meeting.
+    profile.overflow_policy = "drop_oldest";
+    return profile;
+}
+
+ASRProfile BalancedProfile() {
+    ASRProfile profile;
+    profile.name = "balanced";
+    return profile;
+}
+
+ASRProfile OfflineAccurateProfile() {
+    ASRProfile profile;
+    profile.name = "offline-accurate";
+    profile.chunk_ms = 1000;
+    profile.beam = 15.0f;
+    profile.max_active = 12000;
+    profile.lattice_beam = 8.0f;
+    profile.endpoint_trailing_silence = 1.0f;
+    profile.endpoint_start_max = 10.0f;
+    profile.endpoint_max_utterance = 30.0f;
+    return profile;
+}
+
+// Options of conf/model.conf set by the profile, in the Kaldi command
+// line format.
+std::vector<std::pair<std::string, std::string>> ModelConfOptions(const ASRProfile& profile) {
+    std::vector<std::pair<std::string, std::string>> options;
+    auto add = [&options](const std::string& name, const auto& value) {
+        if (value.has_value()) {
+            options.emplace_back(name, absl::StrCat(value.value()));
+        }
+    };
+    add("--beam", profile.beam);
+    add("--max-active", profile.max_active);
+    add("--lattice-beam", profile.lattice_beam);
+    add("--endpoint.rule1.min-trailing-silence", profile.endpoint_start_max);
+    if (profile.endpoint_trailing_silence.has_value()) {
+        // The less sure the decoder is about the end of the sentence,
+        // the longer silence is required (same as Vosk's endpointer delays).
+        const float silence = profile.endpoint_trailing_silence.value();
+        add("--endpoint.rule2.min-trailing-silence", std::optional<float>(silence));
+        add("--endpoint.rule3.min-trailing-silence", std::optional<float>(silence + 0.5f));
+        add("--endpoint.rule4.min-trailing-silence", std::optional<float>(silence + 1.0f));
+    }
+    add("--endpoint.rule5.min-utterance-length", profile.endpoint_max_utterance);
+    return options;
+}
+
+absl::StatusOr<std::string> ReadFile(const fs::path& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return absl::NotFoundError(absl::StrCat("Can't read ", path.string()));
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+std::string RewriteModelConf(const std::string& model_conf, const ASRProfile& profile) {
+    const auto options = ModelConfOptions(profile);
+    std::string result;
+    std::istringstream lines(model_conf);
+    std::string line;
+    while (std::getline(lines, line)) {
+        bool overridden = false;
+        for (const auto& [name, value] : options) {
+            overridden = overridden || absl::StartsWith(line, absl::StrCat(name, "="));
+        }
+        if (!overridden) {
+            absl::StrAppend(&result, line, "\n");
+        }
+    }
+    absl::StrAppend(&result, "# ", profile.name, " profile\n");
+    for (const auto& [name, value] : options) {
+        absl::StrAppend(&result, name, "=", value, "\n");
+    }
+    return result;
+}
+
+absl::Status BuildOverlay(const fs::path& model_path, const fs::path& overlay_path,
+                          const std::string& model_conf, bool rescoring) {
+    std::error_code error;
+    fs::create_directories(overlay_path / "conf", error);
+    if (error) {
+        return absl::InternalError(absl::StrCat("Can't create ", overlay_path.string(), ": ", error.message()));
+    }
+    fs::directory_iterator model_entries(model_path, error);
+    if (error) {
+        return absl::NotFoundError(absl::StrCat("Can't list ", model_path.string(), ": ", error.message()));
+    }
+    for (const auto& entry : model_entries) {
+        const auto name = entry.path().filename();
+        if (name == "conf") {
+            continue;
+        }
+        if (!rescoring && (name == "rnnlm" || name == "rescore")) {
+            continue;
+        }
+        fs::create_symlink(entry.path(), overlay_path / name, error);
+        if (error) {
+            return absl::InternalError(absl::StrCat("Can't link ", entry.path().string(), ": ", error.message()));
+        }
+    }
+    fs::directory_iterator conf_entries(model_path / "conf", error);
+    if (error) {
+        return absl::NotFoundError(absl::StrCat("Can't list ", model_path.string(), "/conf: ", error.message()));
+    }
+    for (const auto& entry : conf_entries) {
+        if (entry.path().filename() == "model.conf") {
+            continue;
+        }
+        fs::create_symlink(entry.path(), overlay_path / "conf" / entry.path().filename(), error);
+        if (error) {
+            return absl::InternalError(absl::StrCat("Can't link ", entry.path().string(), ": ", error.message()));
+        }
+    }
+    std::ofstream conf(overlay_path / "conf" / "model.conf");
+    conf << model_conf;
+    conf.close();
+    if (!conf) {
+        return absl::InternalError(absl::StrCat("Can't write model.conf to ", overlay_path.string()));
+    }
+    return absl::OkStatus();
+}
+}  // namespace
+
+absl::StatusOr<ASRProfile> GetASRProfile(std::string_view name) {
+    for (auto profile : {LiveLowLatencyProfile(), BalancedProfile(), OfflineAccurateProfile()}) {
+        if (profile.name == name) {
+            return profile;
+        }
+    }
+    return absl::InvalidArgumentError(absl::StrCat("Unknown ASR profile: ", name));
+}
+
+absl::StatusOr<std::string> PrepareModelForProfile(const std::string& model_path,
+                                                   const ASRProfile& profile) {
+    if (ModelConfOptions(profile).empty() && profile.rescoring) {
+        return model_path;
+    }
+
+    std::error_code error;
+    auto model_dir = fs::absolute(model_path, error).lexically_normal();
+    if (error) {
+        return absl::InvalidArgumentError(absl::StrCat("Bad model path ", model_path, ": ", error.message()));
+    }
+    if (!model_dir.has_filename()) {
+        // Path with the trailing slash.
+        model_dir = model_dir.parent_path();
+    }
+    auto original_conf = ReadFile(model_dir / "conf" / "model.conf");
+    if (!original_conf.ok()) {
+        return original_conf.status();
+    }
+    const auto model_conf = RewriteModelConf(original_conf.value(), profile);
+
+    // Name is derived from everything the overlay consists of, so an existing
+    // directory with this name has the right content.
+    const size_t key = std::hash<std::string>()(
+        absl::StrCat(model_dir.string(), "\n", model_conf, "\n", profile.rescoring ? "rescoring" : "no rescoring"));
+    const auto overlays_dir = fs::temp_directory_path(error) / "aikit_asr_models";
+    if (error) {
+        return absl::InternalError(absl::StrCat("No temp directory: ", error.message()));
+    }
+    const auto overlay_path = overlays_dir /
+        absl::StrFormat("%s.%s.%016x", model_dir.filename().string(), profile.name, key);
+    if (fs::exists(overlay_path / "conf" / "model.conf")) {
+        return overlay_path.string();
+    }
+
+    // Build it aside and move in place, so concurrent users never see
+    // a half made directory.
+    const auto tmp_path = fs::path(absl::StrCat(overlay_path.string(), ".tmp", getpid()));
+    fs::remove_all(tmp_path, error);
+    auto status = BuildOverlay(model_dir, tmp_path, model_conf, profile.rescoring);
+    if (!status.ok()) {
+        fs::remove_all(tmp_path, error);
+        return status;
+    }
+    fs::rename(tmp_path, overlay_path, error);
+    if (error) {
+        // Someone else made it first.
+        fs::remove_all(tmp_path, error);
+        if (!fs::exists(overlay_path / "conf" / "model.conf")) {
+            return absl::InternalError(absl::StrCat("Can't create ", overlay_path.string()));
+        }
+    }
+    return overlay_path.string();
+}
+
+}  // namespace aikit::ml
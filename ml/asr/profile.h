@@ -0,0 +1,56 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+#include "absl/status/statusor.h"
+
+namespace aikit::ml {
+
+// ASRProfile trades accuracy of the recognizer for CPU and latency.
+//
+// Search and endpointing options are read by Vosk from conf/model.conf
+// and rescoring is enabled when rnnlm/ and rescore/ are in the model
+// directory, so a profile is applied to the model directory, see
+// PrepareModelForProfile. Options which are not set keep the values of
+// the model.
+struct ASRProfile {
+    std::string name;
+    // Audio is fed to the recognizer in chunks of this duration, partial
+    // results are updated once per chunk.
+    int chunk_ms = 200;
+
+    // Decoder search.
+    std::optional<float> beam;
+    std::optional<int> max_active;
+    std::optional<float> lattice_beam;
+
+    // Endpointing, seconds. Utterance ends after this much of silence
+    // (longer silence is required when the decoder is less sure)...
+    std::optional<float> endpoint_trailing_silence;
+    // ...or this much of silence when nothing was decoded yet...
+    std::optional<float> endpoint_start_max;
+    // ...or when it's that long.
+    std::optional<float> endpoint_max_utterance;
+
+    // Load rnnlm and const arpa LM rescoring of the model.
+    bool rescoring = true;
+
+    // See ASROverflowPolicy.
+    std::string overflow_policy = "block";
+};
+
+// Known profiles: "live-low-latency", "balanced" (model as is) and
+// "offline-accurate".
+absl::StatusOr<ASRProfile> GetASRProfile(std::string_view name);
+
+// Returns the directory of the model configured for the profile.
+//
+// The model is not copied: the directory is created in the temp directory
+// and consists of symlinks to the original files, only conf/model.conf is
+// rewritten. It's named after its content, so processes with the same
+// profile share it and the ones with different profiles don't interfere.
+// If the profile doesn't change the model, `model_path` is returned.
+absl::StatusOr<std::string> PrepareModelForProfile(const std::string& model_path,
+                                                   const ASRProfile& profile);
+
+}  // namespace aikit::ml
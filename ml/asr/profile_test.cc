@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "ml/asr/profile.h"
+
+namespace {
+namespace fs = std::filesystem;
+
+void WriteFile(const fs::path& path, const std::string& content) {
+    fs::create_directories(path.parent_path());
+    std::ofstream(path) << content;
+}
+
+std::string ReadFile(const fs::path& path) {
+    std::stringstream content;
+    content << std::ifstream(path).rdbuf();
+    return content.str();
+}
+
+// Layout of a Vosk model with rescoring, files are empty.
+fs::path MakeModel(const std::string& name) {
+    const auto model_path = fs::path(::testing::TempDir()) / name;
+    fs::remove_all(model_path);
+    WriteFile(model_path / "am" / "final.mdl", "");
+    WriteFile(model_path / "graph" / "HCLG.fst", "");
+    WriteFile(model_path / "rnnlm" / "final.raw", "");
+    WriteFile(model_path / "rescore" / "G.carpa", "");
+    WriteFile(model_path / "conf" / "mfcc.conf", "--sample-frequency=16000\n");
+    WriteFile(model_path / "conf" / "model.conf",
+              "--min-active=200\n--max-active=7000\n--beam=13.0\n--lattice-beam=6.0\n"
+              "--endpoint.rule2.min-trailing-silence=0.5\n");
+    return model_path;
+}
+}  // namespace
+
+TEST(TestMLASRProfile, KnowsProfiles) {
+    for (const auto* name : {"live-low-latency", "balanced", "offline-accurate"}) {
+        auto profile = aikit::ml::GetASRProfile(name);
+        ASSERT_TRUE(profile.ok()) << name;
+        EXPECT_EQ(profile->name, name);
+        EXPECT_GT(profile->chunk_ms, 0);
+    }
+    EXPECT_FALSE(aikit::ml::GetASRProfile("fast").ok());
+}
+
+TEST(TestMLASRProfile, BalancedProfileUsesModelAsIs) {
+    const auto model_path = MakeModel("balanced_model");
+    auto prepared = aikit::ml::PrepareModelForProfile(model_path.string(),
+                                                      aikit::ml::GetASRProfile("balanced").value());
+    ASSERT_TRUE(prepared.ok()) << prepared.status().message();
+    EXPECT_EQ(prepared.value(), model_path.string());
+}
+
+TEST(TestMLASRProfile, LiveProfileDisablesRescoringAndOverridesSearch) {
+    const auto model_path = MakeModel("live_model");
+    const auto profile = aikit::ml::GetASRProfile("live-low-latency").value();
+    auto prepared = aikit::ml::PrepareModelForProfile(model_path.string(), profile);
+    ASSERT_TRUE(prepared.ok()) << prepared.status().message();
+    const fs::path overlay_path = prepared.value();
+    EXPECT_NE(overlay_path, model_path);
+
+    EXPECT_TRUE(fs::exists(overlay_path / "am" / "final.mdl"));
+    EXPECT_TRUE(fs::exists(overlay_path / "graph" / "HCLG.fst"));
+    EXPECT_TRUE(fs::exists(overlay_path / "conf" / "mfcc.conf"));
+    EXPECT_FALSE(fs::exists(overlay_path / "rnnlm"));
+    EXPECT_FALSE(fs::exists(overlay_path / "rescore"));
+
+    const auto model_conf = ReadFile(overlay_path / "conf" / "model.conf");
+    EXPECT_NE(model_conf.find("--min-active=200\n"), std::string::npos);
+    EXPECT_NE(model_conf.find("--beam=10\n"), std::string::npos);
+    EXPECT_EQ(model_conf.find("--beam=13.0"), std::string::npos);
+    EXPECT_NE(model_conf.find("--max-active=3000\n"), std::string::npos);
+    EXPECT_EQ(model_conf.find("--max-active=7000"), std::string::npos);
+    EXPECT_NE(model_conf.find("--endpoint.rule2.min-trailing-silence=0.3\n"), std::string::npos);
+    // Original model is untouched.
+    EXPECT_NE(ReadFile(model_path / "conf" / "model.conf").find("--beam=13.0"), std::string::npos);
+
+    // The same profile reuses the directory.
+    auto prepared_again = aikit::ml::PrepareModelForProfile(model_path.string(), profile);
+    ASSERT_TRUE(prepared_again.ok());
+    EXPECT_EQ(prepared_again.value(), prepared.value());
+}
+
+TEST(TestMLASRProfile, FailsOnMissingModel) {
+    auto prepared = aikit::ml::PrepareModelForProfile(
+        (fs::path(::testing::TempDir()) / "missing_model").string(),
+        aikit::ml::GetASRProfile("offline-accurate").value());
+    EXPECT_FALSE(prepared.ok());
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace aikit::ml {
+
+// Recognized word, times are in seconds of the audio fed to the recognizer.
+struct ASRWord {
+    std::string word;
+    float start = 0.0f;
+    float end = 0.0f;
+    float conf = 0.0f;
+};
+
+struct ASRResult {
+    std::string text;
+    std::vector<float> spk_embedding;
+    std::vector<ASRWord> words;
+};
+
+// Hypothesis of the utterance which is still being decoded.
+// Words of the stable part were the same in the previous partial
+// hypothesis, so consumers can already act on them, the unstable
+// tail may still be rewritten by the decoder.
+struct ASRPartialResult {
+    std::string stable_text;
+    std::string unstable_text;
+    // Words of the whole hypothesis with timings, only filled after
+    // ASRModel::SetPartialWords(true).
+    std::vector<ASRWord> words;
+};
+
+}  // namespace aikit::ml
@@ -0,0 +1,386 @@
+#include "ml/asr/result_parser.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace aikit::ml {
+namespace {
+// Vosk results are flat, deeper nesting means garbage on input.
+constexpr int kMaxDepth = 16;
+
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view json) : json_(json) {}
+
+    // Skips whitespace and consumes `c` if it's the next character.
+    bool Consume(char c) {
+        SkipWhitespace();
+        if (pos_ < json_.size() && json_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    absl::Status Expect(char c) {
+        if (!Consume(c)) {
+            return Error("unexpected character");
+        }
+        return absl::OkStatus();
+    }
+
+    bool AtEnd() {
+        SkipWhitespace();
+        return pos_ == json_.size();
+    }
+
+    // Reads a key of an object. Keys of Vosk results have no escapes, so
+    // the key is returned as is, without copying.
+    absl::Status ReadKey(std::string_view& key) {
+        if (!Consume('"')) {
+            return Error("expected key");
+        }
+        auto end = json_.find('"', pos_);
+        if (end == std::string_view::npos) {
+            return Error("unterminated key");
+        }
+        key = json_.substr(pos_, end - pos_);
+        pos_ = end + 1;
+        return Expect(':');
+    }
+
+    absl::Status ReadString(std::string& out) {
+        out.clear();
+        if (!Consume('"')) {
+            return Error("expected string");
+        }
+        while (pos_ < json_.size()) {
+            // Copy the run of plain characters at once.
+            size_t run_end = pos_;
+            while (run_end < json_.size() && json_[run_end] != '"' && json_[run_end] != '\\') {
+                ++run_end;
+            }
+            out.append(json_.data() + pos_, run_end - pos_);
+            pos_ = run_end;
+            if (pos_ == json_.size()) {
+                break;
+            }
+            if (json_[pos_] == '"') {
+                ++pos_;
+                return absl::OkStatus();
+            }
+            auto status = ReadEscape(out);
+            if (!status.ok()) {
+                return status;
+            }
+        }
+        return Error("unterminated string");
+    }
+
+    absl::Status ReadNumber(float& out) {
+        SkipWhitespace();
+        size_t end = pos_;
+        while (end < json_.size() && IsNumberChar(json_[end])) {
+            ++end;
+        }
+        // strtof needs a terminated string, numbers are short so copy
+        // them to the stack.
+        char buffer[64];
+        size_t size = end - pos_;
+        if (size == 0 || size >= sizeof(buffer)) {
+            return Error("expected number");
+        }
+        std::memcpy(buffer, json_.data() + pos_, size);
+        buffer[size] = '\0';
+        char* parsed_end = nullptr;
+        out = std::strtof(buffer, &parsed_end);
+        if (parsed_end != buffer + size) {
+            return Error("malformed number");
+        }
+        pos_ = end;
+        return absl::OkStatus();
+    }
+
+    absl::Status SkipValue(int depth = 0) {
+        if (depth > kMaxDepth) {
+            return Error("too deep nesting");
+        }
+        SkipWhitespace();
+        if (pos_ == json_.size()) {
+            return Error("expected value");
+        }
+        switch (json_[pos_]) {
+        case '"':
+            return ReadString(scratch_);
+        case '{':
+        case '[': {
+            const char close = json_[pos_] == '{' ? '}' : ']';
+            ++pos_;
+            if (Consume(close)) {
+                return absl::OkStatus();
+            }
+            do {
+                if (close == '}') {
+                    std::string_view key;
+                    auto status = ReadKey(key);
+                    if (!status.ok()) {
+                        return status;
+                    }
+                }
+                auto status = SkipValue(depth + 1);
+                if (!status.ok()) {
+                    return status;
+                }
+            } while (Consume(','));
+            return Expect(close);
+        }
+        case 't':
+            return SkipLiteral("true");
+        case 'f':
+            return SkipLiteral("false");
+        case 'n':
+            return SkipLiteral("null");
+        default: {
+            float ignored;
+            return ReadNumber(ignored);
+        }
+        }
+    }
+
+private:
+    static bool IsNumberChar(char c) {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    void SkipWhitespace() {
+        while (pos_ < json_.size() &&
+               (json_[pos_] == ' ' || json_[pos_] == '\n' || json_[pos_] == '\r' || json_[pos_] == '\t')) {
+            ++pos_;
+        }
+    }
+
+    absl::Status SkipLiteral(std::string_view literal) {
+        if (json_.substr(pos_, literal.size()) != literal) {
+            return Error("unknown literal");
+        }
+        pos_ += literal.size();
+        return absl::OkStatus();
+    }
+
+    absl::Status ReadHex4(uint32_t& code) {
+        if (pos_ + 4 > json_.size()) {
+            return Error("truncated unicode escape");
+        }
+        code = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = json_[pos_++];
+            code <<= 4;
+            if (c >= '0' && c <= '9') {
+                code |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                code |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                code |= c - 'A' + 10;
+            } else {
+                return Error("malformed unicode escape");
+            }
+        }
+        return absl::OkStatus();
+    }
+
+    absl::Status ReadEscape(std::string& out) {
+        // Skip the backslash.
+        ++pos_;
+        if (pos_ == json_.size()) {
+            return Error("unterminated escape");
+        }
+        const char c = json_[pos_++];
+        switch (c) {
+        case '"': out.push_back('"'); return absl::OkStatus();
+        case '\\': out.push_back('\\'); return absl::OkStatus();
+        case '/': out.push_back('/'); return absl::OkStatus();
+        case 'b': out.push_back('\b'); return absl::OkStatus();
+        case 'f': out.push_back('\f'); return absl::OkStatus();
+        case 'n': out.push_back('\n'); return absl::OkStatus();
+        case 'r': out.push_back('\r'); return absl::OkStatus();
+        case 't': out.push_back('\t'); return absl::OkStatus();
+        case 'u': break;
+        default: return Error("unknown escape");
+        }
+
+        uint32_t code;
+        auto status = ReadHex4(code);
+        if (!status.ok()) {
+            return status;
+        }
+        if (code >= 0xD800 && code <= 0xDBFF) {
+            // High surrogate, the low one has to follow.
+            uint32_t low;
+            if (json_.substr(pos_, 2) != "\\u") {
+                return Error("unpaired surrogate");
+            }
+            pos_ += 2;
+            status = ReadHex4(low);
+            if (!status.ok()) {
+                return status;
+            }
+            if (low < 0xDC00 || low > 0xDFFF) {
+                return Error("unpaired surrogate");
+            }
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        AppendUtf8(code, out);
+        return absl::OkStatus();
+    }
+
+    static void AppendUtf8(uint32_t code, std::string& out) {
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+
+    absl::Status Error(std::string_view what) const {
+        return absl::InvalidArgumentError(
+            std::string("Malformed ASR result at ") + std::to_string(pos_) + ": " + std::string(what));
+    }
+
+    std::string_view json_;
+    size_t pos_ = 0;
+    // Skipped strings are decoded here.
+    std::string scratch_;
+};
+
+absl::Status ReadFloats(JsonReader& reader, std::vector<float>& out) {
+    out.clear();
+    auto status = reader.Expect('[');
+    if (!status.ok() || reader.Consume(']')) {
+        return status;
+    }
+    do {
+        float value;
+        status = reader.ReadNumber(value);
+        if (!status.ok()) {
+            return status;
+        }
+        out.push_back(value);
+    } while (reader.Consume(','));
+    return reader.Expect(']');
+}
+
+absl::Status ReadWord(JsonReader& reader, ASRWord& word) {
+    // The word may be reused from the previous result and miss some fields.
+    word.word.clear();
+    word.start = 0.0f;
+    word.end = 0.0f;
+    word.conf = 0.0f;
+    auto status = reader.Expect('{');
+    if (!status.ok() || reader.Consume('}')) {
+        return status;
+    }
+    do {
+        std::string_view key;
+        status = reader.ReadKey(key);
+        if (!status.ok()) {
+            return status;
+        }
+        if (key == "word") {
+            status = reader.ReadString(word.word);
+        } else if (key == "start") {
+            status = reader.ReadNumber(word.start);
+        } else if (key == "end") {
+            status = reader.ReadNumber(word.end);
+        } else if (key == "conf") {
+            status = reader.ReadNumber(word.conf);
+        } else {
+            status = reader.SkipValue();
+        }
+        if (!status.ok()) {
+            return status;
+        }
+    } while (reader.Consume(','));
+    return reader.Expect('}');
+}
+
+absl::Status ReadWords(JsonReader& reader, std::vector<ASRWord>& words) {
+    // Existing words are overwritten to reuse memory of their strings.
+    size_t num_words = 0;
+    auto status = reader.Expect('[');
+    if (status.ok() && !reader.Consume(']')) {
+        do {
+            if (num_words == words.size()) {
+                words.emplace_back();
+            }
+            status = ReadWord(reader, words[num_words++]);
+            if (!status.ok()) {
+                break;
+            }
+        } while (reader.Consume(','));
+        if (status.ok()) {
+            status = reader.Expect(']');
+        }
+    }
+    words.resize(num_words);
+    return status;
+}
+}  // namespace
+
+absl::Status ParseVoskResult(std::string_view json, ASRResult& result) {
+    result.text.clear();
+    result.spk_embedding.clear();
+    // Words are overwritten in place, they are cleared only if the
+    // result has none.
+    bool has_words = false;
+
+    JsonReader reader(json);
+    auto status = reader.Expect('{');
+    if (!status.ok()) {
+        return status;
+    }
+    if (reader.Consume('}')) {
+        result.words.clear();
+        return absl::OkStatus();
+    }
+    do {
+        std::string_view key;
+        status = reader.ReadKey(key);
+        if (!status.ok()) {
+            return status;
+        }
+        if (key == "text" || key == "partial") {
+            status = reader.ReadString(result.text);
+        } else if (key == "spk") {
+            status = ReadFloats(reader, result.spk_embedding);
+        } else if (key == "result" || key == "partial_result") {
+            status = ReadWords(reader, result.words);
+            has_words = true;
+        } else {
+            status = reader.SkipValue();
+        }
+        if (!status.ok()) {
+            return status;
+        }
+    } while (reader.Consume(','));
+    if (!has_words) {
+        result.words.clear();
+    }
+    status = reader.Expect('}');
+    if (status.ok() && !reader.AtEnd()) {
+        return absl::InvalidArgumentError("Malformed ASR result: trailing data");
+    }
+    return status;
+}
+
+}  // namespace aikit::ml
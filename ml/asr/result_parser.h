@@ -0,0 +1,17 @@
+#pragma once
+#include <string_view>
+#include "absl/status/status.h"
+#include "ml/asr/result.h"
+
+namespace aikit::ml {
+
+// Decodes JSON result of the Vosk recognizer into `result`.
+//
+// Knows "text", "partial", "spk" and "result" or "partial_result" (words)
+// fields, the others are skipped. The JSON is parsed in one pass without building a document,
+// strings and vectors of `result` are overwritten in place, so when the
+// same `result` is reused the decoding doesn't allocate in steady state.
+// Fields missing in the JSON are left empty.
+absl::Status ParseVoskResult(std::string_view json, ASRResult& result);
+
+}  // namespace aikit::ml
@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "ml/asr/result_parser.h"
+
+TEST(TestMLASRResultParser, ParsesFinalResultWithWords) {
+    const std::string json = R"({
+  "result" : [{
+      "conf" : 1.000000,
+      "end" : 1.020000,
+      "start" : 0.510000,
+      "word" : "привет"
+    }, {
+      "conf" : 0.875,
+      "end" : 1.5e0,
+      "start" : 1.02,
+      "word" : "мир"
+    }],
+  "spk" : [-0.5, 1.25, 3],
+  "spk_frames" : 120,
+  "text" : "привет мир"
+})";
+    aikit::ml::ASRResult result;
+    ASSERT_TRUE(aikit::ml::ParseVoskResult(json, result).ok());
+    EXPECT_EQ(result.text, "привет мир");
+    EXPECT_EQ(result.spk_embedding, (std::vector<float>{-0.5f, 1.25f, 3.0f}));
+    ASSERT_EQ(result.words.size(), 2);
+    EXPECT_EQ(result.words[0].word, "привет");
+    EXPECT_FLOAT_EQ(result.words[0].start, 0.51f);
+    EXPECT_FLOAT_EQ(result.words[0].end, 1.02f);
+    EXPECT_FLOAT_EQ(result.words[0].conf, 1.0f);
+    EXPECT_EQ(result.words[1].word, "мир");
+    EXPECT_FLOAT_EQ(result.words[1].end, 1.5f);
+    EXPECT_FLOAT_EQ(result.words[1].conf, 0.875f);
+}
+
+TEST(TestMLASRResultParser, ReusesResult) {
+    aikit::ml::ASRResult result;
+    ASSERT_TRUE(aikit::ml::ParseVoskResult(
+        R"({"result": [{"word": "a", "start": 0, "end": 1, "conf": 1}, {"word": "b", "start": 1, "end": 2, "conf": 1}], "spk": [1, 2], "text": "a b"})",
+        result).ok());
+    ASSERT_EQ(result.words.size(), 2);
+
+    ASSERT_TRUE(aikit::ml::ParseVoskResult(
+        R"({"result": [{"word": "c", "start": 2, "end": 3, "conf": 0.5}], "text": "c"})", result).ok());
+    EXPECT_EQ(result.text, "c");
+    EXPECT_TRUE(result.spk_embedding.empty());
+    ASSERT_EQ(result.words.size(), 1);
+    EXPECT_EQ(result.words[0].word, "c");
+    EXPECT_FLOAT_EQ(result.words[0].start, 2.0f);
+
+    // The fields which a word misses are not left from the previous result.
+    ASSERT_TRUE(aikit::ml::ParseVoskResult(R"({"result": [{"start": 3}], "text": ""})", result).ok());
+    ASSERT_EQ(result.words.size(), 1);
+    EXPECT_TRUE(result.words[0].word.empty());
+    EXPECT_FLOAT_EQ(result.words[0].start, 3.0f);
+    EXPECT_FLOAT_EQ(result.words[0].end, 0.0f);
+    EXPECT_FLOAT_EQ(result.words[0].conf, 0.0f);
+
+    ASSERT_TRUE(aikit::ml::ParseVoskResult(R"({"text": ""})", result).ok());
+    EXPECT_TRUE(result.text.empty());
+    EXPECT_TRUE(result.words.empty());
+}
+
+TEST(TestMLASRResultParser, ParsesPartialAndSkipsUnknownFields) {
+    aikit::ml::ASRResult result;
+    ASSERT_TRUE(aikit::ml::ParseVoskResult(
+        R"({"alternatives": [{"confidence": 1.5, "text": "x", "nested": {"a": [true, false, null]}}], "partial": "a \"quoted\" \u0444\ud83d\ude00"})",
+        result).ok());
+    EXPECT_EQ(result.text, "a \"quoted\" ф😀");
+
+    // Partial words of vosk_recognizer_set_partial_words.
+    ASSERT_TRUE(aikit::ml::ParseVoskResult(
+        R"({"partial": "ok", "partial_result": [{"conf": 1, "end": 0.9, "start": 0.3, "word": "ok"}]})",
+        result).ok());
+    ASSERT_EQ(result.words.size(), 1);
+    EXPECT_EQ(result.words[0].word, "ok");
+    EXPECT_FLOAT_EQ(result.words[0].start, 0.3f);
+}
+
+TEST(TestMLASRResultParser, RejectsMalformedJson) {
+    aikit::ml::ASRResult result;
+    EXPECT_FALSE(aikit::ml::ParseVoskResult("", result).ok());
+    EXPECT_FALSE(aikit::ml::ParseVoskResult(R"({"text": "unterminated)", result).ok());
+    EXPECT_FALSE(aikit::ml::ParseVoskResult(R"({"spk": [1, x]})", result).ok());
+    EXPECT_FALSE(aikit::ml::ParseVoskResult(R"({"text": "a"} trailing)", result).ok());
+    EXPECT_FALSE(aikit::ml::ParseVoskResult(R"({"result": [{"word": "a",}]})", result).ok());
+}
@@ -0,0 +1,21 @@
+#include "ml/asr/test_audio.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace aikit::ml {
+
+std::vector<int16_t> ReadTestAudio(size_t num_samples) {
+    std::ifstream wavin("testdata/meeting_audio.wav", std::ios::binary);
+    wavin.seekg(44, std::ios::beg);
+    std::vector<float> audio_buffer(num_samples);
+    wavin.read(reinterpret_cast<char*>(audio_buffer.data()), num_samples * sizeof(float));
+
+    std::vector<int16_t> pcm(audio_buffer.size());
+    std::transform(audio_buffer.begin(), audio_buffer.end(), pcm.begin(), [](float x) {
+        return static_cast<int16_t>(std::clamp(x, -1.0f, 1.0f) * 32767.0f);
+    });
+    return pcm;
+}
+
+}  // namespace aikit::ml
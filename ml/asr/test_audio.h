@@ -0,0 +1,12 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aikit::ml {
+
+// First `num_samples` samples of testdata/meeting_audio.wav, 16 kHz float
+// samples converted to 16 bit PCM as the recognizer consumes them.
+std::vector<int16_t> ReadTestAudio(size_t num_samples = 16000 * 10);
+
+}  // namespace aikit::ml
@@ -0,0 +1,173 @@
+#include "ml/asr/transcript_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+
+#include "absl/strings/str_split.h"
+
+namespace aikit::ml {
+
+namespace {
+// Whether the character at `pos` is punctuation or space, `size` is set
+// to its length.
+bool IsPunctuation(std::string_view word, size_t pos, size_t& size) {
+    const auto c = static_cast<unsigned char>(word[pos]);
+    if (c < 0x80) {
+        size = 1;
+        return std::ispunct(c) || std::isspace(c);
+    }
+    // «»
+    if (c == 0xC2 && pos + 1 < word.size()) {
+        const auto next = static_cast<unsigned char>(word[pos + 1]);
+        size = 2;
+        return next == 0xAB || next == 0xBB;
+    }
+    // U+2000-U+203F, spaces, dashes, quotes, ellipsis.
+    if (c == 0xE2 && pos + 2 < word.size() && static_cast<unsigned char>(word[pos + 1]) == 0x80) {
+        size = 3;
+        return true;
+    }
+    size = 0;
+    return false;
+}
+}  // namespace
+
+std::string NormalizeTranscriptWord(std::string_view word) {
+    size_t size = 0;
+    while (!word.empty() && IsPunctuation(word, 0, size)) {
+        word.remove_prefix(size);
+    }
+    bool stripped = true;
+    while (stripped) {
+        stripped = false;
+        // The last character is up to 3 bytes long.
+        for (size_t length = 1; length <= 3 && length <= word.size(); ++length) {
+            if (IsPunctuation(word, word.size() - length, size) && size == length) {
+                word.remove_suffix(length);
+                stripped = true;
+                break;
+            }
+        }
+    }
+
+    std::string normalized(word);
+    for (size_t i = 0; i < normalized.size(); ++i) {
+        auto& c = reinterpret_cast<unsigned char&>(normalized[i]);
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        } else if (c == 0xD0 && i + 1 < normalized.size()) {
+            auto& next = reinterpret_cast<unsigned char&>(normalized[++i]);
+            if (next >= 0x90 && next <= 0x9F) {
+                // А-П
+                next += 0x20;
+            } else if (next >= 0xA0 && next <= 0xAF) {
+                // Р-Я
+                c = 0xD1;
+                next -= 0x20;
+            } else if (next == 0x81) {
+                // Ё
+                c = 0xD1;
+                next = 0x91;
+            }
+        }
+    }
+    return normalized;
+}
+
+void TranscriptIndex::Add(absl::Span<const TranscriptWord> words, int32_t speaker_id,
+                          std::string_view speaker_name) {
+    std::unique_lock lock(mutex_);
+    const auto utterance = static_cast<uint32_t>(utterances_.size());
+    utterances_.push_back({speaker_id, std::string(speaker_name)});
+    for (const auto& word : words) {
+        auto normalized = NormalizeTranscriptWord(word.word);
+        if (normalized.empty()) {
+            continue;
+        }
+        auto [it, inserted] = terms_.try_emplace(std::move(normalized), postings_.size());
+        if (inserted) {
+            postings_.emplace_back();
+        }
+        const auto key_us = words_.empty() ? word.start_us : std::max(words_.back().key_us, word.start_us);
+        postings_[it->second].push_back(words_.size());
+        words_.push_back({it->second, utterance, word.start_us, word.end_us, key_us});
+    }
+}
+
+size_t TranscriptIndex::Search(std::string_view phrase, int64_t from_us, int64_t to_us, size_t max_hits,
+                               std::vector<TranscriptHit>& hits) const {
+    hits.clear();
+    std::shared_lock lock(mutex_);
+    std::vector<uint32_t> terms;
+    for (auto word : absl::StrSplit(phrase, absl::ByAnyChar(" \t\n"), absl::SkipEmpty())) {
+        auto normalized = NormalizeTranscriptWord(word);
+        if (normalized.empty()) {
+            continue;
+        }
+        auto it = terms_.find(normalized);
+        if (it == terms_.end()) {
+            return 0;
+        }
+        terms.push_back(it->second);
+    }
+    if (terms.empty() || from_us >= to_us) {
+        return 0;
+    }
+
+    // The positions of the rarest word are the candidates.
+    size_t rarest = 0;
+    for (size_t i = 1; i < terms.size(); ++i) {
+        if (postings_[terms[i]].size() < postings_[terms[rarest]].size()) {
+            rarest = i;
+        }
+    }
+    const auto& positions = postings_[terms[rarest]];
+    // The phrase starts `rarest` words before the candidate, the starts
+    // are sorted by the key as the candidates are.
+    auto first = std::lower_bound(positions.begin(), positions.end(), rarest);
+    auto start_key = [&](uint32_t position) { return words_[position - rarest].key_us; };
+    first = std::partition_point(first, positions.end(),
+                                 [&](uint32_t position) { return start_key(position) < from_us; });
+    const auto last = std::partition_point(first, positions.end(),
+                                           [&](uint32_t position) { return start_key(position) < to_us; });
+
+    size_t num_hits = 0;
+    for (auto it = first; it != last; ++it) {
+        const size_t start = *it - rarest;
+        if (start + terms.size() > words_.size()) {
+            break;
+        }
+        size_t i = 0;
+        while (i < terms.size() && words_[start + i].term == terms[i]) {
+            ++i;
+        }
+        if (i < terms.size()) {
+            continue;
+        }
+        ++num_hits;
+        if (hits.size() < max_hits) {
+            const auto& utterance = utterances_[words_[start].utterance];
+            hits.push_back({
+                .start_us = words_[start].start_us,
+                .end_us = words_[start + terms.size() - 1].end_us,
+                .utterance = words_[start].utterance,
+                .speaker_id = utterance.speaker_id,
+                .speaker_name = utterance.speaker_name,
+            });
+        }
+    }
+    return num_hits;
+}
+
+size_t TranscriptIndex::num_words() const {
+    std::shared_lock lock(mutex_);
+    return words_.size();
+}
+
+size_t TranscriptIndex::num_utterances() const {
+    std::shared_lock lock(mutex_);
+    return utterances_.size();
+}
+
+}  // namespace aikit::ml
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "absl/types/span.h"
+
+namespace aikit::ml {
+
+struct TranscriptWord {
+    std::string_view word;
+    // Position of the word on the timeline of the input media.
+    int64_t start_us = 0;
+    int64_t end_us = 0;
+};
+
+// Occurrence of a phrase in the transcript.
+struct TranscriptHit {
+    int64_t start_us = 0;
+    int64_t end_us = 0;
+    // Utterance the phrase starts in, in the order of Add.
+    size_t utterance = 0;
+    int32_t speaker_id = 0;
+    std::string speaker_name;
+};
+
+// Lowercase word without the surrounding punctuation, as it's indexed.
+// ASCII and Cyrillic letters are lowercased, "ё" is kept apart from "е".
+std::string NormalizeTranscriptWord(std::string_view word);
+
+// Inverted index of the transcript of a meeting, updated as utterances
+// are recognized.
+//
+// Every word gets the next position in the transcript, the index keeps
+// the positions of each distinct word in increasing order, so appending
+// an utterance costs a hash lookup per word and a phrase is searched by
+// scanning the positions of its rarest word only: the candidates in the
+// time range are found by binary search and checked against the words
+// around them. The text is never rescanned, a search of an hours long
+// meeting takes microseconds.
+//
+// Words are expected in the order of time, as ASR results are. A word
+// which starts before the words added earlier is searched by the start
+// of the latest of them. Phrases may span several utterances.
+//
+// Thread safe, searches run concurrently with each other.
+class TranscriptIndex {
+public:
+  // Appends the words of the utterance, the words which are nothing but
+  // punctuation are skipped.
+  void Add(absl::Span<const TranscriptWord> words, int32_t speaker_id = 0,
+           std::string_view speaker_name = {});
+
+  // Fills `hits` with at most `max_hits` occurrences of the phrase, which
+  // start in [from_us, to_us), earliest first. Returns the number of all
+  // the occurrences in the range.
+  size_t Search(std::string_view phrase, int64_t from_us, int64_t to_us,
+                size_t max_hits, std::vector<TranscriptHit>& hits) const;
+
+  size_t num_words() const;
+  size_t num_utterances() const;
+
+private:
+  struct Word {
+    uint32_t term;
+    uint32_t utterance;
+    int64_t start_us;
+    int64_t end_us;
+    // Latest start of the words up to this one, the positions are
+    // sorted by it.
+    int64_t key_us;
+  };
+  struct Utterance {
+    int32_t speaker_id;
+    std::string speaker_name;
+  };
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, uint32_t> terms_;
+  // Positions of each term.
+  std::vector<std::vector<uint32_t>> postings_;
+  std::vector<Word> words_;
+  std::vector<Utterance> utterances_;
+};
+
+}  // namespace aikit::ml
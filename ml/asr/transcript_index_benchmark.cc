@@ -0,0 +1,61 @@
+#include "benchmark/benchmark.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ml/asr/transcript_index.h"
+
+namespace {
+// Transcript of a meeting of the given length, 150 words a minute from
+// a vocabulary of 20000 words of Zipf-like frequencies, 10 words an
+// utterance.
+void AddMeeting(aikit::ml::TranscriptIndex& index, int64_t minutes) {
+    std::vector<std::string> vocabulary;
+    std::vector<double> weights;
+    for (int i = 0; i < 20000; ++i) {
+        vocabulary.push_back("word" + std::to_string(i));
+        weights.push_back(1.0 / (i + 1));
+    }
+    std::mt19937 gen(42);
+    std::discrete_distribution<int> dist(weights.begin(), weights.end());
+    const int64_t word_us = 60000000 / 150;
+    std::vector<aikit::ml::TranscriptWord> words;
+    for (int64_t i = 0; i < minutes * 150; ++i) {
+        words.push_back({vocabulary[dist(gen)], i * word_us, (i + 1) * word_us});
+        if (words.size() == 10) {
+            index.Add(words, i % 4 + 1);
+            words.clear();
+        }
+    }
+}
+}  // namespace
+
+// Search of a phrase of a common and a rare word, the argument is the
+// length of the meeting in minutes.
+static void BM_TranscriptIndex_SearchPhrase(benchmark::State& state) {
+    aikit::ml::TranscriptIndex index;
+    AddMeeting(index, state.range(0));
+    std::vector<aikit::ml::TranscriptHit> hits;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.Search("word1 word500", 0, state.range(0) * 60000000, 100, hits));
+    }
+}
+
+// Search of a common word in the last 10 minutes of the meeting.
+static void BM_TranscriptIndex_SearchTimeRange(benchmark::State& state) {
+    aikit::ml::TranscriptIndex index;
+    AddMeeting(index, state.range(0));
+    std::vector<aikit::ml::TranscriptHit> hits;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            index.Search("word0", (state.range(0) - 10) * 60000000, state.range(0) * 60000000, 100, hits));
+    }
+}
+
+BENCHMARK(BM_TranscriptIndex_SearchPhrase)->ArgName("minutes")->Arg(10)->Arg(60)->Arg(240)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TranscriptIndex_SearchTimeRange)->ArgName("minutes")->Arg(10)->Arg(60)->Arg(240)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "ml/asr/transcript_index.h"
+
+namespace {
+// Words of the text, each one second long, starting at `start_sec`.
+std::vector<aikit::ml::TranscriptWord> Words(const std::vector<std::string>& text, int64_t start_sec) {
+    std::vector<aikit::ml::TranscriptWord> words;
+    for (const auto& word : text) {
+        words.push_back({word, start_sec * 1000000, (start_sec + 1) * 1000000});
+        ++start_sec;
+    }
+    return words;
+}
+}  // namespace
+
+TEST(TestMLASRTranscriptIndex, NormalizesWords) {
+    EXPECT_EQ(aikit::ml::NormalizeTranscriptWord(" Hello,"), "hello");
+    EXPECT_EQ(aikit::ml::NormalizeTranscriptWord("«Привет»!"), "привет");
+    EXPECT_EQ(aikit::ml::NormalizeTranscriptWord("ЁЖИК"), "ёжик");
+    EXPECT_EQ(aikit::ml::NormalizeTranscriptWord("don't"), "don't");
+    EXPECT_EQ(aikit::ml::NormalizeTranscriptWord("..."), "");
+    EXPECT_EQ(aikit::ml::NormalizeTranscriptWord("“итак…”"), "итак");
+}
+
+TEST(TestMLASRTranscriptIndex, FindsPhrasesInTimeRange) {
+    const std::vector<std::string> first = {"давайте", "обсудим", "бюджет", "проекта"};
+    const std::vector<std::string> second = {"Бюджет", "проекта,", "утвержден"};
+    const std::vector<std::string> third = {"следующий", "вопрос", "бюджет"};
+    aikit::ml::TranscriptIndex index;
+    index.Add(Words(first, 0), 1);
+    index.Add(Words(second, 10), 2, "Alice");
+    index.Add(Words(third, 20), 1);
+    index.Add(Words({"проекта", "—", "завтра"}, 23), 1);
+    EXPECT_EQ(index.num_utterances(), 4);
+    EXPECT_EQ(index.num_words(), 12);
+
+    std::vector<aikit::ml::TranscriptHit> hits;
+    ASSERT_EQ(index.Search("бюджет проекта", 0, 100000000, 10, hits), 3);
+    ASSERT_EQ(hits.size(), 3);
+    EXPECT_EQ(hits[0].start_us, 2000000);
+    EXPECT_EQ(hits[0].end_us, 4000000);
+    EXPECT_EQ(hits[1].start_us, 10000000);
+    EXPECT_EQ(hits[1].utterance, 1);
+    EXPECT_EQ(hits[1].speaker_id, 2);
+    EXPECT_EQ(hits[1].speaker_name, "Alice");
+    // Across the utterances, the dash is skipped.
+    EXPECT_EQ(hits[2].start_us, 22000000);
+    EXPECT_EQ(hits[2].end_us, 24000000);
+    EXPECT_EQ(hits[2].utterance, 2);
+
+    // Phrases which start in the range.
+    ASSERT_EQ(index.Search("БЮДЖЕТ", 5000000, 22000000, 10, hits), 1);
+    EXPECT_EQ(hits[0].start_us, 10000000);
+    EXPECT_EQ(index.Search("бюджет", 2000000, 22000001, 10, hits), 3);
+
+    // Counts all the occurrences.
+    EXPECT_EQ(index.Search("проекта", 0, 100000000, 1, hits), 3);
+    EXPECT_EQ(hits.size(), 1);
+
+    EXPECT_EQ(index.Search("проекта обсудим", 0, 100000000, 10, hits), 0);
+    EXPECT_EQ(index.Search("бюджет отпуска", 0, 100000000, 10, hits), 0);
+    EXPECT_EQ(index.Search("", 0, 100000000, 10, hits), 0);
+    EXPECT_TRUE(hits.empty());
+}
@@ -0,0 +1,211 @@
+#include "ml/common/features.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "absl/strings/str_cat.h"
+#include "ml/common/vector_ops.h"
+
+namespace aikit::ml {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+double MelScale(double freq) { return 1127.0 * std::log(1.0 + freq / 700.0); }
+
+size_t FftSizeFor(int frame_length) {
+    size_t size = 2;
+    while (size < static_cast<size_t>(frame_length)) {
+        size *= 2;
+    }
+    return size;
+}
+}  // namespace
+
+RealFFT::RealFFT(size_t size) : size_(size) {
+    const size_t half = size_ / 2;
+    size_t num_bits = 0;
+    while ((size_t{1} << num_bits) < half) {
+        ++num_bits;
+    }
+    bit_reverse_.resize(half);
+    for (size_t i = 0; i < half; ++i) {
+        uint32_t reversed = 0;
+        for (size_t bit = 0; bit < num_bits; ++bit) {
+            reversed |= ((i >> bit) & 1) << (num_bits - 1 - bit);
+        }
+        bit_reverse_[i] = reversed;
+    }
+
+    for (size_t len = 2; len <= half; len *= 2) {
+        for (size_t j = 0; j < len / 2; ++j) {
+            const double angle = -2.0 * kPi * j / len;
+            twiddle_re_.push_back(static_cast<float>(std::cos(angle)));
+            twiddle_im_.push_back(static_cast<float>(std::sin(angle)));
+        }
+    }
+
+    split_cos_.resize(half + 1);
+    split_sin_.resize(half + 1);
+    for (size_t k = 0; k <= half; ++k) {
+        split_cos_[k] = static_cast<float>(std::cos(2.0 * kPi * k / size_));
+        split_sin_[k] = static_cast<float>(std::sin(2.0 * kPi * k / size_));
+    }
+    re_.resize(half);
+    im_.resize(half);
+}
+
+void RealFFT::PowerSpectrum(const float* input, float* power) {
+    const size_t half = size_ / 2;
+    for (size_t i = 0; i < half; ++i) {
+        re_[i] = input[2 * bit_reverse_[i]];
+        im_[i] = input[2 * bit_reverse_[i] + 1];
+    }
+
+    for (size_t len = 2; len <= half; len *= 2) {
+        const size_t stage_half = len / 2;
+        const float* w_re = twiddle_re_.data() + stage_half - 1;
+        const float* w_im = twiddle_im_.data() + stage_half - 1;
+        for (size_t start = 0; start < half; start += len) {
+            Butterflies(re_.data() + start, im_.data() + start, re_.data() + start + stage_half,
+                        im_.data() + start + stage_half, w_re, w_im, stage_half);
+        }
+    }
+
+    // Z[k] = E[k] + i O[k] where E and O are the spectra of the even and
+    // odd samples, X[k] = E[k] + exp(-2 pi i k / size) O[k].
+    for (size_t k = 0; k <= half; ++k) {
+        const size_t a = k % half;
+        const size_t b = (half - k) % half;
+        const float even_re = 0.5f * (re_[a] + re_[b]);
+        const float even_im = 0.5f * (im_[a] - im_[b]);
+        const float odd_re = 0.5f * (im_[a] + im_[b]);
+        const float odd_im = -0.5f * (re_[a] - re_[b]);
+        const float c = split_cos_[k];
+        const float s = split_sin_[k];
+        const float x_re = even_re + c * odd_re + s * odd_im;
+        const float x_im = even_im + c * odd_im - s * odd_re;
+        power[k] = x_re * x_re + x_im * x_im;
+    }
+}
+
+absl::StatusOr<LogMelExtractor> LogMelExtractor::Create(const LogMelOptions& options) {
+    if (options.sample_rate <= 0) {
+        return absl::InvalidArgumentError(absl::StrCat("Bad sample rate ", options.sample_rate));
+    }
+    const int frame_length = static_cast<int>(options.sample_rate * options.frame_length_ms / 1000.0f);
+    const int frame_shift = static_cast<int>(options.sample_rate * options.frame_shift_ms / 1000.0f);
+    if (frame_length < 2 || frame_shift < 1) {
+        return absl::InvalidArgumentError(absl::StrCat("Frame of ", options.frame_length_ms, " ms shifted by ",
+                                                       options.frame_shift_ms, " ms is too short"));
+    }
+    if (options.num_mel_bins <= 0) {
+        return absl::InvalidArgumentError(absl::StrCat("Bad number of mel bins ", options.num_mel_bins));
+    }
+    const float nyquist = 0.5f * options.sample_rate;
+    const float high_freq = options.high_freq > 0.0f ? options.high_freq : nyquist + options.high_freq;
+    if (options.low_freq < 0.0f || high_freq > nyquist || options.low_freq >= high_freq) {
+        return absl::InvalidArgumentError(absl::StrCat("Bad mel frequency range [", options.low_freq, ", ",
+                                                       high_freq, "] for the sample rate ",
+                                                       options.sample_rate));
+    }
+    auto effective_options = options;
+    effective_options.high_freq = high_freq;
+    return LogMelExtractor(effective_options, frame_length, frame_shift, FftSizeFor(frame_length));
+}
+
+LogMelExtractor::LogMelExtractor(const LogMelOptions& options, int frame_length, int frame_shift,
+                                 size_t fft_size)
+    : options_(options),
+      frame_length_(frame_length),
+      frame_shift_(frame_shift),
+      fft_(fft_size),
+      window_(frame_length),
+      frame_(fft_size, 0.0f),
+      power_(fft_size / 2 + 1) {
+    for (int i = 0; i < frame_length_; ++i) {
+        window_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / (frame_length_ - 1)));
+    }
+
+    const double low_mel = MelScale(options_.low_freq);
+    const double mel_step = (MelScale(options_.high_freq) - low_mel) / (options_.num_mel_bins + 1);
+    const double bin_width = static_cast<double>(options_.sample_rate) / fft_size;
+    const int num_fft_bins = static_cast<int>(fft_size / 2);
+    for (int m = 0; m < options_.num_mel_bins; ++m) {
+        const double left = low_mel + m * mel_step;
+        const double center = left + mel_step;
+        const double right = center + mel_step;
+        MelFilter filter{0, 0, filter_weights_.size()};
+        for (int bin = 0; bin < num_fft_bins; ++bin) {
+            const double mel = MelScale(bin * bin_width);
+            if (mel <= left || mel >= right) {
+                continue;
+            }
+            if (filter.num_bins == 0) {
+                filter.first_bin = bin;
+            }
+            filter_weights_.push_back(
+                static_cast<float>(mel <= center ? (mel - left) / mel_step : (right - mel) / mel_step));
+            ++filter.num_bins;
+        }
+        filters_.push_back(filter);
+    }
+}
+
+int LogMelExtractor::Push(absl::Span<const float> samples, std::vector<float>& features) {
+    pending_.insert(pending_.end(), samples.begin(), samples.end());
+    const size_t num_frames =
+        pending_.size() < static_cast<size_t>(frame_length_)
+            ? 0
+            : (pending_.size() - frame_length_) / frame_shift_ + 1;
+    if (num_frames == 0) {
+        return 0;
+    }
+
+    const size_t first = features.size();
+    features.resize(first + num_frames * options_.num_mel_bins);
+    for (size_t i = 0; i < num_frames; ++i) {
+        ComputeFrame(pending_.data() + i * frame_shift_, features.data() + first + i * options_.num_mel_bins);
+    }
+    pending_.erase(pending_.begin(), pending_.begin() + num_frames * frame_shift_);
+    num_frames_ += num_frames;
+    return static_cast<int>(num_frames);
+}
+
+void LogMelExtractor::Reset() {
+    pending_.clear();
+    num_frames_ = 0;
+}
+
+void LogMelExtractor::ComputeFrame(const float* samples, float* features) {
+    float* frame = frame_.data();
+    std::copy(samples, samples + frame_length_, frame);
+    if (options_.remove_dc_offset) {
+        float mean = 0.0f;
+        for (int i = 0; i < frame_length_; ++i) {
+            mean += frame[i];
+        }
+        mean /= frame_length_;
+        for (int i = 0; i < frame_length_; ++i) {
+            frame[i] -= mean;
+        }
+    }
+    if (options_.preemphasis != 0.0f) {
+        for (int i = frame_length_ - 1; i > 0; --i) {
+            frame[i] -= options_.preemphasis * frame[i - 1];
+        }
+        frame[0] -= options_.preemphasis * frame[0];
+    }
+    Multiply(frame, window_.data(), frame, frame_length_);
+    // Zero padding past frame_length_ is never overwritten.
+
+    fft_.PowerSpectrum(frame, power_.data());
+    for (size_t m = 0; m < filters_.size(); ++m) {
+        const auto& filter = filters_[m];
+        const float energy =
+            Dot(power_.data() + filter.first_bin, filter_weights_.data() + filter.offset, filter.num_bins);
+        features[m] = std::log(std::max(energy, options_.energy_floor));
+    }
+}
+
+}  // namespace aikit::ml
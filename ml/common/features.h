@@ -0,0 +1,113 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+namespace aikit::ml {
+
+// Power spectrum of real frames, the size is a power of two.
+//
+// The frame is transformed as a complex sequence of half the size
+// (even samples are the real parts, odd ones the imaginary), butterflies
+// of each stage run over the split real/imaginary arrays with the SIMD
+// kernels of vector_ops.
+class RealFFT {
+public:
+  explicit RealFFT(size_t size);
+
+  size_t size() const { return size_; }
+
+  // Writes size() / 2 + 1 values |X[k]|^2 of the `size()` samples of
+  // `input` to `power`.
+  void PowerSpectrum(const float* input, float* power);
+
+private:
+  size_t size_;
+  // Bit reversal permutation of the complex sequence.
+  std::vector<uint32_t> bit_reverse_;
+  // exp(-2 pi i j / len) for j < len / 2 of each stage, the stage with
+  // len / 2 == half starts at half - 1.
+  std::vector<float> twiddle_re_;
+  std::vector<float> twiddle_im_;
+  // cos and sin of 2 pi k / size, to split the spectrum of the real frame
+  // out of the half size transform.
+  std::vector<float> split_cos_;
+  std::vector<float> split_sin_;
+  std::vector<float> re_;
+  std::vector<float> im_;
+};
+
+struct LogMelOptions {
+    int sample_rate = 16000;
+    float frame_length_ms = 25.0f;
+    float frame_shift_ms = 10.0f;
+    int num_mel_bins = 80;
+    float low_freq = 20.0f;
+    // Non positive value is an offset from the Nyquist frequency.
+    float high_freq = 0.0f;
+    // Zero disables.
+    float preemphasis = 0.97f;
+    bool remove_dc_offset = true;
+    // Mel energies are floored by this before the log.
+    float energy_floor = 1e-10f;
+};
+
+// Streaming log-mel filterbank features.
+//
+// Audio is pushed as it comes, e.g. samples of each AudioFrame, and the
+// features of every frame completed by it are returned right away, the
+// tail which doesn't make a frame yet is kept for the next push. So
+// features of a stream are the same no matter how it's chunked.
+//
+// A frame is processed the Kaldi way: DC offset removal, pre-emphasis,
+// Hann window, zero padding to the power of two, power spectrum and
+// triangular mel filters. Window and filters are dense dot products.
+class LogMelExtractor {
+public:
+  static absl::StatusOr<LogMelExtractor> Create(const LogMelOptions& options = {});
+
+  int num_mel_bins() const { return options_.num_mel_bins; }
+  // In samples.
+  int frame_length() const { return frame_length_; }
+  int frame_shift() const { return frame_shift_; }
+  // Number of frames computed since the start.
+  int64_t num_frames() const { return num_frames_; }
+
+  // Appends num_mel_bins() features of each completed frame to
+  // `features`, returns the number of frames.
+  int Push(absl::Span<const float> samples, std::vector<float>& features);
+
+  // Forgets the buffered samples, the next push starts a new stream.
+  void Reset();
+
+private:
+  struct MelFilter {
+    // First FFT bin of the filter and the offset of its weights.
+    int first_bin;
+    int num_bins;
+    size_t offset;
+  };
+
+  LogMelExtractor(const LogMelOptions& options, int frame_length, int frame_shift, size_t fft_size);
+
+  void ComputeFrame(const float* samples, float* features);
+
+  LogMelOptions options_;
+  int frame_length_;
+  int frame_shift_;
+  RealFFT fft_;
+  std::vector<float> window_;
+  std::vector<MelFilter> filters_;
+  std::vector<float> filter_weights_;
+
+  int64_t num_frames_ = 0;
+  // Samples not consumed by the frames yet.
+  std::vector<float> pending_;
+  // Scratch of fft_.size() and fft_.size() / 2 + 1.
+  std::vector<float> frame_;
+  std::vector<float> power_;
+};
+
+}  // namespace aikit::ml
@@ -0,0 +1,61 @@
+#include "benchmark/benchmark.h"
+
+#include <random>
+#include <vector>
+
+#include "ml/common/features.h"
+
+namespace {
+std::vector<float> Noise(size_t size) {
+    std::mt19937 gen(42);
+    std::normal_distribution<float> dist(0.0f, 0.1f);
+    std::vector<float> samples(size);
+    for (auto& x : samples) {
+        x = dist(gen);
+    }
+    return samples;
+}
+}  // namespace
+
+// Power spectrum of a frame, the argument is the FFT size.
+static void BM_Features_FFT(benchmark::State& state) {
+    const auto input = Noise(state.range(0));
+    std::vector<float> power(input.size() / 2 + 1);
+    aikit::ml::RealFFT fft(input.size());
+    for (auto _ : state) {
+        fft.PowerSpectrum(input.data(), power.data());
+        benchmark::DoNotOptimize(power.data());
+    }
+    state.counters["frames_per_sec_per_core"] =
+        benchmark::Counter(state.iterations(), benchmark::Counter::kAvgThreadsRate);
+}
+
+BENCHMARK(BM_Features_FFT)->ArgName("size")->RangeMultiplier(2)->Range(256, 2048);
+
+// 80 log-mel bins of 16 kHz audio pushed in 1024 sample chunks (the audio
+// frame size of the graph), every thread runs its own extractor.
+static void BM_Features_LogMelStream(benchmark::State& state) {
+    constexpr size_t kChunkSize = 1024;
+    const auto audio = Noise(16000 * 10);
+    auto extractor = aikit::ml::LogMelExtractor::Create();
+    if (!extractor.ok()) {
+        state.SkipWithError("Bad log-mel options");
+        return;
+    }
+    std::vector<float> features;
+    int64_t num_frames = 0;
+    for (auto _ : state) {
+        extractor->Reset();
+        for (size_t i = 0; i < audio.size(); i += kChunkSize) {
+            features.clear();
+            num_frames += extractor->Push(
+                absl::MakeConstSpan(audio).subspan(i, std::min(kChunkSize, audio.size() - i)), features);
+        }
+        benchmark::DoNotOptimize(features.data());
+    }
+    state.counters["frames_per_sec_per_core"] =
+        benchmark::Counter(num_frames, benchmark::Counter::kAvgThreadsRate);
+}
+
+BENCHMARK(BM_Features_LogMelStream)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_MAIN();
@@ -0,0 +1,94 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+#include "ml/common/features.h"
+
+namespace {
+std::vector<float> Sine(float freq, int sample_rate, size_t size) {
+    std::vector<float> samples(size);
+    for (size_t i = 0; i < size; ++i) {
+        samples[i] = 0.5f * std::sin(2.0 * M_PI * freq * i / sample_rate);
+    }
+    return samples;
+}
+}  // namespace
+
+TEST(TestMLCommonFeatures, FFTMatchesNaiveDFT) {
+    std::mt19937 gen(42);
+    std::normal_distribution<float> dist;
+    for (size_t size : {2, 4, 8, 16, 64, 512}) {
+        std::vector<float> input(size);
+        for (auto& x : input) {
+            x = dist(gen);
+        }
+        std::vector<float> power(size / 2 + 1);
+        aikit::ml::RealFFT fft(size);
+        fft.PowerSpectrum(input.data(), power.data());
+
+        for (size_t k = 0; k <= size / 2; ++k) {
+            std::complex<double> x = 0.0;
+            for (size_t n = 0; n < size; ++n) {
+                x += static_cast<double>(input[n]) * std::polar(1.0, -2.0 * M_PI * k * n / size);
+            }
+            EXPECT_NEAR(power[k], std::norm(x), 1e-3 * (1.0 + std::norm(x))) << size << " " << k;
+        }
+    }
+}
+
+TEST(TestMLCommonFeatures, StreamingDoesNotDependOnChunking) {
+    auto extractor = aikit::ml::LogMelExtractor::Create();
+    ASSERT_TRUE(extractor.ok()) << extractor.status().message();
+    EXPECT_EQ(extractor->frame_length(), 400);
+    EXPECT_EQ(extractor->frame_shift(), 160);
+
+    std::mt19937 gen(42);
+    std::normal_distribution<float> dist(0.0f, 0.1f);
+    std::vector<float> audio(16000);
+    for (auto& x : audio) {
+        x = dist(gen);
+    }
+
+    std::vector<float> whole;
+    EXPECT_EQ(extractor->Push(audio, whole), 98);
+
+    extractor->Reset();
+    std::vector<float> chunked;
+    std::uniform_int_distribution<size_t> chunk_size(1, 1024);
+    for (size_t i = 0; i < audio.size();) {
+        const size_t size = std::min(audio.size() - i, chunk_size(gen));
+        extractor->Push(absl::MakeConstSpan(audio).subspan(i, size), chunked);
+        i += size;
+    }
+    EXPECT_EQ(extractor->num_frames(), 98);
+    EXPECT_EQ(chunked, whole);
+}
+
+TEST(TestMLCommonFeatures, SinePeaksAtItsMelBin) {
+    auto extractor = aikit::ml::LogMelExtractor::Create({.num_mel_bins = 40});
+    ASSERT_TRUE(extractor.ok());
+    std::vector<float> low, high;
+    extractor->Push(Sine(300.0f, 16000, 1600), low);
+    extractor->Reset();
+    extractor->Push(Sine(3000.0f, 16000, 1600), high);
+    ASSERT_EQ(low.size(), high.size());
+
+    // Loudest bin of the middle frame.
+    const size_t frame = low.size() / 40 / 2 * 40;
+    auto peak = [frame](const std::vector<float>& features) {
+        return std::max_element(features.begin() + frame, features.begin() + frame + 40) -
+               (features.begin() + frame);
+    };
+    EXPECT_LT(peak(low), 10);
+    EXPECT_GT(peak(high), 20);
+}
+
+TEST(TestMLCommonFeatures, RejectsBadOptions) {
+    EXPECT_FALSE(aikit::ml::LogMelExtractor::Create({.sample_rate = 0}).ok());
+    EXPECT_FALSE(aikit::ml::LogMelExtractor::Create({.frame_shift_ms = 0.0f}).ok());
+    EXPECT_FALSE(aikit::ml::LogMelExtractor::Create({.num_mel_bins = 0}).ok());
+    EXPECT_FALSE(aikit::ml::LogMelExtractor::Create({.high_freq = 9000.0f}).ok());
+}
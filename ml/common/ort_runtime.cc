@@ -0,0 +1,218 @@
+#include "ml/common/ort_runtime.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "absl/log/absl_log.h"
+#include "absl/strings/str_format.h"
+
+namespace aikit::ml {
+
+namespace {
+struct Runtime {
+    std::mutex mutex;
+    OrtRuntimeOptions options;
+    std::unique_ptr<Ort::Env> env;
+};
+
+Runtime& GetRuntime() {
+    static auto* runtime = new Runtime();
+    return *runtime;
+}
+
+int IntraOpNumThreads(const OrtRuntimeOptions& options) {
+    if (options.intra_op_num_threads > 0) {
+        return options.intra_op_num_threads;
+    }
+    return std::clamp(static_cast<int>(std::thread::hardware_concurrency() / 2), 1, 16);
+}
+
+std::string OptimizedModelDir() {
+    auto& runtime = GetRuntime();
+    std::lock_guard lock(runtime.mutex);
+    return runtime.options.optimized_model_dir;
+}
+
+// 64-bit FNV-1a of the file, stable across the runs unlike absl::Hash.
+absl::StatusOr<uint64_t> HashFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return absl::NotFoundError(absl::StrFormat("Can't read %s", path));
+    }
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    std::vector<char> buffer(1 << 20);
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        const auto size = file.gcount();
+        for (std::streamsize i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(buffer[i])) * 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+}  // namespace
+
+absl::Status OrtRuntime::Configure(const OrtRuntimeOptions& options) {
+    if (options.intra_op_num_threads < 0 || options.inter_op_num_threads < 0) {
+        return absl::InvalidArgumentError("Number of ONNX Runtime threads can't be negative");
+    }
+    auto& runtime = GetRuntime();
+    std::lock_guard lock(runtime.mutex);
+    if (runtime.env) {
+        const auto& current = runtime.options;
+        if (IntraOpNumThreads(options) != IntraOpNumThreads(current) ||
+            options.inter_op_num_threads != current.inter_op_num_threads ||
+            options.allow_spinning != current.allow_spinning ||
+            options.intra_op_thread_affinity != current.intra_op_thread_affinity) {
+            return absl::FailedPreconditionError(
+                "ONNX Runtime thread pools are already created, configure them before the models");
+        }
+    }
+    runtime.options = options;
+    return absl::OkStatus();
+}
+
+Ort::Env& OrtRuntime::Env() {
+    auto& runtime = GetRuntime();
+    std::lock_guard lock(runtime.mutex);
+    if (!runtime.env) {
+        const auto& options = runtime.options;
+        Ort::ThreadingOptions threading_options;
+        threading_options.SetGlobalIntraOpNumThreads(IntraOpNumThreads(options));
+        threading_options.SetGlobalInterOpNumThreads(std::max(options.inter_op_num_threads, 1));
+        threading_options.SetGlobalSpinControl(options.allow_spinning);
+        if (!options.intra_op_thread_affinity.empty()) {
+            threading_options.SetGlobalIntraOpThreadAffinity(options.intra_op_thread_affinity.c_str());
+        }
+        runtime.env = std::make_unique<Ort::Env>(threading_options, ORT_LOGGING_LEVEL_WARNING, "aikit");
+    }
+    return *runtime.env;
+}
+
+Ort::SessionOptions OrtRuntime::SessionOptions(const std::string& log_id, OrtLoggingLevel logging_level,
+                                               int num_threads) {
+    OrtRuntimeOptions options;
+    {
+        auto& runtime = GetRuntime();
+        std::lock_guard lock(runtime.mutex);
+        options = runtime.options;
+    }
+
+    Ort::SessionOptions session_options;
+    if (num_threads > 0 || options.per_session_threads) {
+        session_options.SetIntraOpNumThreads(num_threads > 0 ? num_threads : IntraOpNumThreads(options));
+        session_options.SetInterOpNumThreads(std::max(options.inter_op_num_threads, 1));
+    } else {
+        session_options.DisablePerSessionThreads();
+    }
+    session_options.EnableCpuMemArena();
+    session_options.EnableMemPattern();
+    session_options.SetLogId(log_id.c_str());
+    session_options.SetLogSeverityLevel(logging_level);
+    return session_options;
+}
+
+absl::StatusOr<std::string> OrtRuntime::OptimizedModelPath(const std::string& optimized_model_dir,
+                                                           const std::string& model_path) {
+    auto hash = HashFile(model_path);
+    if (!hash.ok()) {
+        return hash.status();
+    }
+    return absl::StrFormat("%s/%s-%016x-ort%s.ort", optimized_model_dir,
+                           std::filesystem::path(model_path).stem().string(), *hash, Ort::GetVersionString());
+}
+
+Ort::Session OrtRuntime::CreateSession(const std::string& model_path, const Ort::SessionOptions& session_options) {
+    const auto optimized_model_dir = OptimizedModelDir();
+    if (optimized_model_dir.empty()) {
+        return Ort::Session(Env(), model_path.c_str(), session_options);
+    }
+    auto optimized_model_path = OptimizedModelPath(optimized_model_dir, model_path);
+    if (!optimized_model_path.ok()) {
+        ABSL_LOG(WARNING) << "Not caching the optimized model: " << optimized_model_path.status().message();
+        return Ort::Session(Env(), model_path.c_str(), session_options);
+    }
+
+    std::error_code error;
+    if (std::filesystem::exists(*optimized_model_path, error)) {
+        auto options = session_options.Clone();
+        options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+        try {
+            return Ort::Session(Env(), optimized_model_path->c_str(), options);
+        } catch (const Ort::Exception& e) {
+            ABSL_LOG(WARNING) << "Can't load " << *optimized_model_path << ", optimizing " << model_path
+                              << " again: " << e.what();
+            std::filesystem::remove(*optimized_model_path, error);
+        }
+    }
+
+    std::filesystem::create_directories(optimized_model_dir, error);
+    if (error) {
+        ABSL_LOG(WARNING) << "Not caching the optimized model in " << optimized_model_dir << ": " << error.message();
+        return Ort::Session(Env(), model_path.c_str(), session_options);
+    }
+    // Saved aside and renamed, so a concurrent load never sees a partial
+    // file.
+    const auto temporary_path = absl::StrFormat("%s.%d.tmp", *optimized_model_path, getpid());
+    auto options = session_options.Clone();
+    options.SetOptimizedModelFilePath(temporary_path.c_str());
+    options.AddConfigEntry("session.save_model_format", "ORT");
+    try {
+        auto session = Ort::Session(Env(), model_path.c_str(), options);
+        std::filesystem::rename(temporary_path, *optimized_model_path, error);
+        if (error) {
+            ABSL_LOG(WARNING) << "Can't save " << *optimized_model_path << ": " << error.message();
+            std::filesystem::remove(temporary_path, error);
+        } else {
+            ABSL_LOG(INFO) << "Saved the optimized " << model_path << " to " << *optimized_model_path;
+        }
+        return session;
+    } catch (const Ort::Exception& e) {
+        ABSL_LOG(WARNING) << "Can't save the optimized " << model_path << ": " << e.what();
+    }
+    std::filesystem::remove(temporary_path, error);
+    return Ort::Session(Env(), model_path.c_str(), session_options);
+}
+
+void OrtRuntime::EnableProfiling(Ort::SessionOptions& session_options, const std::string& profile_prefix) {
+    if (!profile_prefix.empty()) {
+        session_options.EnableProfiling(profile_prefix.c_str());
+    }
+}
+
+std::string OrtRuntime::EndProfiling(Ort::Session& session) {
+    // The start is on the clock of ONNX Runtime, high_resolution_clock,
+    // which is steady_clock on macOS. It's moved to the system clock by
+    // the readings of both clocks at the same moment.
+    const auto profiling_now = std::chrono::high_resolution_clock::now();
+    const auto system_now = std::chrono::system_clock::now();
+    const int64_t start_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(system_now.time_since_epoch()).count() -
+        (std::chrono::duration_cast<std::chrono::nanoseconds>(profiling_now.time_since_epoch()).count() -
+         static_cast<int64_t>(session.GetProfilingStartTimeNs()));
+    Ort::AllocatorWithDefaultOptions allocator;
+    std::string path = session.EndProfilingAllocated(allocator).get();
+    if (path.empty()) {
+        return path;
+    }
+    std::ofstream(path + ".start_ns") << start_ns << "\n";
+    return path;
+}
+
+int OrtRuntime::intra_op_num_threads() {
+    auto& runtime = GetRuntime();
+    std::lock_guard lock(runtime.mutex);
+    return IntraOpNumThreads(runtime.options);
+}
+
+}  // namespace aikit::ml
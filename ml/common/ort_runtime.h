@@ -0,0 +1,91 @@
+#pragma once
+#include <onnxruntime_cxx_api.h>
+#include <string>
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+namespace aikit::ml {
+
+struct OrtRuntimeOptions {
+    // Threads of the intra-op pool shared by the sessions, including the
+    // thread which runs the session. 0 for half of the cores, up to 16.
+    int intra_op_num_threads = 0;
+    // Threads of the inter-op pool, the models run their ops sequentially,
+    // so it's unused.
+    int inter_op_num_threads = 1;
+    // Whether the idle threads of the global pools spin waiting for the
+    // next op. It cuts the latency of back to back runs, but burns the
+    // cores between the inferences, which are a second apart.
+    bool allow_spinning = false;
+    // Cores of the intra-op threads in the format of ONNX Runtime, a group
+    // for each thread but the caller, e.g. "1;2;3" or "1,2;3,4" for 4
+    // threads. Empty to not pin them.
+    std::string intra_op_thread_affinity;
+    // Sessions create their own thread pools of the same size, spinning
+    // as ONNX Runtime does by default, as every model did before the pools
+    // were shared. For comparison.
+    bool per_session_threads = false;
+    // Directory of the optimized graphs of the models, empty to optimize
+    // the models on every start. See OrtRuntime::CreateSession.
+    std::string optimized_model_dir;
+};
+
+// ONNX Runtime environment shared by the models of the process.
+//
+// The environment owns the global intra-op and inter-op thread pools,
+// the sessions are created without thread pools of their own
+// (DisablePerSessionThreads). So the models, which are run by different
+// calculators, don't oversubscribe the cores with a pool each, and the
+// threads sleep between the inferences unless spinning is allowed.
+class OrtRuntime {
+public:
+  // Sets the options, e.g. from the flags before the graph starts. The
+  // thread pools are created with the environment by the first model,
+  // after that only per_session_threads may change.
+  static absl::Status Configure(const OrtRuntimeOptions& options);
+
+  // The environment, created on the first call.
+  static Ort::Env& Env();
+
+  // Options of a new session: the thread pools, the memory arena and
+  // logging. A session with `num_threads` > 0 has its own intra-op pool
+  // of that size. per_session_threads is read here, so it applies to the
+  // sessions created after Configure.
+  static Ort::SessionOptions SessionOptions(const std::string& log_id, OrtLoggingLevel logging_level,
+                                            int num_threads = 0);
+
+  // Session of the model at `model_path`.
+  //
+  // ONNX Runtime optimizes the graph of a model on every load, which
+  // takes seconds for the visual models. With optimized_model_dir set,
+  // the first load saves the optimized graph there in ORT format, the
+  // next ones load it with the optimizations disabled, a plain
+  // deserialization. The saved graph is keyed by the hash of the model
+  // and the version of ONNX Runtime, so an updated model or runtime is
+  // optimized anew. The layout optimizations depend on the CPU, the
+  // directory is not meant to be shared between machines.
+  //
+  // Falls back to optimizing the model if the directory isn't writable
+  // or the saved graph can't be loaded.
+  static Ort::Session CreateSession(const std::string& model_path, const Ort::SessionOptions& session_options);
+
+  // Path of the optimized graph of the model in `optimized_model_dir`.
+  static absl::StatusOr<std::string> OptimizedModelPath(const std::string& optimized_model_dir,
+                                                        const std::string& model_path);
+
+  // Turns on the profiling of the ops of the session, see EndProfiling.
+  static void EnableProfiling(Ort::SessionOptions& session_options, const std::string& profile_prefix);
+
+  // Writes the profile of the session, <prefix>_<date>.json in the
+  // Chrome trace format, its times relative to the start of profiling.
+  // The start, nanoseconds of the system clock, is written next to it to
+  // <profile>.start_ns, so tools/merge_traces.py puts the ops on the
+  // timeline of MediaPipe traces. Returns the path of the profile, empty
+  // if the session isn't profiled or the profile is already written.
+  static std::string EndProfiling(Ort::Session& session);
+
+  // Number of the threads of the global intra-op pool.
+  static int intra_op_num_threads();
+};
+
+}  // namespace aikit::ml
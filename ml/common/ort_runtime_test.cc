@@ -0,0 +1,37 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "ml/common/ort_runtime.h"
+
+namespace {
+std::string WriteFile(const std::string& name, const std::string& content) {
+    const auto path = (std::filesystem::path(::testing::TempDir()) / name).string();
+    std::ofstream(path, std::ios::binary) << content;
+    return path;
+}
+}  // namespace
+
+TEST(TestMLCommonOrtRuntime, OptimizedModelPathKeysByContent) {
+    const auto model_path = WriteFile("model.onnx", "graph");
+    auto first = aikit::ml::OrtRuntime::OptimizedModelPath("/cache", model_path);
+    ASSERT_TRUE(first.ok());
+    EXPECT_EQ(first->rfind("/cache/model-", 0), 0);
+    EXPECT_NE(first->find("-ort" + Ort::GetVersionString() + ".ort"), std::string::npos);
+
+    // Same content, same key, whatever the path.
+    auto copy = aikit::ml::OrtRuntime::OptimizedModelPath("/cache", WriteFile("copy.onnx", "graph"));
+    ASSERT_TRUE(copy.ok());
+    EXPECT_EQ(first->substr(first->find('-')), copy->substr(copy->find('-')));
+
+    WriteFile("model.onnx", "updated graph");
+    auto updated = aikit::ml::OrtRuntime::OptimizedModelPath("/cache", model_path);
+    ASSERT_TRUE(updated.ok());
+    EXPECT_NE(*first, *updated);
+}
+
+TEST(TestMLCommonOrtRuntime, OptimizedModelPathOfMissingModel) {
+    EXPECT_FALSE(aikit::ml::OrtRuntime::OptimizedModelPath("/cache", ::testing::TempDir() + "/missing.onnx").ok());
+}
@@ -0,0 +1,237 @@
+#include "ml/common/vector_ops.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define AIKIT_VECTOR_OPS_AVX2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define AIKIT_VECTOR_OPS_NEON 1
+#endif
+
+namespace aikit::ml {
+namespace {
+
+float DotScalar(const float* a, const float* b, size_t size) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < size; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void AxpyScalar(float alpha, const float* x, float* y, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+void MultiplyScalar(const float* a, const float* b, float* out, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        out[i] = a[i] * b[i];
+    }
+}
+
+void ButterfliesScalar(float* a_re, float* a_im, float* b_re, float* b_im, const float* w_re,
+                       const float* w_im, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        const float t_re = b_re[i] * w_re[i] - b_im[i] * w_im[i];
+        const float t_im = b_re[i] * w_im[i] + b_im[i] * w_re[i];
+        b_re[i] = a_re[i] - t_re;
+        b_im[i] = a_im[i] - t_im;
+        a_re[i] += t_re;
+        a_im[i] += t_im;
+    }
+}
+
+#if defined(AIKIT_VECTOR_OPS_AVX2)
+// Compiled for AVX2 regardless of the target flags of the build, it's
+// called only when the CPU supports it.
+__attribute__((target("avx2,fma"))) float DotAvx2(const float* a, const float* b, size_t size) {
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+    }
+    for (; i + 8 <= size; i += 8) {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+    }
+    sum0 = _mm256_add_ps(sum0, sum1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    return _mm_cvtss_f32(sum) + DotScalar(a + i, b + i, size - i);
+}
+
+__attribute__((target("avx2,fma"))) void AxpyAvx2(float alpha, const float* x, float* y, size_t size) {
+    const __m256 alpha8 = _mm256_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(alpha8, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    }
+    AxpyScalar(alpha, x + i, y + i, size - i);
+}
+
+__attribute__((target("avx2,fma"))) void MultiplyAvx2(const float* a, const float* b, float* out,
+                                                      size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    MultiplyScalar(a + i, b + i, out + i, size - i);
+}
+
+__attribute__((target("avx2,fma"))) void ButterfliesAvx2(float* a_re, float* a_im, float* b_re,
+                                                         float* b_im, const float* w_re,
+                                                         const float* w_im, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        const __m256 br = _mm256_loadu_ps(b_re + i);
+        const __m256 bi = _mm256_loadu_ps(b_im + i);
+        const __m256 wr = _mm256_loadu_ps(w_re + i);
+        const __m256 wi = _mm256_loadu_ps(w_im + i);
+        const __m256 t_re = _mm256_fmsub_ps(br, wr, _mm256_mul_ps(bi, wi));
+        const __m256 t_im = _mm256_fmadd_ps(br, wi, _mm256_mul_ps(bi, wr));
+        const __m256 ar = _mm256_loadu_ps(a_re + i);
+        const __m256 ai = _mm256_loadu_ps(a_im + i);
+        _mm256_storeu_ps(b_re + i, _mm256_sub_ps(ar, t_re));
+        _mm256_storeu_ps(b_im + i, _mm256_sub_ps(ai, t_im));
+        _mm256_storeu_ps(a_re + i, _mm256_add_ps(ar, t_re));
+        _mm256_storeu_ps(a_im + i, _mm256_add_ps(ai, t_im));
+    }
+    ButterfliesScalar(a_re + i, a_im + i, b_re + i, b_im + i, w_re + i, w_im + i, size - i);
+}
+
+bool HasAvx2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return has_avx2;
+}
+#endif
+
+#if defined(AIKIT_VECTOR_OPS_NEON)
+float DotNeon(const float* a, const float* b, size_t size) {
+    float32x4_t sum0 = vdupq_n_f32(0.0f);
+    float32x4_t sum1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        sum0 = vfmaq_f32(sum0, vld1q_f32(a + i), vld1q_f32(b + i));
+        sum1 = vfmaq_f32(sum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    for (; i + 4 <= size; i += 4) {
+        sum0 = vfmaq_f32(sum0, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    return vaddvq_f32(vaddq_f32(sum0, sum1)) + DotScalar(a + i, b + i, size - i);
+}
+
+void AxpyNeon(float alpha, const float* x, float* y, size_t size) {
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        vst1q_f32(y + i, vfmaq_n_f32(vld1q_f32(y + i), vld1q_f32(x + i), alpha));
+    }
+    AxpyScalar(alpha, x + i, y + i, size - i);
+}
+
+void MultiplyNeon(const float* a, const float* b, float* out, size_t size) {
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        vst1q_f32(out + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+    MultiplyScalar(a + i, b + i, out + i, size - i);
+}
+
+void ButterfliesNeon(float* a_re, float* a_im, float* b_re, float* b_im, const float* w_re,
+                     const float* w_im, size_t size) {
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const float32x4_t br = vld1q_f32(b_re + i);
+        const float32x4_t bi = vld1q_f32(b_im + i);
+        const float32x4_t wr = vld1q_f32(w_re + i);
+        const float32x4_t wi = vld1q_f32(w_im + i);
+        const float32x4_t t_re = vfmsq_f32(vmulq_f32(br, wr), bi, wi);
+        const float32x4_t t_im = vfmaq_f32(vmulq_f32(br, wi), bi, wr);
+        const float32x4_t ar = vld1q_f32(a_re + i);
+        const float32x4_t ai = vld1q_f32(a_im + i);
+        vst1q_f32(b_re + i, vsubq_f32(ar, t_re));
+        vst1q_f32(b_im + i, vsubq_f32(ai, t_im));
+        vst1q_f32(a_re + i, vaddq_f32(ar, t_re));
+        vst1q_f32(a_im + i, vaddq_f32(ai, t_im));
+    }
+    ButterfliesScalar(a_re + i, a_im + i, b_re + i, b_im + i, w_re + i, w_im + i, size - i);
+}
+#endif
+}  // namespace
+
+float Dot(const float* a, const float* b, size_t size) {
+#if defined(AIKIT_VECTOR_OPS_AVX2)
+    if (HasAvx2()) {
+        return DotAvx2(a, b, size);
+    }
+#elif defined(AIKIT_VECTOR_OPS_NEON)
+    return DotNeon(a, b, size);
+#endif
+    return DotScalar(a, b, size);
+}
+
+float SquaredNorm(const float* a, size_t size) { return Dot(a, a, size); }
+
+void Axpy(float alpha, const float* x, float* y, size_t size) {
+#if defined(AIKIT_VECTOR_OPS_AVX2)
+    if (HasAvx2()) {
+        AxpyAvx2(alpha, x, y, size);
+        return;
+    }
+#elif defined(AIKIT_VECTOR_OPS_NEON)
+    AxpyNeon(alpha, x, y, size);
+    return;
+#endif
+    AxpyScalar(alpha, x, y, size);
+}
+
+void Normalize(float* a, size_t size) {
+    const float norm = std::sqrt(SquaredNorm(a, size));
+    if (norm == 0.0f) {
+        return;
+    }
+    const float scale = 1.0f / norm;
+    for (size_t i = 0; i < size; ++i) {
+        a[i] *= scale;
+    }
+}
+
+void DotRows(const float* rows, size_t num_rows, const float* query, size_t size, float* scores) {
+    for (size_t row = 0; row < num_rows; ++row) {
+        scores[row] = Dot(rows + row * size, query, size);
+    }
+}
+
+void Multiply(const float* a, const float* b, float* out, size_t size) {
+#if defined(AIKIT_VECTOR_OPS_AVX2)
+    if (HasAvx2()) {
+        MultiplyAvx2(a, b, out, size);
+        return;
+    }
+#elif defined(AIKIT_VECTOR_OPS_NEON)
+    MultiplyNeon(a, b, out, size);
+    return;
+#endif
+    MultiplyScalar(a, b, out, size);
+}
+
+void Butterflies(float* a_re, float* a_im, float* b_re, float* b_im, const float* w_re,
+                 const float* w_im, size_t size) {
+#if defined(AIKIT_VECTOR_OPS_AVX2)
+    if (HasAvx2()) {
+        ButterfliesAvx2(a_re, a_im, b_re, b_im, w_re, w_im, size);
+        return;
+    }
+#elif defined(AIKIT_VECTOR_OPS_NEON)
+    ButterfliesNeon(a_re, a_im, b_re, b_im, w_re, w_im, size);
+    return;
+#endif
+    ButterfliesScalar(a_re, a_im, b_re, b_im, w_re, w_im, size);
+}
+
+}  // namespace aikit::ml
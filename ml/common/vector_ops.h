@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+
+namespace aikit::ml {
+
+// Dense float vector kernels.
+//
+// Implementation is picked once per process: AVX2+FMA on x86-64 CPUs
+// which support it, NEON on ARM64, portable loop otherwise. Results of
+// the implementations differ only by the rounding of the summation.
+
+// Sum of a[i] * b[i].
+float Dot(const float* a, const float* b, size_t size);
+
+// Dot(a, a).
+float SquaredNorm(const float* a, size_t size);
+
+// y[i] += alpha * x[i].
+void Axpy(float alpha, const float* x, float* y, size_t size);
+
+// Scales `a` to the unit length. Zero vector is left as is.
+void Normalize(float* a, size_t size);
+
+// Dot products of `query` with each of `num_rows` rows of the row-major
+// `rows` matrix, written to `scores`. With unit length rows and query
+// these are cosine similarities.
+void DotRows(const float* rows, size_t num_rows, const float* query, size_t size, float* scores);
+
+// out[i] = a[i] * b[i], `out` may be `a` or `b`.
+void Multiply(const float* a, const float* b, float* out, size_t size);
+
+// Radix-2 FFT butterflies on split complex arrays: with t = w * b,
+// a[i], b[i] = a[i] + t, a[i] - t.
+void Butterflies(float* a_re, float* a_im, float* b_re, float* b_im, const float* w_re,
+                 const float* w_im, size_t size);
+
+}  // namespace aikit::ml
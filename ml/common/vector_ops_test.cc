@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include "ml/common/vector_ops.h"
+
+namespace {
+std::vector<float> RandomVector(size_t size, std::mt19937& gen) {
+    std::normal_distribution<float> dist;
+    std::vector<float> v(size);
+    for (auto& x : v) {
+        x = dist(gen);
+    }
+    return v;
+}
+}  // namespace
+
+TEST(TestMLCommonVectorOps, MatchesNaiveLoops) {
+    std::mt19937 gen(42);
+    // Sizes around the SIMD widths to cover the tails.
+    for (size_t size : {0, 1, 3, 4, 7, 8, 15, 16, 17, 128, 130}) {
+        const auto a = RandomVector(size, gen);
+        const auto b = RandomVector(size, gen);
+        double dot = 0.0;
+        for (size_t i = 0; i < size; ++i) {
+            dot += a[i] * b[i];
+        }
+        EXPECT_NEAR(aikit::ml::Dot(a.data(), b.data(), size), dot, 1e-4 * (1 + size)) << size;
+
+        auto y = b;
+        aikit::ml::Axpy(0.5f, a.data(), y.data(), size);
+        for (size_t i = 0; i < size; ++i) {
+            EXPECT_NEAR(y[i], b[i] + 0.5f * a[i], 1e-5) << size;
+        }
+    }
+}
+
+TEST(TestMLCommonVectorOps, NormalizesAndScoresRows) {
+    std::vector<float> rows = {3.0f, 4.0f, 0.0f, 0.0f, 0.0f, 2.0f};
+    aikit::ml::Normalize(rows.data(), 3);
+    aikit::ml::Normalize(rows.data() + 3, 3);
+    EXPECT_NEAR(aikit::ml::SquaredNorm(rows.data(), 3), 1.0f, 1e-6);
+    EXPECT_FLOAT_EQ(rows[5], 1.0f);
+
+    std::vector<float> zero(3, 0.0f);
+    aikit::ml::Normalize(zero.data(), 3);
+    EXPECT_EQ(zero, std::vector<float>(3, 0.0f));
+
+    const std::vector<float> query = {0.6f, 0.8f, 0.0f};
+    std::vector<float> scores(2);
+    aikit::ml::DotRows(rows.data(), 2, query.data(), 3, scores.data());
+    EXPECT_NEAR(scores[0], 1.0f, 1e-6);
+    EXPECT_NEAR(scores[1], 0.0f, 1e-6);
+}
+
+TEST(TestMLCommonVectorOps, MultipliesAndButterflies) {
+    std::mt19937 gen(7);
+    for (size_t size : {1, 4, 8, 9, 33}) {
+        const auto a_re = RandomVector(size, gen);
+        const auto a_im = RandomVector(size, gen);
+        const auto b_re = RandomVector(size, gen);
+        const auto b_im = RandomVector(size, gen);
+        const auto w_re = RandomVector(size, gen);
+        const auto w_im = RandomVector(size, gen);
+
+        std::vector<float> product(size);
+        aikit::ml::Multiply(a_re.data(), b_re.data(), product.data(), size);
+        for (size_t i = 0; i < size; ++i) {
+            EXPECT_FLOAT_EQ(product[i], a_re[i] * b_re[i]) << size;
+        }
+
+        auto x_re = a_re, x_im = a_im, y_re = b_re, y_im = b_im;
+        aikit::ml::Butterflies(x_re.data(), x_im.data(), y_re.data(), y_im.data(), w_re.data(),
+                               w_im.data(), size);
+        for (size_t i = 0; i < size; ++i) {
+            const float t_re = b_re[i] * w_re[i] - b_im[i] * w_im[i];
+            const float t_im = b_re[i] * w_im[i] + b_im[i] * w_re[i];
+            EXPECT_NEAR(x_re[i], a_re[i] + t_re, 1e-5) << size;
+            EXPECT_NEAR(x_im[i], a_im[i] + t_im, 1e-5) << size;
+            EXPECT_NEAR(y_re[i], a_re[i] - t_re, 1e-5) << size;
+            EXPECT_NEAR(y_im[i], a_im[i] - t_im, 1e-5) << size;
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#include "ml/common/wav.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "absl/strings/str_cat.h"
+
+namespace aikit::ml {
+namespace {
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+// WAV is little endian.
+uint32_t ReadLE(const uint8_t* data, size_t size) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        value |= static_cast<uint32_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+float DecodeSample(const uint8_t* data, uint16_t format, uint16_t bits_per_sample) {
+    if (format == kFormatFloat) {
+        float value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    if (bits_per_sample == 8) {
+        // The only unsigned one.
+        return (static_cast<int>(data[0]) - 128) / 128.0f;
+    }
+    const uint32_t raw = ReadLE(data, bits_per_sample / 8);
+    // Sign extension of the 24 and 16 bit values.
+    const int shift = 32 - bits_per_sample;
+    const int32_t value = static_cast<int32_t>(raw << shift) >> shift;
+    return static_cast<float>(value) / static_cast<float>(1u << (bits_per_sample - 1));
+}
+}  // namespace
+
+absl::StatusOr<WavAudio> ReadWav(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return absl::NotFoundError(absl::StrCat("Can't open ", path));
+    }
+    const std::vector<uint8_t> content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (content.size() < 12 || std::memcmp(content.data(), "RIFF", 4) != 0 ||
+        std::memcmp(content.data() + 8, "WAVE", 4) != 0) {
+        return absl::InvalidArgumentError(absl::StrCat(path, " is not a RIFF/WAVE file"));
+    }
+
+    uint16_t format = 0;
+    uint16_t num_channels = 0;
+    uint16_t bits_per_sample = 0;
+    WavAudio audio;
+    const uint8_t* data = nullptr;
+    size_t data_size = 0;
+    for (size_t offset = 12; offset + 8 <= content.size();) {
+        const uint8_t* chunk = content.data() + offset;
+        const size_t chunk_size = std::min<size_t>(ReadLE(chunk + 4, 4), content.size() - offset - 8);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16) {
+            format = ReadLE(chunk + 8, 2);
+            num_channels = ReadLE(chunk + 10, 2);
+            audio.sample_rate = ReadLE(chunk + 12, 4);
+            bits_per_sample = ReadLE(chunk + 22, 2);
+            if (format == kFormatExtensible && chunk_size >= 40) {
+                // The first two bytes of the SubFormat GUID are the format.
+                format = ReadLE(chunk + 32, 2);
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data = chunk + 8;
+            data_size = chunk_size;
+        }
+        // Chunks are word aligned.
+        offset += 8 + chunk_size + (chunk_size & 1);
+    }
+
+    if (num_channels == 0 || audio.sample_rate <= 0) {
+        return absl::InvalidArgumentError(absl::StrCat(path, " has no valid \"fmt \" chunk"));
+    }
+    const bool supported = (format == kFormatPcm && (bits_per_sample == 8 || bits_per_sample == 16 ||
+                                                     bits_per_sample == 24 || bits_per_sample == 32)) ||
+                           (format == kFormatFloat && bits_per_sample == 32);
+    if (!supported) {
+        return absl::UnimplementedError(
+            absl::StrCat(path, " has unsupported format ", format, " with ", bits_per_sample, " bits per sample"));
+    }
+    if (data == nullptr) {
+        return absl::InvalidArgumentError(absl::StrCat(path, " has no \"data\" chunk"));
+    }
+
+    const size_t sample_size = bits_per_sample / 8;
+    const size_t frame_size = sample_size * num_channels;
+    const size_t num_frames = data_size / frame_size;
+    audio.samples.resize(num_frames);
+    for (size_t i = 0; i < num_frames; ++i) {
+        float sum = 0.0f;
+        for (size_t channel = 0; channel < num_channels; ++channel) {
+            sum += DecodeSample(data + i * frame_size + channel * sample_size, format, bits_per_sample);
+        }
+        audio.samples[i] = sum / num_channels;
+    }
+    return audio;
+}
+
+std::vector<uint8_t> EncodeWav(absl::Span<const float> samples, int sample_rate) {
+    constexpr uint32_t kHeaderSize = 44;
+    const uint32_t data_size = samples.size() * sizeof(int16_t);
+    std::vector<uint8_t> wav;
+    wav.reserve(kHeaderSize + data_size);
+    auto append = [&wav](uint32_t value, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            wav.push_back((value >> (8 * i)) & 0xFF);
+        }
+    };
+    auto append_tag = [&wav](const char* tag) { wav.insert(wav.end(), tag, tag + 4); };
+
+    append_tag("RIFF");
+    append(kHeaderSize - 8 + data_size, 4);
+    append_tag("WAVE");
+    append_tag("fmt ");
+    append(16, 4);
+    append(kFormatPcm, 2);
+    append(1, 2);
+    append(sample_rate, 4);
+    append(sample_rate * sizeof(int16_t), 4);
+    append(sizeof(int16_t), 2);
+    append(16, 2);
+    append_tag("data");
+    append(data_size, 4);
+    for (int16_t sample : ToPcm16(samples)) {
+        append(static_cast<uint16_t>(sample), 2);
+    }
+    return wav;
+}
+
+std::vector<int16_t> ToPcm16(absl::Span<const float> samples) {
+    std::vector<int16_t> pcm(samples.size());
+    std::transform(samples.begin(), samples.end(), pcm.begin(), [](float x) {
+        return static_cast<int16_t>(std::clamp(x, -1.0f, 1.0f) * 32767.0f);
+    });
+    return pcm;
+}
+
+}  // namespace aikit::ml
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+namespace aikit::ml {
+
+struct WavAudio {
+    int sample_rate = 0;
+    // Mono, in [-1, 1]. Channels of the file are averaged.
+    std::vector<float> samples;
+
+    double duration_sec() const { return static_cast<double>(samples.size()) / sample_rate; }
+};
+
+// Reads RIFF/WAVE file with integer PCM (8, 16, 24 or 32 bits) or
+// 32 bit float samples, plain or WAVE_FORMAT_EXTENSIBLE. Chunks other
+// than "fmt " and "data" are skipped.
+absl::StatusOr<WavAudio> ReadWav(const std::string& path);
+
+// Encodes samples in [-1, 1] as a 16 bit PCM mono WAV file.
+std::vector<uint8_t> EncodeWav(absl::Span<const float> samples, int sample_rate);
+
+// Converts samples in [-1, 1] to 16 bit PCM, the values out of the
+// range are clamped.
+std::vector<int16_t> ToPcm16(absl::Span<const float> samples);
+
+}  // namespace aikit::ml
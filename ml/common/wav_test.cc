@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ml/common/wav.h"
+
+namespace {
+void AppendLE(std::string& out, uint32_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+// WAV file with a LIST chunk before "data", like ffmpeg writes it.
+std::string WriteWav(const std::string& name, uint16_t format, uint16_t num_channels, uint16_t bits_per_sample,
+                     const std::string& data) {
+    std::string fmt;
+    AppendLE(fmt, format, 2);
+    AppendLE(fmt, num_channels, 2);
+    AppendLE(fmt, 16000, 4);
+    AppendLE(fmt, 16000 * num_channels * bits_per_sample / 8, 4);
+    AppendLE(fmt, num_channels * bits_per_sample / 8, 2);
+    AppendLE(fmt, bits_per_sample, 2);
+
+    std::string body = "WAVEfmt ";
+    AppendLE(body, fmt.size(), 4);
+    body += fmt + "LIST";
+    AppendLE(body, 3, 4);
+    body += std::string("abc") + '\0' + "data";
+    AppendLE(body, data.size(), 4);
+    body += data;
+
+    std::string wav = "RIFF";
+    AppendLE(wav, body.size(), 4);
+    wav += body;
+
+    const auto path = (std::filesystem::path(::testing::TempDir()) / name).string();
+    std::ofstream(path, std::ios::binary) << wav;
+    return path;
+}
+}  // namespace
+
+TEST(TestMLCommonWav, ReadsPcm16) {
+    std::string data;
+    for (int16_t sample : {0, 16384, -32768, 32767}) {
+        AppendLE(data, static_cast<uint16_t>(sample), 2);
+    }
+    auto audio = aikit::ml::ReadWav(WriteWav("pcm16.wav", 1, 1, 16, data));
+    ASSERT_TRUE(audio.ok()) << audio.status().message();
+    EXPECT_EQ(audio->sample_rate, 16000);
+    ASSERT_EQ(audio->samples.size(), 4);
+    EXPECT_FLOAT_EQ(audio->samples[0], 0.0f);
+    EXPECT_FLOAT_EQ(audio->samples[1], 0.5f);
+    EXPECT_FLOAT_EQ(audio->samples[2], -1.0f);
+    EXPECT_NEAR(audio->samples[3], 1.0f, 1e-4);
+
+    EXPECT_EQ(aikit::ml::ToPcm16(audio->samples), (std::vector<int16_t>{0, 16383, -32767, 32766}));
+}
+
+TEST(TestMLCommonWav, ReadsStereoFloatAndPcm24) {
+    std::string data;
+    for (float sample : {0.5f, -0.5f, 0.25f, 0.75f}) {
+        uint32_t bits;
+        std::memcpy(&bits, &sample, sizeof(bits));
+        AppendLE(data, bits, 4);
+    }
+    auto audio = aikit::ml::ReadWav(WriteWav("float_stereo.wav", 3, 2, 32, data));
+    ASSERT_TRUE(audio.ok()) << audio.status().message();
+    EXPECT_EQ(audio->samples, (std::vector<float>{0.0f, 0.5f}));
+
+    data.clear();
+    AppendLE(data, 0xC00000, 3);  // -0.5
+    auto pcm24 = aikit::ml::ReadWav(WriteWav("pcm24.wav", 1, 1, 24, data));
+    ASSERT_TRUE(pcm24.ok()) << pcm24.status().message();
+    EXPECT_EQ(pcm24->samples, (std::vector<float>{-0.5f}));
+}
+
+TEST(TestMLCommonWav, RejectsInvalidFiles) {
+    EXPECT_FALSE(aikit::ml::ReadWav(::testing::TempDir() + "/missing.wav").ok());
+    const auto raw_path = ::testing::TempDir() + "/raw.wav";
+    std::ofstream(raw_path, std::ios::binary) << std::string(64, '\0');
+    EXPECT_FALSE(aikit::ml::ReadWav(raw_path).ok());
+    EXPECT_FALSE(aikit::ml::ReadWav(WriteWav("alaw.wav", 6, 1, 8, "abcd")).ok());
+}
+
+TEST(TestMLCommonWav, EncodesPcm16) {
+    const std::vector<float> samples = {0.0f, 0.5f, -0.5f};
+    const auto wav = aikit::ml::EncodeWav(samples, 8000);
+    EXPECT_EQ(wav.size(), 44 + 6);
+
+    const auto path = ::testing::TempDir() + "/encoded.wav";
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(wav.data()), wav.size());
+    auto audio = aikit::ml::ReadWav(path);
+    ASSERT_TRUE(audio.ok()) << audio.status().message();
+    EXPECT_EQ(audio->sample_rate, 8000);
+    ASSERT_EQ(audio->samples.size(), 3);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        EXPECT_NEAR(audio->samples[i], samples[i], 1e-4);
+    }
+}
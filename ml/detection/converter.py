@@ -1,9 +1,13 @@
 import argparse
+import json
 import tempfile
 import platform
 from pathlib import Path
 
+import numpy as np
 import onnx
+from onnx import compose, helper, numpy_helper
+from PIL import Image
 from onnxruntime_extensions.tools.pre_post_processing.utils import IoMapEntry
 from optimum.exporters.onnx.model_configs import DetrOnnxConfig
 from optimum.exporters.onnx import main_export
@@ -24,6 +28,25 @@ from onnxruntime_extensions.tools.pre_post_processing import (
     SelectBestBoundingBoxesByNMS,
 )
 
+from ml.quantization.calibration import quantize_static_int8, split_held_out
+
+# Needs to be coherent with ml/detection/train.py
+LABEL_TO_CATEGORY = {
+    "speaker": 0,
+    "participant": 1,
+    "shared screen": 2,
+    "black screen": 3,
+    "welcome page": 4,
+    "alone": 5,
+    "name": 6,
+}
+# Frames are fed to the model at the size of the screen capture, see
+# aikit::ml::CDetr.
+FRAME_SIZE = (1280, 720)
+# The network sees the frames at 0.7 of the resolution they are inferred
+# at, 896x504 for the full one.
+NETWORK_SCALE = 0.7
+
 
 def parse_args():
     parser = argparse.ArgumentParser()
@@ -46,6 +69,33 @@ def parse_args():
         choices=["arm64", "avx2", "avx512", "avx512_vnni"],
         default="arm64" if platform.system() == "Darwin" else "avx512_vnni",
     )
+    parser.add_argument(
+        "--reduced_resolutions",
+        help=(
+            "Specify comma separated resolutions, e.g. 960x540,640x360, to"
+            " write the variants of model.onnx which infer the frames at them"
+            " (model_960x540.onnx, ...). The variants take the same frames and"
+            " output boxes normalized by the frame."
+        ),
+        default="960x540,640x360",
+    )
+    parser.add_argument(
+        "--calibration_json",
+        help=(
+            "Specify path to the json file exported from Label Studio, its frames"
+            " calibrate the static INT8 model (model_int8.onnx)."
+        ),
+        type=Path,
+    )
+    parser.add_argument(
+        "--held_out_fraction",
+        help=(
+            "Fraction of the labeled frames kept out of the calibration, they are"
+            " listed in held_out_labels.txt for ml/quantization:report."
+        ),
+        type=float,
+        default=0.2,
+    )
     return parser.parse_args()
 
 
@@ -57,11 +107,17 @@ class ConditionalDetrOnnxConfig(DetrOnnxConfig):
         super().__init__(config, task="object-detection")
 
 
-def image_processor():
+def image_processor(resolution: tuple[int, int] = FRAME_SIZE):
+    """Steps from the frame to the input of the network.
+
+    The frame is resized straight to the input of the network at
+    `resolution`, width and height, whatever the size of the frame.
+    """
     steps = []
 
+    width, height = resolution
     steps.append(ChannelsLastToChannelsFirst())
-    steps.append(Resize((504, 896), layout="CHW"))
+    steps.append(Resize((round(height * NETWORK_SCALE), round(width * NETWORK_SCALE)), layout="CHW"))
     steps.append(ImageBytesToFloat(rescale_factor=0.00392156862745098))
     mean_std = list(zip([0.485, 0.456, 0.406], [0.229, 0.224, 0.225]))
     steps.append(Normalize(mean_std, layout="CHW"))
@@ -107,7 +163,128 @@ def object_detection_postprocessor():
     ]
 
 
-def convert(model_name: str, output_model: Path, quantization: str):
+def batched_pre_processing(opset: int, ir_version: int) -> onnx.ModelProto:
+    """Same steps as image_processor() on a batch [batch, height, width, 3]."""
+    mean = np.array([0.485, 0.456, 0.406], dtype=np.float32).reshape(1, 3, 1, 1)
+    std = np.array([0.229, 0.224, 0.225], dtype=np.float32).reshape(1, 3, 1, 1)
+    # 720x1280 frames are resized to 504x896.
+    scales = np.array([1.0, 1.0, NETWORK_SCALE, NETWORK_SCALE], dtype=np.float32)
+    initializers = [
+        numpy_helper.from_array(scales, "resize_scales"),
+        numpy_helper.from_array(np.array(1 / 255, dtype=np.float32), "rescale_factor"),
+        numpy_helper.from_array(mean, "mean"),
+        numpy_helper.from_array(std, "std"),
+    ]
+    nodes = [
+        helper.make_node("Transpose", ["images"], ["images_chw"], perm=[0, 3, 1, 2]),
+        helper.make_node("Cast", ["images_chw"], ["images_float"], to=onnx.TensorProto.FLOAT),
+        helper.make_node("Resize", ["images_float", "", "resize_scales"], ["images_resized"], mode="linear"),
+        helper.make_node("Mul", ["images_resized", "rescale_factor"], ["images_rescaled"]),
+        helper.make_node("Sub", ["images_rescaled", "mean"], ["images_centered"]),
+        helper.make_node("Div", ["images_centered", "std"], ["pixel_values"]),
+    ]
+    graph = helper.make_graph(
+        nodes,
+        "batched_pre_processing",
+        [helper.make_tensor_value_info("images", onnx.TensorProto.UINT8, ["batch", "height", "width", 3])],
+        [helper.make_tensor_value_info("pixel_values", onnx.TensorProto.FLOAT, ["batch", 3, 504, 896])],
+        initializers,
+    )
+    return helper.make_model(graph, opset_imports=[helper.make_opsetid("", opset)], ir_version=ir_version)
+
+
+def batched_post_processing(opset: int, ir_version: int) -> onnx.ModelProto:
+    """NMS of each frame of the batch, thresholds of SelectBestBoundingBoxesByNMS.
+
+    Rows of nms_out are `batch_index, x_center, y_center, width, height,
+    score, label_id`, see aikit::ml::CDetr.
+    """
+    initializers = [
+        numpy_helper.from_array(np.array([0], dtype=np.int64), "classes_start"),
+        numpy_helper.from_array(np.array([-1], dtype=np.int64), "classes_end"),
+        numpy_helper.from_array(np.array([2], dtype=np.int64), "classes_axis"),
+        numpy_helper.from_array(np.array([100], dtype=np.int64), "max_output_boxes_per_class"),
+        numpy_helper.from_array(np.array([0.5], dtype=np.float32), "iou_threshold"),
+        numpy_helper.from_array(np.array([0.67], dtype=np.float32), "score_threshold"),
+        numpy_helper.from_array(np.array([0], dtype=np.int64), "batch_column"),
+        numpy_helper.from_array(np.array([1], dtype=np.int64), "class_column"),
+        numpy_helper.from_array(np.array([0, 2], dtype=np.int64), "box_columns"),
+        numpy_helper.from_array(np.array([1], dtype=np.int64), "score_axes"),
+    ]
+    nodes = [
+        helper.make_node("Softmax", ["logits"], ["probabilities"], axis=-1),
+        # The last class is "no object".
+        helper.make_node("Slice", ["probabilities", "classes_start", "classes_end", "classes_axis"], ["class_scores"]),
+        helper.make_node("Transpose", ["class_scores"], ["scores"], perm=[0, 2, 1]),
+        helper.make_node(
+            "NonMaxSuppression",
+            ["pred_boxes", "scores", "max_output_boxes_per_class", "iou_threshold", "score_threshold"],
+            ["selected"],
+            center_point_box=1,
+        ),
+        helper.make_node("Gather", ["selected", "box_columns"], ["box_indices"], axis=1),
+        helper.make_node("GatherND", ["pred_boxes", "box_indices"], ["boxes"]),
+        helper.make_node("GatherND", ["scores", "selected"], ["selected_scores"]),
+        helper.make_node("Unsqueeze", ["selected_scores", "score_axes"], ["score"]),
+        helper.make_node("Gather", ["selected", "batch_column"], ["batch_index"], axis=1),
+        helper.make_node("Cast", ["batch_index"], ["batch_index_float"], to=onnx.TensorProto.FLOAT),
+        helper.make_node("Gather", ["selected", "class_column"], ["label_id"], axis=1),
+        helper.make_node("Cast", ["label_id"], ["label_id_float"], to=onnx.TensorProto.FLOAT),
+        helper.make_node("Concat", ["batch_index_float", "boxes", "score", "label_id_float"], ["nms_out"], axis=1),
+    ]
+    graph = helper.make_graph(
+        nodes,
+        "batched_post_processing",
+        [
+            helper.make_tensor_value_info("logits", onnx.TensorProto.FLOAT, ["batch", "queries", "classes"]),
+            helper.make_tensor_value_info("pred_boxes", onnx.TensorProto.FLOAT, ["batch", "queries", 4]),
+        ],
+        [helper.make_tensor_value_info("nms_out", onnx.TensorProto.FLOAT, ["detections", 7])],
+        initializers,
+    )
+    return helper.make_model(graph, opset_imports=[helper.make_opsetid("", opset)], ir_version=ir_version)
+
+
+def batched(model: onnx.ModelProto, opset: int) -> onnx.ModelProto:
+    """The exported model with the pre and post processing of a batch of frames.
+
+    The export has a dynamic batch dimension, so aikit::ml::CDetr runs a
+    batch of frames in one session Run.
+    """
+    pre = batched_pre_processing(opset, model.ir_version)
+    post = batched_post_processing(opset, model.ir_version)
+    model = compose.merge_models(pre, model, io_map=[("pixel_values", "pixel_values")])
+    return compose.merge_models(model, post, io_map=[("logits", "logits"), ("pred_boxes", "pred_boxes")])
+
+
+def parse_resolutions(resolutions: str) -> list[tuple[int, int]]:
+    """Width and height of each of "960x540,640x360"."""
+    parsed = []
+    for resolution in filter(None, resolutions.split(",")):
+        width, height = resolution.lower().split("x")
+        parsed.append((int(width), int(height)))
+    return parsed
+
+
+def with_processing(model: onnx.ModelProto, opset: int, resolution: tuple[int, int]) -> onnx.ModelProto:
+    """The exported model with the pre and post processing of a frame."""
+    inputs = [create_named_value("image", onnx.TensorProto.UINT8, ["height", "width", 3])]
+
+    pipeline = PrePostProcessor(inputs, opset)
+
+    preprocessing = image_processor(resolution)
+    pipeline.add_pre_processing(preprocessing)
+    pipeline._pre_processing_joins = [(preprocessing[-1], 0, "pixel_values")]
+    pipeline.add_post_processing(object_detection_postprocessor())
+    return pipeline.run(model)
+
+
+def convert(
+    model_name: str,
+    output_model: Path,
+    quantization: str,
+    reduced_resolutions: list[tuple[int, int]] | None = None,
+):
     custom_onnx_config = {"model": ConditionalDetrOnnxConfig(model_name)}
 
     with tempfile.TemporaryDirectory() as tmpdir:
@@ -120,27 +297,22 @@ def convert(model_name: str, output_model: Path, quantization: str):
 
         onnx_model_body = tmpdir + "/model.onnx"
         model = onnx.load(onnx_model_body)
-        inputs = [
-            create_named_value("image", onnx.TensorProto.UINT8, ["height", "width", 3])
-        ]
-
-        pipeline = PrePostProcessor(
-            inputs, custom_onnx_config["model"].DEFAULT_ONNX_OPSET
-        )
-
-        preprocessing = image_processor()
-        pipeline.add_pre_processing(preprocessing)
-        pipeline._pre_processing_joins = [(preprocessing[-1], 0, "pixel_values")]
-        pipeline.add_post_processing(object_detection_postprocessor())
-        model_with_preprocessing = pipeline.run(model)
+        opset = custom_onnx_config["model"].DEFAULT_ONNX_OPSET
+        onnx.save_model(batched(model, opset), output_model / "model_batched.onnx")
+        for width, height in reduced_resolutions or []:
+            onnx.save_model(
+                with_processing(onnx.load(onnx_model_body), opset, (width, height)),
+                output_model / f"model_{width}x{height}.onnx",
+            )
 
         output_file = output_model / "model.onnx"
-        onnx.save_model(model_with_preprocessing, output_file)
+        onnx.save_model(with_processing(model, opset, FRAME_SIZE), output_file)
 
         if (output_model / "model_quantized.onnx").exists():
             (output_model / "model_quantized.onnx").unlink()
 
-        quantizer = ORTQuantizer.from_pretrained(output_model)
+        # The directory has model_int8.onnx as well.
+        quantizer = ORTQuantizer.from_pretrained(output_model, file_name="model.onnx")
         dqconfig = getattr(AutoQuantizationConfig, quantization)(
             is_static=False, per_channel=False
         )
@@ -160,10 +332,65 @@ def convert(model_name: str, output_model: Path, quantization: str):
         quantizer.quantize(save_dir=output_model, quantization_config=dqconfig)
 
 
+def labeled_frames(exported_json: Path) -> list[tuple[Path, list[tuple[int, float, float, float, float]]]]:
+    """Frames of the Label Studio export with their boxes.
+
+    A box is the category and xmin, ymin, width, height normalized by the
+    size of the frame.
+    """
+    frames = []
+    for task in json.loads(exported_json.read_text()):
+        image_path = Path("/" + task["data"]["image"].split("=")[1])
+        boxes = []
+        for result in task["annotations"][0]["result"]:
+            value = result["value"]
+            boxes.append(
+                (
+                    LABEL_TO_CATEGORY[value["rectanglelabels"][0]],
+                    value["x"] / 100.0,
+                    value["y"] / 100.0,
+                    value["width"] / 100.0,
+                    value["height"] / 100.0,
+                )
+            )
+        frames.append((image_path, boxes))
+    return frames
+
+
+def quantize_int8(output_model: Path, calibration_json: Path, held_out_fraction: float):
+    """Writes model_int8.onnx next to model.onnx and the held-out labels.
+
+    Each line of held_out_labels.txt is a frame and one of its boxes:
+    `path<TAB>label_id xmin ymin width height`, or just the path for a
+    frame without boxes.
+    """
+    calibration, held_out = split_held_out(labeled_frames(calibration_json), held_out_fraction)
+    images = [
+        np.asarray(Image.open(path).convert("RGB").resize(FRAME_SIZE), dtype=np.uint8)
+        for path, _ in calibration
+    ]
+    quantize_static_int8(output_model / "model.onnx", output_model / "model_int8.onnx", images)
+
+    lines = []
+    for path, boxes in held_out:
+        if not boxes:
+            lines.append(str(path))
+        for label_id, xmin, ymin, width, height in boxes:
+            lines.append(f"{path}\t{label_id} {xmin} {ymin} {width} {height}")
+    (output_model / "held_out_labels.txt").write_text("\n".join(lines) + "\n")
+
+
 def main():
     args = parse_args()
     model_name = str(args.input_model)
-    convert(model_name, args.output_model, args.quantization)
+    convert(
+        model_name,
+        args.output_model,
+        args.quantization,
+        parse_resolutions(args.reduced_resolutions),
+    )
+    if args.calibration_json:
+        quantize_int8(args.output_model, args.calibration_json, args.held_out_fraction)
 
 
 if __name__ == "__main__":
@@ -1,69 +1,105 @@
 
 #include "ml/detection/model.h"
+#include "ml/common/ort_runtime.h"
+#include <algorithm>
 #include <cstdint>
-#include <thread>
+#include <utility>
 
 namespace aikit::ml {
-CDetr::CDetr(const std::string& path_to_model) {
-  env_ = Ort::Env(logging_level_, log_id_.c_str());
-
+CDetr::CDetr(const std::string &path_to_model, const CDetrOptions &options) {
   run_options_ = Ort::RunOptions();
-  session_options_ = Ort::SessionOptions();
+  session_options_ = OrtRuntime::SessionOptions(log_id_, logging_level_);
+  OrtRuntime::EnableProfiling(session_options_, options.profile_prefix);
 
-  // Default to a limit of 16 threads to optimize performance
-  constexpr int min_thread_nums = 1;
-  constexpr int max_thread_nums = 16;
-  int num_of_cores =
-      std::max(min_thread_nums,
-               static_cast<int>(std::thread::hardware_concurrency() / 2));
-  session_options_.SetIntraOpNumThreads(num_of_cores);
-  session_options_.SetInterOpNumThreads(num_of_cores);
-  session_options_.EnableCpuMemArena();
-  session_options_.EnableMemPattern();
+  session_ = OrtRuntime::CreateSession(path_to_model, session_options_);
 
-  session_options_.SetLogId(log_id_.c_str());
-  session_options_.SetLogSeverityLevel(logging_level_);
+  batched_ = session_.GetInputTypeInfo(0)
+                 .GetTensorTypeAndShapeInfo()
+                 .GetShape()
+                 .size() == 4;
 
-  // if (options.enable_profiling.has_value()) {
-  //   fs::path profile_file_prefix{options.enable_profiling.value()};
-  //   ort_options.EnableProfiling(profile_file_prefix.c_str());
-  // }
+  memory_info_ =
+      Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+  io_binding_ = Ort::IoBinding(session_);
+  // The number of detections varies, so the output can't be preallocated,
+  // it's allocated by the session from its arena.
+  io_binding_.BindOutput(output_names_[0], memory_info_);
+}
 
-  session_ =
-      Ort::Session(env_, path_to_model.c_str(), session_options_);
+std::vector<Detection> CDetr::operator()(const uint8_t *image) {
+  // Wraps the caller's frame, ORT only reads the inputs.
+  const std::array<int64_t, 4> batch_shape{1, height, width, 3};
+  auto input_tensor = Ort::Value::CreateTensor<uint8_t>(
+      memory_info_, const_cast<uint8_t *>(image), 3 * height * width,
+      batched_ ? batch_shape.data() : input_shape_.data(),
+      batched_ ? batch_shape.size() : input_shape_.size());
+  io_binding_.BindInput(
+      batched_ ? batched_input_names_[0] : input_names_[0], input_tensor);
+  std::vector<std::vector<Detection>> detections;
+  Run(1, detections);
+  return std::move(detections.front());
+}
 
-  auto memory_info =
-      Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
-  allocator_device_ = Ort::Allocator(session_, memory_info);
+std::vector<std::vector<Detection>>
+CDetr::operator()(absl::Span<const uint8_t *const> images) {
+  std::vector<std::vector<Detection>> detections;
+  if (!batched_ || images.size() <= 1) {
+    for (const auto *image : images) {
+      detections.push_back((*this)(image));
+    }
+    return detections;
+  }
 
-  input_tensor_ = Ort::Value::CreateTensor<uint8_t>(
-      allocator_device_, input_shape_.data(), input_shape_.size());
+  // The frames are separate buffers, the batch is one tensor.
+  constexpr size_t frame_size = 3 * height * width;
+  batch_.resize(images.size() * frame_size);
+  for (size_t i = 0; i < images.size(); ++i) {
+    std::copy_n(images[i], frame_size, batch_.data() + i * frame_size);
+  }
+  const std::array<int64_t, 4> batch_shape{
+      static_cast<int64_t>(images.size()), height, width, 3};
+  auto input_tensor = Ort::Value::CreateTensor<uint8_t>(
+      memory_info_, batch_.data(), batch_.size(), batch_shape.data(),
+      batch_shape.size());
+  io_binding_.BindInput(batched_input_names_[0], input_tensor);
+  Run(images.size(), detections);
+  return detections;
 }
 
-std::vector<Detection> CDetr::operator()(const uint8_t *image) {
+std::string CDetr::EndProfiling() {
+  return OrtRuntime::EndProfiling(session_);
+}
 
-  auto input_tensor_data = input_tensor_.GetTensorMutableData<uint8_t>();
-  std::copy_n(image, 3 * height * width, input_tensor_data);
-  auto output_tensors =
-      session_.Run(run_options_, input_names_.data(), &input_tensor_, 1,
-                   output_names_.data(), 1);
+void CDetr::Run(size_t batch_size,
+                std::vector<std::vector<Detection>> &detections) {
+  session_.Run(run_options_, io_binding_);
+  auto output_tensors = io_binding_.GetOutputValues();
   auto elements_num =
       output_tensors.front().GetTensorTypeAndShapeInfo().GetShape()[0];
-  float *floatarr = output_tensors.front().GetTensorMutableData<float>();
+  const float *floatarr = output_tensors.front().GetTensorData<float>();
 
-  std::vector<Detection> res;
-  res.reserve(elements_num);
-  for (auto detection_ix = 0; detection_ix < elements_num; ++detection_ix) {
-    res.emplace_back(Detection{
-        .x_center = floatarr[detection_ix * 6 + 0],
-        .y_center = floatarr[detection_ix * 6 + 1],
-        .width = floatarr[detection_ix * 6 + 2],
-        .height = floatarr[detection_ix * 6 + 3],
-        .label_id = static_cast<int>(floatarr[detection_ix * 6 + 5]),
-        .score = floatarr[detection_ix * 6 + 4],
+  // Rows of the batched model start with the index of the frame.
+  const int64_t row_size = batched_ ? 7 : 6;
+  detections.assign(batch_size, {});
+  for (int64_t detection_ix = 0; detection_ix < elements_num; ++detection_ix) {
+    const float *row = floatarr + detection_ix * row_size;
+    size_t frame = 0;
+    if (batched_) {
+      frame = static_cast<size_t>(row[0]);
+      ++row;
+    }
+    if (frame >= batch_size) {
+      continue;
+    }
+    detections[frame].emplace_back(Detection{
+        .x_center = row[0],
+        .y_center = row[1],
+        .width = row[2],
+        .height = row[3],
+        .label_id = static_cast<int>(row[5]),
+        .score = row[4],
     });
   }
-  return res;
 }
 
 } // namespace aikit::ml
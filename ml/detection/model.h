@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 
+#include "absl/types/span.h"
+
 namespace aikit::ml {
 
 // A bounding box. The box is defined by its upper left corner (xmin, ymin)
@@ -20,12 +22,45 @@ struct Detection {
   float score;
 };
 
+struct CDetrOptions {
+  // Prefix of the ONNX Runtime profile of the ops, empty to not profile.
+  // See OrtRuntime::EndProfiling.
+  std::string profile_prefix;
+};
+
+// Conditional DETR detector of the meeting's layout.
+//
+// The input and the output are bound to the session once (Ort::IoBinding),
+// so a call reads the caller's frame in place instead of copying it into
+// an input tensor, and the outputs are allocated from the session's arena.
+//
+// Either model of ml/detection/converter.py is loaded: model.onnx takes
+// one frame, model_batched.onnx takes a batch of frames of any size. A
+// batch is detected in one Run of the batched model, or frame by frame
+// with the other one.
+//
+// The variants model_<w>x<h>.onnx take the same frames and resize them
+// to infer at the lower resolution w x h inside the graph, the boxes are
+// normalized by the frame whatever the resolution.
 class CDetr {
 public:
-  explicit CDetr(const std::string &path_to_model);
+  explicit CDetr(const std::string &path_to_model,
+                 const CDetrOptions &options = {});
 
+  // `image` is a contiguous RGB frame of width x height, it's only read
+  // while the call runs.
   std::vector<Detection> operator()(const uint8_t *image);
 
+  // Detections of each of the `images`, frames as above.
+  std::vector<std::vector<Detection>>
+  operator()(absl::Span<const uint8_t *const> images);
+
+  // Whether the model takes a batch of frames.
+  bool batched() const { return batched_; }
+
+  // Writes the profile, returns its path or empty if it's not profiled.
+  std::string EndProfiling();
+
 public:
   static constexpr size_t width = 1280;
   static constexpr size_t height = 720;
@@ -34,17 +69,27 @@ private:
   std::string log_id_ = "cdetr";
   OrtLoggingLevel logging_level_ = ORT_LOGGING_LEVEL_WARNING;
 
-  Ort::Env env_;
   Ort::RunOptions run_options_;
   Ort::SessionOptions session_options_;
   Ort::Session session_{nullptr};
 
-  Ort::Allocator allocator_device_{nullptr};
+  // Runs the model on the bound input, sets `detections` to the
+  // detections of each frame of the batch.
+  void Run(size_t batch_size,
+           std::vector<std::vector<Detection>> &detections);
+
+  Ort::MemoryInfo memory_info_{nullptr};
+  Ort::IoBinding io_binding_{nullptr};
 
-  Ort::Value input_tensor_{nullptr};
+  bool batched_ = false;
   std::array<int64_t, 3> input_shape_{height, width, 3};
+  // Frames of a batch copied together, the input of the batched model
+  // is one tensor.
+  std::vector<uint8_t> batch_;
 
   static constexpr std::array<const char *, 1> input_names_ = {"image"};
+  static constexpr std::array<const char *, 1> batched_input_names_ = {
+      "images"};
   static constexpr std::array<const char *, 1> output_names_ = {"nms_out"};
 };
 } // namespace aikit::ml
@@ -5,6 +5,7 @@
 #include <opencv2/core/mat.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
+#include <vector>
 
 #include "ml/detection/model.h"
 
@@ -21,4 +22,51 @@ static void BM_CDetr(benchmark::State &state) {
 }
 
 BENCHMARK(BM_CDetr)->MinWarmUpTime(2.0)->MinTime(5.0);
+
+// The frame inferred by the variants of ml/detection/converter.py at
+// the resolutions of --reduced_resolutions, the accuracy of each is
+// reported by //ml/quantization:report. BM_CDetr is the full 1280x720
+// resolution.
+static void BM_CDetrResolution(benchmark::State &state,
+                               const char *model_path) {
+  auto model = aikit::ml::CDetr(model_path);
+
+  cv::Mat input_mat;
+  cv::cvtColor(cv::imread("testdata/meeting_frame.png"), input_mat,
+               cv::COLOR_BGR2RGB);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(model(input_mat.data));
+  }
+}
+
+BENCHMARK_CAPTURE(BM_CDetrResolution, 960x540,
+                  "ml/detection/models/model_960x540.onnx")
+    ->MinWarmUpTime(2.0)
+    ->MinTime(5.0);
+BENCHMARK_CAPTURE(BM_CDetrResolution, 640x360,
+                  "ml/detection/models/model_640x360.onnx")
+    ->MinWarmUpTime(2.0)
+    ->MinTime(5.0);
+
+// One Run of the batched model per batch of state.range(0) frames.
+static void BM_CDetrBatch(benchmark::State &state) {
+  auto model = aikit::ml::CDetr("ml/detection/models/model_batched.onnx");
+
+  cv::Mat input_mat;
+  cv::cvtColor(cv::imread("testdata/meeting_frame.png"), input_mat,
+               cv::COLOR_BGR2RGB);
+  const std::vector<const uint8_t *> images(state.range(0), input_mat.data);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(model(images));
+  }
+  state.SetItemsProcessed(state.iterations() * images.size());
+}
+
+BENCHMARK(BM_CDetrBatch)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->MinWarmUpTime(2.0)
+    ->MinTime(5.0);
 BENCHMARK_MAIN();
@@ -5,6 +5,9 @@
 #include <opencv2/core/mat.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
+#include <filesystem>
+#include <string>
+#include <vector>
 
 #include "ml/detection/model.h"
 
@@ -25,3 +28,66 @@ TEST(TestMLDetectionModel, SanityCheck) {
                    << d.height << "] " << d.label_id << " " << d.score << "\n";
   }
 }
+
+TEST(TestMLDetectionModel, ReadsFramesInPlace) {
+  auto model = aikit::ml::CDetr("ml/detection/models/model.onnx");
+
+  cv::Mat input_mat;
+  cv::cvtColor(cv::imread("testdata/meeting_frame.png"), input_mat,
+               cv::COLOR_BGR2RGB);
+  auto first = model(input_mat.data);
+
+  // Another frame at another address, the output is rebound per call.
+  cv::Mat black_mat = cv::Mat::zeros(input_mat.size(), input_mat.type());
+  model(black_mat.data);
+
+  auto second = model(input_mat.clone().data);
+  ASSERT_EQ(first.size(), second.size());
+  for (size_t i = 0; i < first.size(); ++i) {
+    EXPECT_FLOAT_EQ(first[i].x_center, second[i].x_center);
+    EXPECT_FLOAT_EQ(first[i].score, second[i].score);
+    EXPECT_EQ(first[i].label_id, second[i].label_id);
+  }
+}
+
+TEST(TestMLDetectionModel, BatchMatchesSingleFrames) {
+  auto model = aikit::ml::CDetr("ml/detection/models/model_batched.onnx");
+  ASSERT_TRUE(model.batched());
+
+  cv::Mat input_mat;
+  cv::cvtColor(cv::imread("testdata/meeting_frame.png"), input_mat,
+               cv::COLOR_BGR2RGB);
+  cv::Mat black_mat = cv::Mat::zeros(input_mat.size(), input_mat.type());
+  const std::vector<const uint8_t *> images = {input_mat.data, black_mat.data,
+                                               input_mat.data};
+  auto batch = model(images);
+  ASSERT_EQ(batch.size(), images.size());
+
+  for (size_t i = 0; i < images.size(); ++i) {
+    auto single = model(images[i]);
+    ASSERT_EQ(batch[i].size(), single.size());
+    for (size_t j = 0; j < single.size(); ++j) {
+      EXPECT_NEAR(batch[i][j].x_center, single[j].x_center, 1e-4);
+      EXPECT_NEAR(batch[i][j].score, single[j].score, 1e-4);
+      EXPECT_EQ(batch[i][j].label_id, single[j].label_id);
+    }
+  }
+}
+
+TEST(TestMLDetectionModel, WritesProfile) {
+  const std::string prefix = ::testing::TempDir() + "/cdetr_profile";
+  auto model = aikit::ml::CDetr("ml/detection/models/model.onnx",
+                                {.profile_prefix = prefix});
+
+  cv::Mat input_mat;
+  cv::cvtColor(cv::imread("testdata/meeting_frame.png"), input_mat,
+               cv::COLOR_BGR2RGB);
+  model(input_mat.data);
+
+  const auto profile = model.EndProfiling();
+  EXPECT_EQ(profile.rfind(prefix, 0), 0);
+  EXPECT_TRUE(std::filesystem::exists(profile));
+  EXPECT_TRUE(std::filesystem::exists(profile + ".start_ns"));
+  // Written once.
+  EXPECT_TRUE(model.EndProfiling().empty());
+}
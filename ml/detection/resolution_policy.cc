@@ -0,0 +1,37 @@
+#include "ml/detection/resolution_policy.h"
+
+#include <algorithm>
+
+namespace aikit::ml {
+
+ResolutionPolicy::ResolutionPolicy(const ResolutionPolicyOptions &options)
+    : options_(options) {
+  options_.num_resolutions = std::max<size_t>(options_.num_resolutions, 1);
+}
+
+size_t ResolutionPolicy::Next() const { return next_; }
+
+void ResolutionPolicy::Update(const std::vector<Detection> &detections) {
+  ++num_frames_;
+  const size_t lowest = options_.num_resolutions - 1;
+  if (options_.full_resolution_interval > 0 &&
+      num_frames_ % options_.full_resolution_interval == 0) {
+    next_ = 0;
+    return;
+  }
+
+  bool trivial = !detections.empty();
+  for (const auto &detection : detections) {
+    if (detection.label_id == options_.name_label_id) {
+      next_ = 0;
+      return;
+    }
+    trivial = trivial && std::find(options_.trivial_label_ids.begin(),
+                                   options_.trivial_label_ids.end(),
+                                   detection.label_id) !=
+                             options_.trivial_label_ids.end();
+  }
+  next_ = trivial ? lowest : std::min<size_t>(1, lowest);
+}
+
+} // namespace aikit::ml
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "ml/detection/model.h"
+
+namespace aikit::ml {
+
+struct ResolutionPolicyOptions {
+  // Number of the CDetr variants, the first one infers the frames at the
+  // full resolution, the next ones at lower and lower resolutions.
+  size_t num_resolutions = 1;
+  // Layouts with nothing to read, the frames after them are inferred at
+  // the lowest resolution: black screen, welcome page and alone, see
+  // ml/detection/train.py.
+  std::vector<int> trivial_label_ids = {3, 4, 5};
+  // The name of the speaker is read from its box by OCR, the frames
+  // after it are inferred at the full resolution.
+  int name_label_id = 6;
+  // Every n-th frame is inferred at the full resolution whatever the
+  // previous labels, so what a lower resolution misses is caught up. 0
+  // to never force it.
+  size_t full_resolution_interval = 10;
+};
+
+// Chooses the resolution of the next frame from the labels detected on
+// the previous one.
+//
+// The layout of a meeting changes rarely, a frame mostly looks like the
+// previous one: after a trivial layout the next frame is inferred at the
+// lowest resolution, after a frame with the name of the speaker at the
+// full one, otherwise at the second one. The detections are normalized
+// by the frame, so they are the same whatever the resolution.
+class ResolutionPolicy {
+public:
+  explicit ResolutionPolicy(const ResolutionPolicyOptions &options = {});
+
+  // Index of the variant for the next frame.
+  size_t Next() const;
+
+  // Records the detections of the frame inferred at Next().
+  void Update(const std::vector<Detection> &detections);
+
+private:
+  ResolutionPolicyOptions options_;
+  size_t next_ = 0;
+  size_t num_frames_ = 0;
+};
+
+} // namespace aikit::ml
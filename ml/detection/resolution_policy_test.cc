@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "ml/detection/resolution_policy.h"
+
+namespace {
+std::vector<aikit::ml::Detection> Labels(const std::vector<int> &label_ids) {
+  std::vector<aikit::ml::Detection> detections;
+  for (int label_id : label_ids) {
+    detections.push_back({.x_center = 0.5f,
+                          .y_center = 0.5f,
+                          .width = 0.1f,
+                          .height = 0.1f,
+                          .label_id = label_id,
+                          .score = 0.9f});
+  }
+  return detections;
+}
+} // namespace
+
+TEST(TestMLDetectionResolutionPolicy, FollowsPreviousLabels) {
+  aikit::ml::ResolutionPolicy policy(
+      {.num_resolutions = 3, .full_resolution_interval = 0});
+  EXPECT_EQ(policy.Next(), 0);
+
+  // Black screen.
+  policy.Update(Labels({3}));
+  EXPECT_EQ(policy.Next(), 2);
+  // Welcome page and alone.
+  policy.Update(Labels({4, 5}));
+  EXPECT_EQ(policy.Next(), 2);
+  // Participants, nothing to read.
+  policy.Update(Labels({1, 1, 5}));
+  EXPECT_EQ(policy.Next(), 1);
+  // The name of the speaker.
+  policy.Update(Labels({0, 6}));
+  EXPECT_EQ(policy.Next(), 0);
+  // Nothing detected.
+  policy.Update({});
+  EXPECT_EQ(policy.Next(), 1);
+}
+
+TEST(TestMLDetectionResolutionPolicy, ForcesFullResolution) {
+  aikit::ml::ResolutionPolicy policy(
+      {.num_resolutions = 2, .full_resolution_interval = 3});
+  policy.Update(Labels({3}));
+  EXPECT_EQ(policy.Next(), 1);
+  policy.Update(Labels({3}));
+  EXPECT_EQ(policy.Next(), 1);
+  policy.Update(Labels({3}));
+  EXPECT_EQ(policy.Next(), 0);
+  policy.Update(Labels({3}));
+  EXPECT_EQ(policy.Next(), 1);
+}
+
+TEST(TestMLDetectionResolutionPolicy, SingleResolution) {
+  aikit::ml::ResolutionPolicy policy;
+  policy.Update(Labels({3}));
+  EXPECT_EQ(policy.Next(), 0);
+  policy.Update(Labels({1}));
+  EXPECT_EQ(policy.Next(), 0);
+}
@@ -0,0 +1,73 @@
+#include "benchmark/benchmark.h"
+
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "ml/common/ort_runtime.h"
+#include "ml/detection/model.h"
+#include "ml/ocr/model.h"
+
+namespace {
+double ProcessCpuSeconds() {
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+} // namespace
+
+// A frame of the visual graph, which runs at 1 FPS: CDetr and OCR
+// inferences, then idle until the next frame. The time is the latency of
+// the inferences, idle_cpu is the cores busy while the models wait for
+// the next frame. The argument is 0 for a thread pool per model, as the
+// models had before, 1 for the pools shared by OrtRuntime.
+static void BM_VisualFrame(benchmark::State &state) {
+  const bool shared_pools = state.range(0) == 1;
+  if (!aikit::ml::OrtRuntime::Configure(
+           {.per_session_threads = !shared_pools})
+           .ok()) {
+    state.SkipWithError("Can't configure ONNX Runtime");
+    return;
+  }
+  auto cdetr = aikit::ml::CDetr("ml/detection/models/model.onnx");
+  auto ocr = aikit::ml::OCR("ml/ocr/models/model.onnx");
+
+  cv::Mat frame;
+  cv::cvtColor(cv::imread("testdata/meeting_frame.png"), frame,
+               cv::COLOR_BGR2RGB);
+  cv::Mat name;
+  cv::cvtColor(cv::imread("testdata/participant_name.png"), name,
+               cv::COLOR_BGR2GRAY);
+  // Warm up.
+  cdetr(frame.data);
+  ocr(name.data);
+
+  constexpr auto kIdle = std::chrono::milliseconds(500);
+  double idle_cpu_sec = 0.0;
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    benchmark::DoNotOptimize(cdetr(frame.data));
+    benchmark::DoNotOptimize(ocr(name.data));
+    state.SetIterationTime(std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count());
+
+    const double cpu_sec = ProcessCpuSeconds();
+    std::this_thread::sleep_for(kIdle);
+    idle_cpu_sec += ProcessCpuSeconds() - cpu_sec;
+  }
+  state.counters["idle_cpu"] =
+      idle_cpu_sec / (std::chrono::duration<double>(kIdle).count() *
+                      state.iterations());
+}
+
+BENCHMARK(BM_VisualFrame)
+    ->ArgName("shared_pools")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseManualTime()
+    ->Iterations(20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_MAIN();
@@ -0,0 +1,66 @@
+#include "ml/diarization/diarizer.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "absl/strings/str_cat.h"
+#include "ml/common/vector_ops.h"
+
+namespace aikit::ml {
+
+OnlineDiarizer::OnlineDiarizer(const OnlineDiarizerOptions& options) : options_(options) {
+    speakers_.reserve(options_.max_speakers);
+    centroids_.reserve(static_cast<size_t>(options_.max_speakers) * options_.embedding_size);
+    embedding_.resize(options_.embedding_size);
+    scores_.reserve(options_.max_speakers);
+}
+
+absl::StatusOr<int> OnlineDiarizer::Assign(absl::Span<const float> embedding) {
+    const size_t size = options_.embedding_size;
+    if (embedding.size() != size) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Expected speaker embedding of size ", size, ", got ", embedding.size()));
+    }
+    ++num_utterances_;
+    std::copy(embedding.begin(), embedding.end(), embedding_.begin());
+    Normalize(embedding_.data(), size);
+
+    scores_.resize(speakers_.size());
+    DotRows(centroids_.data(), speakers_.size(), embedding_.data(), size, scores_.data());
+    const auto best = std::max_element(scores_.begin(), scores_.end());
+    if (best != scores_.end() && *best >= options_.similarity_threshold) {
+        const size_t slot = std::distance(scores_.begin(), best);
+        auto& speaker = speakers_[slot];
+        // Running mean of the unit length embeddings, renormalized so
+        // the scores stay cosine similarities.
+        float* centroid = centroids_.data() + slot * size;
+        speaker.weight = std::min(speaker.weight + 1, options_.max_centroid_weight);
+        const float alpha = 1.0f / speaker.weight;
+        for (size_t i = 0; i < size; ++i) {
+            centroid[i] *= 1.0f - alpha;
+        }
+        Axpy(alpha, embedding_.data(), centroid, size);
+        Normalize(centroid, size);
+        speaker.last_seen = num_utterances_;
+        return speaker.id;
+    }
+
+    const size_t slot = AllocateSlot();
+    speakers_[slot] = {next_id_++, 1, num_utterances_};
+    std::copy(embedding_.begin(), embedding_.end(), centroids_.begin() + slot * size);
+    return speakers_[slot].id;
+}
+
+size_t OnlineDiarizer::AllocateSlot() {
+    if (speakers_.size() < static_cast<size_t>(options_.max_speakers)) {
+        speakers_.emplace_back();
+        centroids_.resize(speakers_.size() * options_.embedding_size);
+        return speakers_.size() - 1;
+    }
+    const auto oldest = std::min_element(
+        speakers_.begin(), speakers_.end(),
+        [](const Speaker& a, const Speaker& b) { return a.last_seen < b.last_seen; });
+    return std::distance(speakers_.begin(), oldest);
+}
+
+}  // namespace aikit::ml
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+namespace aikit::ml {
+
+struct OnlineDiarizerOptions {
+    // Size of speaker embeddings, x-vectors of vosk-model-spk-0.4 have 128.
+    int embedding_size = 128;
+    // Utterance goes to the most similar speaker if the cosine similarity
+    // of its embedding to the speaker's centroid is at least this,
+    // otherwise a new speaker is started.
+    float similarity_threshold = 0.5f;
+    // Memory bound. When all the slots are taken, a new speaker replaces
+    // the one heard least recently.
+    int max_speakers = 32;
+    // Centroid is the mean of the last this many utterances of the
+    // speaker, so it follows slow changes of the voice and the channel.
+    int max_centroid_weight = 50;
+};
+
+// Assigns speaker ids to utterances by clustering their speaker
+// embeddings online.
+//
+// Each utterance is compared with the centroids of the speakers seen so
+// far, all centroids are kept unit length in one row-major matrix, so
+// an utterance costs one SIMD pass over max_speakers * embedding_size
+// floats. Ids start from 1 and are never reused, so the id of a speaker
+// stays the same for the whole session (unless the speaker is evicted).
+class OnlineDiarizer {
+public:
+  explicit OnlineDiarizer(const OnlineDiarizerOptions& options = {});
+
+  // Returns the id of the speaker of the utterance.
+  absl::StatusOr<int> Assign(absl::Span<const float> embedding);
+
+  // Number of speakers which are currently tracked.
+  int num_speakers() const { return static_cast<int>(speakers_.size()); }
+
+private:
+  struct Speaker {
+    int id;
+    int weight;
+    // Number of the utterance the speaker was heard last in.
+    int64_t last_seen;
+  };
+
+  // Index of the slot for a new speaker.
+  size_t AllocateSlot();
+
+  OnlineDiarizerOptions options_;
+  int next_id_ = 1;
+  int64_t num_utterances_ = 0;
+  std::vector<Speaker> speakers_;
+  // speakers_.size() x embedding_size.
+  std::vector<float> centroids_;
+  std::vector<float> embedding_;
+  std::vector<float> scores_;
+};
+
+}  // namespace aikit::ml
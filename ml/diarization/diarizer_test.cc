@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include "ml/diarization/diarizer.h"
+
+namespace {
+// Embedding of an utterance of the speaker: the voice plus noise.
+std::vector<float> Utterance(const std::vector<float>& voice, float noise, std::mt19937& gen) {
+    std::normal_distribution<float> dist(0.0f, noise);
+    auto embedding = voice;
+    for (auto& x : embedding) {
+        x += dist(gen);
+    }
+    return embedding;
+}
+
+std::vector<float> RandomVoice(size_t size, std::mt19937& gen) {
+    return Utterance(std::vector<float>(size, 0.0f), 1.0f, gen);
+}
+}  // namespace
+
+TEST(TestMLDiarizationOnlineDiarizer, KeepsSpeakerIdsStable) {
+    std::mt19937 gen(7);
+    aikit::ml::OnlineDiarizer diarizer;
+    const std::vector<std::vector<float>> voices = {RandomVoice(128, gen), RandomVoice(128, gen),
+                                                    RandomVoice(128, gen)};
+
+    std::vector<int> ids;
+    for (const auto& voice : voices) {
+        auto id = diarizer.Assign(Utterance(voice, 0.3f, gen));
+        ASSERT_TRUE(id.ok()) << id.status().message();
+        ids.push_back(id.value());
+    }
+    EXPECT_EQ(ids, (std::vector<int>{1, 2, 3}));
+
+    for (int turn = 0; turn < 30; ++turn) {
+        const size_t speaker = (turn * 7) % voices.size();
+        auto id = diarizer.Assign(Utterance(voices[speaker], 0.3f, gen));
+        ASSERT_TRUE(id.ok());
+        EXPECT_EQ(id.value(), ids[speaker]) << turn;
+    }
+    EXPECT_EQ(diarizer.num_speakers(), 3);
+}
+
+TEST(TestMLDiarizationOnlineDiarizer, BoundsNumberOfSpeakers) {
+    std::mt19937 gen(11);
+    aikit::ml::OnlineDiarizer diarizer({.embedding_size = 16, .max_speakers = 2});
+    const auto first = RandomVoice(16, gen);
+    const auto second = RandomVoice(16, gen);
+    const auto third = RandomVoice(16, gen);
+
+    EXPECT_EQ(diarizer.Assign(first).value(), 1);
+    EXPECT_EQ(diarizer.Assign(second).value(), 2);
+    EXPECT_EQ(diarizer.Assign(first).value(), 1);
+    // Replaces the second speaker, who was heard least recently.
+    EXPECT_EQ(diarizer.Assign(third).value(), 3);
+    EXPECT_EQ(diarizer.num_speakers(), 2);
+    EXPECT_EQ(diarizer.Assign(first).value(), 1);
+    EXPECT_EQ(diarizer.Assign(third).value(), 3);
+}
+
+TEST(TestMLDiarizationOnlineDiarizer, RejectsWrongEmbeddingSize) {
+    aikit::ml::OnlineDiarizer diarizer;
+    EXPECT_FALSE(diarizer.Assign(std::vector<float>(10, 1.0f)).ok());
+    EXPECT_EQ(diarizer.num_speakers(), 0);
+}
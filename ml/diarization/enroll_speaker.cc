@@ -0,0 +1,124 @@
+// Enrolls the voice of a person into the speaker index searched by
+// SpeakerIdentificationCalculator (see --speaker_index_path of the
+// av_transducer), the index is created if there is no file yet.
+//
+// bazel run //ml/diarization:enroll_speaker -- \
+//   --index_path=/path/to/speakers.idx --name="Alice" \
+//   --wav=/path/to/alice_1.wav,/path/to/alice_2.wav
+//
+// Every WAV file becomes a separate voice of the person: the speaker
+// embeddings of its utterances are averaged, so a file should hold
+// speech of the person alone, ideally recorded like the meetings.
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/flags/usage.h"
+#include "absl/log/absl_log.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "ml/asr/model.h"
+#include "ml/common/vector_ops.h"
+#include "ml/common/wav.h"
+#include "ml/diarization/speaker_index.h"
+
+ABSL_FLAG(std::string, index_path, "", "Speaker index to enroll into.");
+ABSL_FLAG(std::string, name, "", "Name of the person, shown with the recognized speech.");
+ABSL_FLAG(std::vector<std::string>, wav, {}, "Comma separated WAV files with the speech of the person.");
+ABSL_FLAG(std::string, asr_model_path, "ml/asr/models/vosk-model-small-ru-0.22",
+          "ASR model which finds the utterances.");
+ABSL_FLAG(std::string, spk_model_path, "ml/asr/models/vosk-model-spk-0.4",
+          "Speaker model, the same as --spk_model_path of the av_transducer.");
+
+namespace {
+// Average of the unit length embeddings of the utterances of the file.
+absl::StatusOr<std::vector<float>> EmbedVoice(const std::string& wav_path) {
+    auto audio = aikit::ml::ReadWav(wav_path);
+    if (!audio.ok()) {
+        return audio.status();
+    }
+    aikit::ml::ASRModel model(absl::GetFlag(FLAGS_asr_model_path), absl::GetFlag(FLAGS_spk_model_path),
+                              audio->sample_rate);
+    std::vector<float> voice;
+    int num_utterances = 0;
+    auto add_utterance = [&](aikit::ml::ASRResult& result) {
+        auto& embedding = result.spk_embedding;
+        aikit::ml::Normalize(embedding.data(), embedding.size());
+        voice.resize(embedding.size());
+        aikit::ml::Axpy(1.0f, embedding.data(), voice.data(), voice.size());
+        ++num_utterances;
+    };
+
+    // Fed in chunks of 0.1 s as the av_transducer does, so the utterances
+    // are split at the same pauses.
+    const size_t chunk_size = audio->sample_rate / 10;
+    std::vector<float> chunk;
+    aikit::ml::ASRResult result;
+    for (size_t offset = 0; offset < audio->samples.size(); offset += chunk_size) {
+        const auto begin = audio->samples.begin() + offset;
+        chunk.assign(begin, begin + std::min(chunk_size, audio->samples.size() - offset));
+        auto status = model(chunk, result);
+        if (status.ok()) {
+            add_utterance(result);
+        } else if (!absl::IsUnavailable(status)) {
+            return status;
+        }
+    }
+    auto status = model.Flush(result);
+    if (status.ok()) {
+        add_utterance(result);
+    } else if (!absl::IsUnavailable(status)) {
+        return status;
+    }
+
+    if (num_utterances == 0) {
+        return absl::InvalidArgumentError(absl::StrCat("No speech in ", wav_path));
+    }
+    ABSL_LOG(INFO) << wav_path << ": " << num_utterances << " utterances";
+    return voice;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    absl::SetProgramUsageMessage("Enrolls the voice of a person into the speaker index.");
+    absl::ParseCommandLine(argc, argv);
+
+    const auto wavs = absl::GetFlag(FLAGS_wav);
+    if (absl::GetFlag(FLAGS_index_path).empty() || absl::GetFlag(FLAGS_name).empty() || wavs.empty()) {
+        ABSL_LOG(ERROR) << "--index_path, --name and --wav are required";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::vector<float>> voices;
+    for (const auto& wav : wavs) {
+        auto voice = EmbedVoice(wav);
+        if (!voice.ok()) {
+            ABSL_LOG(ERROR) << voice.status().message();
+            return EXIT_FAILURE;
+        }
+        voices.push_back(*std::move(voice));
+    }
+
+    // The size of the index follows the speaker model.
+    auto index = aikit::ml::SpeakerIndex::Open(
+        absl::GetFlag(FLAGS_index_path),
+        {.embedding_size = static_cast<int>(voices[0].size()), .create_if_missing = true});
+    if (!index.ok()) {
+        ABSL_LOG(ERROR) << index.status().message();
+        return EXIT_FAILURE;
+    }
+    for (const auto& voice : voices) {
+        auto enrolled = index->Enroll(absl::GetFlag(FLAGS_name), voice);
+        if (!enrolled.ok()) {
+            ABSL_LOG(ERROR) << enrolled.status().message();
+            return EXIT_FAILURE;
+        }
+    }
+    ABSL_LOG(INFO) << "Enrolled " << voices.size() << " voices of " << absl::GetFlag(FLAGS_name) << ", the index has "
+                   << index->size() << " voices";
+    return EXIT_SUCCESS;
+}
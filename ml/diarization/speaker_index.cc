@@ -0,0 +1,325 @@
+#include "ml/diarization/speaker_index.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <numeric>
+
+#include "absl/strings/str_cat.h"
+#include "ml/common/vector_ops.h"
+
+namespace aikit::ml {
+namespace {
+// The file is the header, capacity x embedding_size floats of the
+// embeddings and capacity names of kNameStride bytes, zero terminated.
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t embedding_size;
+    uint64_t size;
+    uint64_t capacity;
+    // Keeps the embeddings aligned for SIMD loads.
+    uint8_t reserved[32];
+};
+static_assert(sizeof(FileHeader) == 64);
+
+constexpr char kMagic[8] = {'A', 'I', 'K', 'S', 'P', 'K', 'I', 'X'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kNameStride = SpeakerIndex::kMaxNameSize + 1;
+constexpr uint64_t kInitialCapacity = 64;
+constexpr int kClusteringIterations = 8;
+
+FileHeader* HeaderOf(uint8_t* data) { return reinterpret_cast<FileHeader*>(data); }
+
+size_t FileSize(uint64_t capacity, size_t embedding_size) {
+    return sizeof(FileHeader) + capacity * (embedding_size * sizeof(float) + kNameStride);
+}
+}  // namespace
+
+absl::StatusOr<SpeakerIndex> SpeakerIndex::Open(const std::string& path, const SpeakerIndexOptions& options) {
+    if (options.embedding_size <= 0 || options.num_probes == 0) {
+        return absl::InvalidArgumentError("embedding_size and num_probes must be positive");
+    }
+    SpeakerIndex index;
+    index.options_ = options;
+    index.fd_ = open(path.c_str(), O_RDWR | O_CLOEXEC | (options.create_if_missing ? O_CREAT : 0), 0644);
+    if (index.fd_ < 0) {
+        return absl::NotFoundError(absl::StrCat("Can't open ", path, ": ", std::strerror(errno)));
+    }
+    struct stat file_stat;
+    if (fstat(index.fd_, &file_stat) != 0) {
+        return absl::InternalError(absl::StrCat("Can't stat ", path, ": ", std::strerror(errno)));
+    }
+    const size_t dim = options.embedding_size;
+
+    if (file_stat.st_size == 0 && options.create_if_missing) {
+        const size_t file_size = FileSize(kInitialCapacity, dim);
+        if (ftruncate(index.fd_, file_size) != 0) {
+            return absl::InternalError(absl::StrCat("Can't resize ", path, ": ", std::strerror(errno)));
+        }
+        auto status = index.Map(file_size);
+        if (!status.ok()) {
+            return status;
+        }
+        auto* header = HeaderOf(index.data_);
+        std::memcpy(header->magic, kMagic, sizeof(kMagic));
+        header->version = kVersion;
+        header->embedding_size = dim;
+        header->size = 0;
+        header->capacity = kInitialCapacity;
+        return index;
+    }
+
+    if (static_cast<size_t>(file_stat.st_size) < sizeof(FileHeader)) {
+        return absl::InvalidArgumentError(absl::StrCat(path, " is not a speaker index"));
+    }
+    auto status = index.Map(file_stat.st_size);
+    if (!status.ok()) {
+        return status;
+    }
+    const auto* header = HeaderOf(index.data_);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion) {
+        return absl::InvalidArgumentError(absl::StrCat(path, " is not a speaker index"));
+    }
+    if (header->embedding_size != dim) {
+        return absl::InvalidArgumentError(absl::StrCat("Speaker index ", path, " has embeddings of size ",
+                                                       header->embedding_size, ", expected ", dim));
+    }
+    if (header->size > header->capacity || FileSize(header->capacity, dim) > index.data_size_) {
+        return absl::DataLossError(absl::StrCat("Speaker index ", path, " is truncated"));
+    }
+    if (index.size() > options.max_flat_size) {
+        index.BuildClusters();
+    }
+    return index;
+}
+
+SpeakerIndex::SpeakerIndex(SpeakerIndex&& other) noexcept { *this = std::move(other); }
+
+SpeakerIndex& SpeakerIndex::operator=(SpeakerIndex&& other) noexcept {
+    if (this != &other) {
+        Unmap();
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+        options_ = other.options_;
+        fd_ = std::exchange(other.fd_, -1);
+        data_ = std::exchange(other.data_, nullptr);
+        data_size_ = std::exchange(other.data_size_, 0);
+        clustered_size_ = std::exchange(other.clustered_size_, 0);
+        centroids_ = std::move(other.centroids_);
+        clusters_ = std::move(other.clusters_);
+    }
+    return *this;
+}
+
+SpeakerIndex::~SpeakerIndex() {
+    Unmap();
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+absl::Status SpeakerIndex::Map(size_t file_size) {
+    void* data = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) {
+        return absl::InternalError(absl::StrCat("Can't map the speaker index: ", std::strerror(errno)));
+    }
+    data_ = static_cast<uint8_t*>(data);
+    data_size_ = file_size;
+    return absl::OkStatus();
+}
+
+void SpeakerIndex::Unmap() {
+    if (data_ != nullptr) {
+        munmap(data_, data_size_);
+        data_ = nullptr;
+        data_size_ = 0;
+    }
+}
+
+absl::Status SpeakerIndex::Grow() {
+    const size_t dim = options_.embedding_size;
+    const uint64_t capacity = HeaderOf(data_)->capacity;
+    const size_t names_size = capacity * kNameStride;
+    const size_t file_size = FileSize(2 * capacity, dim);
+    if (ftruncate(fd_, file_size) != 0) {
+        return absl::InternalError(absl::StrCat("Can't resize the speaker index: ", std::strerror(errno)));
+    }
+    Unmap();
+    auto status = Map(file_size);
+    if (!status.ok()) {
+        return status;
+    }
+    // Names follow the embeddings, so they move to the end of the new
+    // embeddings. The capacity is updated last, until then the file is
+    // read with the old layout.
+    uint8_t* old_names = data_ + sizeof(FileHeader) + capacity * dim * sizeof(float);
+    uint8_t* new_names = data_ + sizeof(FileHeader) + 2 * capacity * dim * sizeof(float);
+    std::memmove(new_names, old_names, names_size);
+    HeaderOf(data_)->capacity = 2 * capacity;
+    return absl::OkStatus();
+}
+
+float* SpeakerIndex::embeddings() const {
+    return reinterpret_cast<float*>(data_ + sizeof(FileHeader));
+}
+
+char* SpeakerIndex::names() const {
+    return reinterpret_cast<char*>(data_ + sizeof(FileHeader) +
+                                   HeaderOf(data_)->capacity * options_.embedding_size * sizeof(float));
+}
+
+size_t SpeakerIndex::size() const { return data_ != nullptr ? HeaderOf(data_)->size : 0; }
+
+std::string_view SpeakerIndex::name(size_t index) const { return names() + index * kNameStride; }
+
+absl::StatusOr<size_t> SpeakerIndex::Enroll(std::string_view name, absl::Span<const float> embedding) {
+    const size_t dim = options_.embedding_size;
+    if (embedding.size() != dim) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Expected speaker embedding of size ", dim, ", got ", embedding.size()));
+    }
+    if (name.empty() || name.size() > kMaxNameSize || name.find('\0') != std::string_view::npos) {
+        return absl::InvalidArgumentError(absl::StrCat("Bad speaker name \"", name, "\""));
+    }
+    if (HeaderOf(data_)->size == HeaderOf(data_)->capacity) {
+        auto status = Grow();
+        if (!status.ok()) {
+            return status;
+        }
+    }
+
+    const size_t index = size();
+    float* row = embeddings() + index * dim;
+    std::copy(embedding.begin(), embedding.end(), row);
+    Normalize(row, dim);
+    char* slot = names() + index * kNameStride;
+    std::memset(slot, 0, kNameStride);
+    std::memcpy(slot, name.data(), name.size());
+    // The voice counts only when it's complete.
+    HeaderOf(data_)->size = index + 1;
+
+    if (clustered_size_ == 0 ? size() > options_.max_flat_size : size() >= 2 * clustered_size_) {
+        BuildClusters();
+    } else if (clustered_size_ > 0) {
+        auto& cluster = clusters_[NearestCluster(row, scores_)];
+        cluster.rows.insert(cluster.rows.end(), row, row + dim);
+        cluster.ids.push_back(index);
+    }
+    return index;
+}
+
+void SpeakerIndex::BuildClusters() {
+    const size_t n = size();
+    const size_t dim = options_.embedding_size;
+    const float* rows = embeddings();
+    const size_t num_clusters = std::max<size_t>(1, std::lround(std::sqrt(static_cast<double>(n))));
+
+    // Spherical k-means: centroids are unit length, voices go to the
+    // centroid with the largest cosine similarity.
+    centroids_.resize(num_clusters * dim);
+    for (size_t c = 0; c < num_clusters; ++c) {
+        std::copy_n(rows + (c * n / num_clusters) * dim, dim, centroids_.begin() + c * dim);
+    }
+    std::vector<uint32_t> assignment(n);
+    std::vector<float> scores(num_clusters);
+    std::vector<float> sums(num_clusters * dim);
+    std::vector<size_t> counts(num_clusters);
+    for (int iteration = 0;; ++iteration) {
+        for (size_t i = 0; i < n; ++i) {
+            assignment[i] = NearestCluster(rows + i * dim, scores);
+        }
+        if (iteration + 1 == kClusteringIterations) {
+            break;
+        }
+        std::fill(sums.begin(), sums.end(), 0.0f);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (size_t i = 0; i < n; ++i) {
+            Axpy(1.0f, rows + i * dim, sums.data() + assignment[i] * dim, dim);
+            ++counts[assignment[i]];
+        }
+        for (size_t c = 0; c < num_clusters; ++c) {
+            // Empty cluster keeps its centroid.
+            if (counts[c] > 0) {
+                std::copy_n(sums.begin() + c * dim, dim, centroids_.begin() + c * dim);
+                Normalize(centroids_.data() + c * dim, dim);
+            }
+        }
+    }
+
+    clusters_.assign(num_clusters, {});
+    for (size_t i = 0; i < n; ++i) {
+        auto& cluster = clusters_[assignment[i]];
+        cluster.rows.insert(cluster.rows.end(), rows + i * dim, rows + (i + 1) * dim);
+        cluster.ids.push_back(i);
+    }
+    clustered_size_ = n;
+}
+
+size_t SpeakerIndex::NearestCluster(const float* embedding, std::vector<float>& scores) const {
+    scores.resize(centroids_.size() / options_.embedding_size);
+    DotRows(centroids_.data(), scores.size(), embedding, options_.embedding_size, scores.data());
+    return std::max_element(scores.begin(), scores.end()) - scores.begin();
+}
+
+void SpeakerIndex::ScoreRows(const float* rows, const uint32_t* ids, size_t num_rows) {
+    if (num_rows == 0) {
+        return;
+    }
+    scores_.resize(num_rows);
+    DotRows(rows, num_rows, query_.data(), options_.embedding_size, scores_.data());
+    for (size_t i = 0; i < num_rows; ++i) {
+        candidates_.emplace_back(scores_[i], ids != nullptr ? ids[i] : i);
+    }
+}
+
+absl::Status SpeakerIndex::Search(absl::Span<const float> embedding, size_t k,
+                                  std::vector<SpeakerMatch>& matches) {
+    const size_t dim = options_.embedding_size;
+    if (embedding.size() != dim) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Expected speaker embedding of size ", dim, ", got ", embedding.size()));
+    }
+    matches.clear();
+    if (k == 0 || size() == 0) {
+        return absl::OkStatus();
+    }
+    query_.assign(embedding.begin(), embedding.end());
+    Normalize(query_.data(), dim);
+
+    candidates_.clear();
+    if (clusters_.empty()) {
+        ScoreRows(embeddings(), nullptr, size());
+    } else {
+        centroid_scores_.resize(clusters_.size());
+        DotRows(centroids_.data(), clusters_.size(), query_.data(), dim, centroid_scores_.data());
+        probes_.resize(clusters_.size());
+        std::iota(probes_.begin(), probes_.end(), 0);
+        const size_t num_probes = std::min(options_.num_probes, clusters_.size());
+        std::partial_sort(probes_.begin(), probes_.begin() + num_probes, probes_.end(),
+                          [this](uint32_t a, uint32_t b) { return centroid_scores_[a] > centroid_scores_[b]; });
+        for (size_t p = 0; p < num_probes; ++p) {
+            const auto& cluster = clusters_[probes_[p]];
+            ScoreRows(cluster.rows.data(), cluster.ids.data(), cluster.ids.size());
+        }
+    }
+
+    k = std::min(k, candidates_.size());
+    std::partial_sort(candidates_.begin(), candidates_.begin() + k, candidates_.end(),
+                      std::greater<std::pair<float, uint32_t>>());
+    for (size_t i = 0; i < k; ++i) {
+        const auto [score, index] = candidates_[i];
+        matches.push_back({index, name(index), score});
+    }
+    return absl::OkStatus();
+}
+
+}  // namespace aikit::ml
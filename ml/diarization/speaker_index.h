@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+namespace aikit::ml {
+
+struct SpeakerIndexOptions {
+    // Size of speaker embeddings, x-vectors of vosk-model-spk-0.4 have 128.
+    // It must match the size of an existing index.
+    int embedding_size = 128;
+    // Indexes of up to this many voices are searched exhaustively. Larger
+    // ones are clustered, a search scans the clusters nearest to the query.
+    size_t max_flat_size = 512;
+    // Number of the clusters scanned by a search of the clustered index,
+    // more is slower but misses less.
+    size_t num_probes = 8;
+    // Open creates an empty index if there is no file, e.g. for the first
+    // enrollment. Otherwise a missing file is NotFound.
+    bool create_if_missing = false;
+};
+
+// Enrolled voice nearest to the query.
+struct SpeakerMatch {
+    // Index of the voice in the order of enrollment.
+    size_t index = 0;
+    // Points into the index, valid until the next Enroll.
+    std::string_view name;
+    // Cosine similarity of the voice and the query.
+    float score = 0.0f;
+};
+
+// Speaker embeddings of known people, kept on disk across meetings.
+//
+// The file is mapped into memory, unit length embeddings are stored in
+// one row-major matrix followed by the names, so an exhaustive search is
+// one SIMD pass over the mapped matrix (see DotRows). Indexes larger
+// than max_flat_size are clustered in memory (inverted file, spherical
+// k-means with about sqrt(size) clusters), which copies every voice into
+// its cluster on opening, and a search costs about
+// num_probes * sqrt(size) dot products. New voices join their nearest
+// cluster, the clustering is rebuilt when the index doubles.
+//
+// Voices are enrolled with //ml/diarization:enroll_speaker.
+//
+// A person may be enrolled several times (with embeddings of different
+// utterances, microphones, ...), every embedding is a separate voice.
+// Not thread safe, the file must not be opened for enrollment by several
+// processes at once.
+class SpeakerIndex {
+public:
+  // Longer names are rejected.
+  static constexpr size_t kMaxNameSize = 63;
+
+  // Opens the index at `path`, see SpeakerIndexOptions::create_if_missing.
+  static absl::StatusOr<SpeakerIndex> Open(const std::string& path,
+                                           const SpeakerIndexOptions& options = {});
+
+  SpeakerIndex(SpeakerIndex&& other) noexcept;
+  SpeakerIndex& operator=(SpeakerIndex&& other) noexcept;
+  SpeakerIndex(const SpeakerIndex&) = delete;
+  SpeakerIndex& operator=(const SpeakerIndex&) = delete;
+  ~SpeakerIndex();
+
+  // Adds the voice to the index and the file, returns its index.
+  absl::StatusOr<size_t> Enroll(std::string_view name, absl::Span<const float> embedding);
+
+  // Fills `matches` with at most `k` voices most similar to the embedding,
+  // most similar first.
+  absl::Status Search(absl::Span<const float> embedding, size_t k, std::vector<SpeakerMatch>& matches);
+
+  // Number of the enrolled voices.
+  size_t size() const;
+  std::string_view name(size_t index) const;
+  // Whether the searches scan the clusters.
+  bool clustered() const { return clustered_size_ > 0; }
+
+private:
+  SpeakerIndex() = default;
+  absl::Status Map(size_t file_size);
+  void Unmap();
+  absl::Status Grow();
+  float* embeddings() const;
+  char* names() const;
+  // Clusters all the voices.
+  void BuildClusters();
+  // Index of the centroid nearest to the unit length embedding.
+  size_t NearestCluster(const float* embedding, std::vector<float>& scores) const;
+  // Scores of the rows to candidates_, `ids` are the voices of the rows,
+  // the rows are all the voices if it's null.
+  void ScoreRows(const float* rows, const uint32_t* ids, size_t num_rows);
+
+  SpeakerIndexOptions options_;
+  int fd_ = -1;
+  uint8_t* data_ = nullptr;
+  size_t data_size_ = 0;
+
+  // Voices of a cluster, copied together.
+  struct Cluster {
+    std::vector<float> rows;
+    std::vector<uint32_t> ids;
+  };
+
+  // Size of the index when it was clustered last, 0 if it's not.
+  size_t clustered_size_ = 0;
+  // Unit length, clusters_.size() x embedding_size.
+  std::vector<float> centroids_;
+  std::vector<Cluster> clusters_;
+
+  // Scratch of Search.
+  std::vector<float> query_;
+  std::vector<float> centroid_scores_;
+  std::vector<float> scores_;
+  std::vector<uint32_t> probes_;
+  std::vector<std::pair<float, uint32_t>> candidates_;
+};
+
+}  // namespace aikit::ml
@@ -0,0 +1,54 @@
+#include "benchmark/benchmark.h"
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ml/diarization/speaker_index.h"
+
+namespace {
+std::vector<float> RandomVoice(size_t size, std::mt19937& gen) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> voice(size);
+    for (auto& x : voice) {
+        x = dist(gen);
+    }
+    return voice;
+}
+}  // namespace
+
+// Top-1 search of an index of 128 dimensional voices, the argument is the
+// number of the voices. Indexes larger than 1024 voices are clustered.
+static void BM_SpeakerIndex_Search(benchmark::State& state) {
+    const auto path = (std::filesystem::temp_directory_path() / "speaker_index_benchmark.idx").string();
+    std::filesystem::remove(path);
+    auto index = aikit::ml::SpeakerIndex::Open(path, {.create_if_missing = true});
+    if (!index.ok()) {
+        state.SkipWithError("Can't create the speaker index");
+        return;
+    }
+    std::mt19937 gen(42);
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        if (!index->Enroll("speaker" + std::to_string(i), RandomVoice(128, gen)).ok()) {
+            state.SkipWithError("Can't enroll");
+            return;
+        }
+    }
+    std::vector<std::vector<float>> queries;
+    for (int i = 0; i < 64; ++i) {
+        queries.push_back(RandomVoice(128, gen));
+    }
+
+    std::vector<aikit::ml::SpeakerMatch> matches;
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index->Search(queries[i++ % queries.size()], 1, matches));
+    }
+    std::filesystem::remove(path);
+}
+
+BENCHMARK(BM_SpeakerIndex_Search)->ArgName("voices")->RangeMultiplier(4)->Range(16, 16384)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
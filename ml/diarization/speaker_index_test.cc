@@ -0,0 +1,123 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ml/diarization/speaker_index.h"
+
+namespace {
+namespace fs = std::filesystem;
+
+std::vector<float> RandomVoice(size_t size, std::mt19937& gen) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> voice(size);
+    for (auto& x : voice) {
+        x = dist(gen);
+    }
+    return voice;
+}
+
+// Embedding of an utterance of the speaker: the voice plus noise.
+std::vector<float> Utterance(const std::vector<float>& voice, float noise, std::mt19937& gen) {
+    std::normal_distribution<float> dist(0.0f, noise);
+    auto embedding = voice;
+    for (auto& x : embedding) {
+        x += dist(gen);
+    }
+    return embedding;
+}
+
+std::string IndexPath(const std::string& name) {
+    const auto path = fs::path(::testing::TempDir()) / name;
+    fs::remove(path);
+    return path.string();
+}
+}  // namespace
+
+TEST(TestMLDiarizationSpeakerIndex, FindsEnrolledVoicesAfterReopening) {
+    std::mt19937 gen(7);
+    const auto path = IndexPath("speakers.idx");
+    const std::vector<std::vector<float>> voices = {RandomVoice(128, gen), RandomVoice(128, gen),
+                                                    RandomVoice(128, gen)};
+    {
+        auto index = aikit::ml::SpeakerIndex::Open(path, {.create_if_missing = true});
+        ASSERT_TRUE(index.ok()) << index.status().message();
+        EXPECT_EQ(index->size(), 0);
+        EXPECT_EQ(index->Enroll("Alice", voices[0]).value(), 0);
+        EXPECT_EQ(index->Enroll("Bob", voices[1]).value(), 1);
+        // Second voice of Alice.
+        EXPECT_EQ(index->Enroll("Alice", Utterance(voices[0], 0.3f, gen)).value(), 2);
+    }
+
+    auto index = aikit::ml::SpeakerIndex::Open(path);
+    ASSERT_TRUE(index.ok()) << index.status().message();
+    ASSERT_EQ(index->size(), 3);
+    EXPECT_EQ(index->name(1), "Bob");
+
+    std::vector<aikit::ml::SpeakerMatch> matches;
+    ASSERT_TRUE(index->Search(Utterance(voices[1], 0.3f, gen), 2, matches).ok());
+    ASSERT_EQ(matches.size(), 2);
+    EXPECT_EQ(matches[0].name, "Bob");
+    EXPECT_GT(matches[0].score, 0.8f);
+    EXPECT_GT(matches[0].score, matches[1].score);
+
+    // Unknown voice is not similar to anyone.
+    ASSERT_TRUE(index->Search(voices[2], 5, matches).ok());
+    ASSERT_EQ(matches.size(), 3);
+    EXPECT_LT(matches[0].score, 0.5f);
+}
+
+TEST(TestMLDiarizationSpeakerIndex, ClusteredSearchFindsNearestVoice) {
+    std::mt19937 gen(11);
+    const auto path = IndexPath("many_speakers.idx");
+    auto index = aikit::ml::SpeakerIndex::Open(path, {.max_flat_size = 256, .create_if_missing = true});
+    ASSERT_TRUE(index.ok()) << index.status().message();
+
+    std::vector<std::vector<float>> voices;
+    for (int i = 0; i < 3000; ++i) {
+        voices.push_back(RandomVoice(128, gen));
+        ASSERT_TRUE(index->Enroll("speaker" + std::to_string(i), voices.back()).ok());
+    }
+    EXPECT_TRUE(index->clustered());
+
+    int num_found = 0;
+    std::vector<aikit::ml::SpeakerMatch> matches;
+    for (int i = 0; i < 3000; i += 7) {
+        ASSERT_TRUE(index->Search(Utterance(voices[i], 0.5f, gen), 1, matches).ok());
+        ASSERT_EQ(matches.size(), 1);
+        num_found += matches[0].index == static_cast<size_t>(i);
+    }
+    EXPECT_GE(num_found, 0.95 * 3000 / 7);
+
+    // The clustering is rebuilt on opening.
+    auto reopened = aikit::ml::SpeakerIndex::Open(path, {.max_flat_size = 256});
+    ASSERT_TRUE(reopened.ok()) << reopened.status().message();
+    EXPECT_TRUE(reopened->clustered());
+    ASSERT_TRUE(reopened->Search(voices[42], 1, matches).ok());
+    EXPECT_EQ(matches[0].name, "speaker42");
+}
+
+TEST(TestMLDiarizationSpeakerIndex, RejectsBadInput) {
+    const auto path = IndexPath("bad.idx");
+    EXPECT_EQ(aikit::ml::SpeakerIndex::Open(path).status().code(), absl::StatusCode::kNotFound);
+    EXPECT_FALSE(fs::exists(path));
+
+    auto index = aikit::ml::SpeakerIndex::Open(path, {.embedding_size = 16, .create_if_missing = true});
+    ASSERT_TRUE(index.ok()) << index.status().message();
+    std::vector<aikit::ml::SpeakerMatch> matches;
+    EXPECT_FALSE(index->Enroll("Alice", std::vector<float>(10, 1.0f)).ok());
+    EXPECT_FALSE(index->Enroll("", std::vector<float>(16, 1.0f)).ok());
+    EXPECT_FALSE(index->Enroll(std::string(100, 'a'), std::vector<float>(16, 1.0f)).ok());
+    EXPECT_FALSE(index->Search(std::vector<float>(10, 1.0f), 1, matches).ok());
+    EXPECT_EQ(index->size(), 0);
+
+    // Other embedding size.
+    EXPECT_FALSE(aikit::ml::SpeakerIndex::Open(path).ok());
+
+    const auto other_path = IndexPath("not_index.idx");
+    std::ofstream(other_path) << "not a speaker index, but long enough to have the header of one......";
+    EXPECT_FALSE(aikit::ml::SpeakerIndex::Open(other_path).ok());
+}
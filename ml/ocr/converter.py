@@ -22,6 +22,11 @@ from onnxruntime_extensions.tools.pre_post_processing import (
     ArgMax,
 )
 
+from ml.quantization.calibration import quantize_static_int8, split_held_out
+
+# Crops of the names are fed to the model at this size, see aikit::ml::OCR.
+CROP_SIZE = (256, 64)
+
 
 def parse_args() -> argparse.Namespace:
     parser = argparse.ArgumentParser()
@@ -32,6 +37,24 @@ def parse_args() -> argparse.Namespace:
         type=Path,
         required=True,
     )
+    parser.add_argument(
+        "--calibration_dir",
+        help=(
+            "Specify directory of the crops of names and labels.txt with a"
+            " `file<TAB>text` line per crop, they calibrate the static INT8"
+            " model (model_int8.onnx)."
+        ),
+        type=Path,
+    )
+    parser.add_argument(
+        "--held_out_fraction",
+        help=(
+            "Fraction of the crops kept out of the calibration, they are listed"
+            " in held_out_labels.txt for ml/quantization:report."
+        ),
+        type=float,
+        default=0.2,
+    )
 
     return parser.parse_args()
 
@@ -135,8 +158,31 @@ def convert(output_model: Path):
         onnx.save_model(model_with_preprocessing, str(output_model / "model.onnx"))
 
 
+def quantize_int8(output_model: Path, calibration_dir: Path, held_out_fraction: float):
+    """Writes model_int8.onnx next to model.onnx and the held-out labels.
+
+    Each line of held_out_labels.txt is `path<TAB>text` of a crop.
+    """
+    crops = []
+    for line in (calibration_dir / "labels.txt").read_text().splitlines():
+        if line:
+            file, text = line.split("\t", 1)
+            crops.append(((calibration_dir / file).resolve(), text))
+    calibration, held_out = split_held_out(crops, held_out_fraction)
+    images = [
+        np.asarray(Image.open(path).convert("L").resize(CROP_SIZE), dtype=np.uint8)
+        for path, _ in calibration
+    ]
+    quantize_static_int8(output_model / "model.onnx", output_model / "model_int8.onnx", images)
+    (output_model / "held_out_labels.txt").write_text(
+        "".join(f"{path}\t{text}\n" for path, text in held_out)
+    )
+
+
 def main(args: argparse.Namespace):
     convert(args.output_model)
+    if args.calibration_dir:
+        quantize_int8(args.output_model, args.calibration_dir, args.held_out_fraction)
 
 
 if __name__ == "__main__":
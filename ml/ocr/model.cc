@@ -1,35 +1,14 @@
-#include <thread>
-
+#include "ml/common/ort_runtime.h"
 #include "ml/ocr/model.h"
 #include "ml/ocr/models/vocab.h.inc"
 
 namespace aikit::ml {
-OCR::OCR(const std::string &path_to_model) {
-  env_ = Ort::Env(logging_level_, log_id_.c_str());
-
+OCR::OCR(const std::string &path_to_model, const OCROptions &options) {
   run_options_ = Ort::RunOptions();
-  session_options_ = Ort::SessionOptions();
-
-  // Default to a limit of 16 threads to optimize performance
-  constexpr int min_thread_nums = 1;
-  constexpr int max_thread_nums = 16;
-  int num_of_cores =
-      std::max(min_thread_nums,
-               static_cast<int>(std::thread::hardware_concurrency() / 2));
-  session_options_.SetIntraOpNumThreads(num_of_cores);
-  session_options_.SetInterOpNumThreads(num_of_cores);
-  session_options_.EnableCpuMemArena();
-  session_options_.EnableMemPattern();
-
-  session_options_.SetLogId(log_id_.c_str());
-  session_options_.SetLogSeverityLevel(logging_level_);
+  session_options_ = OrtRuntime::SessionOptions(log_id_, logging_level_);
+  OrtRuntime::EnableProfiling(session_options_, options.profile_prefix);
 
-  // if (options.enable_profiling.has_value()) {
-  //   fs::path profile_file_prefix{options.enable_profiling.value()};
-  //   ort_options.EnableProfiling(profile_file_prefix.c_str());
-  // }
-
-  session_ = Ort::Session(env_, path_to_model.c_str(), session_options_);
+  session_ = OrtRuntime::CreateSession(path_to_model, session_options_);
 
   auto memory_info =
       Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
@@ -39,6 +18,10 @@ OCR::OCR(const std::string &path_to_model) {
       allocator_device_, input_shape_.data(), input_shape_.size());
 }
 
+std::string OCR::EndProfiling() {
+  return OrtRuntime::EndProfiling(session_);
+}
+
 std::string OCR::operator()(const uint8_t *image) {
 
   auto input_tensor_data = input_tensor_.GetTensorMutableData<uint8_t>();
@@ -5,11 +5,21 @@
 #include <string>
 
 namespace aikit::ml {
+struct OCROptions {
+  // Prefix of the ONNX Runtime profile of the ops, empty to not profile.
+  // See OrtRuntime::EndProfiling.
+  std::string profile_prefix;
+};
+
 class OCR {
 public:
-  explicit OCR(const std::string &path_to_model);
+  explicit OCR(const std::string &path_to_model,
+               const OCROptions &options = {});
   std::string operator()(const uint8_t *image);
 
+  // Writes the profile, returns its path or empty if it's not profiled.
+  std::string EndProfiling();
+
 public:
   static constexpr int64_t height = 64;
   static constexpr int64_t width = 256;
@@ -18,7 +28,6 @@ private:
   std::string log_id_ = "ocr_easyocr";
   OrtLoggingLevel logging_level_ = ORT_LOGGING_LEVEL_WARNING;
 
-  Ort::Env env_;
   Ort::RunOptions run_options_;
   Ort::SessionOptions session_options_;
   Ort::Session session_{nullptr};
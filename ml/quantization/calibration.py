@@ -0,0 +1,85 @@
+"""Static INT8 quantization of the ONNX models with calibration images."""
+
+import tempfile
+from pathlib import Path
+from typing import Sequence, TypeVar
+
+import numpy as np
+from onnxruntime.quantization import (
+    CalibrationDataReader,
+    CalibrationMethod,
+    QuantFormat,
+    QuantType,
+    quantize_static,
+)
+from onnxruntime.quantization.shape_inference import quant_pre_process
+
+T = TypeVar("T")
+
+
+class ImageCalibrationDataReader(CalibrationDataReader):
+    """Feeds the uint8 images to the input of the model one by one."""
+
+    def __init__(self, input_name: str, images: Sequence[np.ndarray]):
+        self.input_name = input_name
+        self.images = images
+        self.index = 0
+
+    def get_next(self) -> dict[str, np.ndarray] | None:
+        if self.index == len(self.images):
+            return None
+        image = self.images[self.index]
+        self.index += 1
+        return {self.input_name: image}
+
+    def rewind(self):
+        self.index = 0
+
+
+def split_held_out(items: Sequence[T], held_out_fraction: float) -> tuple[list[T], list[T]]:
+    """Splits the items into the calibration and the held-out ones.
+
+    Every n-th item is held out, so both parts cover the whole recording
+    the frames are taken from.
+    """
+    if held_out_fraction <= 0.0:
+        return list(items), []
+    step = max(1, round(1.0 / held_out_fraction))
+    calibration = [item for i, item in enumerate(items) if i % step != step - 1]
+    held_out = [item for i, item in enumerate(items) if i % step == step - 1]
+    return calibration, held_out
+
+
+def quantize_static_int8(
+    input_model: Path,
+    output_model: Path,
+    images: Sequence[np.ndarray],
+    input_name: str = "image",
+    op_types: Sequence[str] = ("Conv", "MatMul", "Gemm"),
+):
+    """Quantizes weights to int8 and activations to uint8 (QDQ format).
+
+    The ranges of the activations are calibrated on the images, which are
+    fed to the model as they are fed in production. Only the compute heavy
+    ops are quantized, the pre- and post-processing of the models stay in
+    float.
+    """
+    if not images:
+        raise ValueError("Static quantization needs calibration images")
+    with tempfile.TemporaryDirectory() as tmpdir:
+        preprocessed = Path(tmpdir) / "model_preprocessed.onnx"
+        quant_pre_process(str(input_model), str(preprocessed), skip_symbolic_shape=True)
+        quantize_static(
+            str(preprocessed),
+            str(output_model),
+            ImageCalibrationDataReader(input_name, images),
+            quant_format=QuantFormat.QDQ,
+            op_types_to_quantize=list(op_types),
+            per_channel=True,
+            activation_type=QuantType.QUInt8,
+            weight_type=QuantType.QInt8,
+            # Attention activations have outliers, min/max ranges waste
+            # most of the 8 bits on them.
+            calibrate_method=CalibrationMethod.Percentile,
+            extra_options={"CalibPercentile": 99.999},
+        )
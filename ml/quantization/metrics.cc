@@ -0,0 +1,102 @@
+#include "ml/quantization/metrics.h"
+
+#include <algorithm>
+#include <set>
+#include <tuple>
+
+namespace aikit::ml {
+
+float IntersectionOverUnion(const LabeledBox& a, const LabeledBox& b) {
+    const float width = std::min(a.xmin + a.width, b.xmin + b.width) - std::max(a.xmin, b.xmin);
+    const float height = std::min(a.ymin + a.height, b.ymin + b.height) - std::max(a.ymin, b.ymin);
+    if (width <= 0.0f || height <= 0.0f) {
+        return 0.0f;
+    }
+    const float intersection = width * height;
+    return intersection / (a.width * a.height + b.width * b.height - intersection);
+}
+
+double MeanAveragePrecision(const std::vector<std::vector<LabeledBox>>& detections,
+                            const std::vector<std::vector<LabeledBox>>& ground_truth, float iou_threshold) {
+    std::set<int> labels;
+    for (const auto& boxes : ground_truth) {
+        for (const auto& box : boxes) {
+            labels.insert(box.label_id);
+        }
+    }
+    if (labels.empty()) {
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    for (int label : labels) {
+        // Score, frame and index of the detections of the label.
+        std::vector<std::tuple<float, size_t, size_t>> ranked;
+        std::vector<std::vector<bool>> matched(ground_truth.size());
+        size_t num_ground_truth = 0;
+        for (size_t frame = 0; frame < ground_truth.size(); ++frame) {
+            matched[frame].resize(ground_truth[frame].size());
+            num_ground_truth += std::count_if(ground_truth[frame].begin(), ground_truth[frame].end(),
+                                              [&](const LabeledBox& box) { return box.label_id == label; });
+            if (frame >= detections.size()) {
+                continue;
+            }
+            for (size_t i = 0; i < detections[frame].size(); ++i) {
+                if (detections[frame][i].label_id == label) {
+                    ranked.emplace_back(detections[frame][i].score, frame, i);
+                }
+            }
+        }
+        std::stable_sort(ranked.begin(), ranked.end(),
+                         [](const auto& a, const auto& b) { return std::get<0>(a) > std::get<0>(b); });
+
+        // Precision at the recall of each true positive.
+        std::vector<double> precisions;
+        size_t num_true = 0;
+        for (size_t rank = 0; rank < ranked.size(); ++rank) {
+            const auto [score, frame, i] = ranked[rank];
+            const auto& detection = detections[frame][i];
+            float best_iou = iou_threshold;
+            size_t best = ground_truth[frame].size();
+            for (size_t j = 0; j < ground_truth[frame].size(); ++j) {
+                const auto& box = ground_truth[frame][j];
+                if (box.label_id != label || matched[frame][j]) {
+                    continue;
+                }
+                const float iou = IntersectionOverUnion(detection, box);
+                if (iou >= best_iou) {
+                    best_iou = iou;
+                    best = j;
+                }
+            }
+            if (best < ground_truth[frame].size()) {
+                matched[frame][best] = true;
+                ++num_true;
+                precisions.push_back(static_cast<double>(num_true) / (rank + 1));
+            }
+        }
+        // Interpolated precision is the best one at the same or higher
+        // recall, every true positive adds 1 / num_ground_truth of recall.
+        double average_precision = 0.0;
+        double interpolated = 0.0;
+        for (auto it = precisions.rbegin(); it != precisions.rend(); ++it) {
+            interpolated = std::max(interpolated, *it);
+            average_precision += interpolated;
+        }
+        sum += average_precision / num_ground_truth;
+    }
+    return sum / labels.size();
+}
+
+double ExactMatch(const std::vector<std::string>& predicted, const std::vector<std::string>& expected) {
+    if (expected.empty()) {
+        return 0.0;
+    }
+    size_t num_equal = 0;
+    for (size_t i = 0; i < std::min(predicted.size(), expected.size()); ++i) {
+        num_equal += predicted[i] == expected[i];
+    }
+    return static_cast<double>(num_equal) / expected.size();
+}
+
+}  // namespace aikit::ml
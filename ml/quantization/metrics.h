@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace aikit::ml {
+
+// Box of an object in a frame, normalized by the size of the frame.
+struct LabeledBox {
+    int label_id = 0;
+    float xmin = 0.0f;
+    float ymin = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    // Confidence of a detection, unused by the ground truth.
+    float score = 1.0f;
+};
+
+float IntersectionOverUnion(const LabeledBox& a, const LabeledBox& b);
+
+// Mean over the labels of the ground truth of the average precision of
+// the detections. `detections[i]` and `ground_truth[i]` are the boxes of
+// the i-th frame.
+//
+// Detections of a label are matched in the order of their scores, a
+// detection is a true positive if its IoU with a ground truth box of the
+// label, which is not matched yet, is at least `iou_threshold`. The
+// precision is interpolated at every recall point (as VOC 2010+ and
+// COCO at a single threshold do).
+double MeanAveragePrecision(const std::vector<std::vector<LabeledBox>>& detections,
+                            const std::vector<std::vector<LabeledBox>>& ground_truth,
+                            float iou_threshold = 0.5f);
+
+// Share of the predictions equal to the expected strings.
+double ExactMatch(const std::vector<std::string>& predicted, const std::vector<std::string>& expected);
+
+}  // namespace aikit::ml
@@ -0,0 +1,46 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "ml/quantization/metrics.h"
+
+using aikit::ml::LabeledBox;
+
+TEST(TestMLQuantizationMetrics, IntersectionOverUnion) {
+    const LabeledBox a{.xmin = 0.0f, .ymin = 0.0f, .width = 0.5f, .height = 0.5f};
+    const LabeledBox b{.xmin = 0.25f, .ymin = 0.0f, .width = 0.5f, .height = 0.5f};
+    EXPECT_FLOAT_EQ(aikit::ml::IntersectionOverUnion(a, a), 1.0f);
+    EXPECT_FLOAT_EQ(aikit::ml::IntersectionOverUnion(a, b), 1.0f / 3.0f);
+    EXPECT_FLOAT_EQ(aikit::ml::IntersectionOverUnion(a, {.xmin = 0.6f, .width = 0.1f, .height = 0.1f}), 0.0f);
+}
+
+TEST(TestMLQuantizationMetrics, MeanAveragePrecision) {
+    const std::vector<std::vector<LabeledBox>> ground_truth = {
+        {{.label_id = 0, .xmin = 0.1f, .ymin = 0.1f, .width = 0.2f, .height = 0.2f},
+         {.label_id = 1, .xmin = 0.5f, .ymin = 0.5f, .width = 0.3f, .height = 0.3f}},
+        {{.label_id = 0, .xmin = 0.6f, .ymin = 0.1f, .width = 0.2f, .height = 0.2f}},
+    };
+    EXPECT_DOUBLE_EQ(aikit::ml::MeanAveragePrecision(ground_truth, ground_truth), 1.0);
+
+    // Label 0: a false positive ranked first, then both boxes, the
+    // precision is 1/2 and 2/3, interpolated to 2/3 at both recalls.
+    // Label 1: the box is found twice, the second one is a false positive
+    // ranked after it, AP is 1.
+    const std::vector<std::vector<LabeledBox>> detections = {
+        {{.label_id = 0, .xmin = 0.11f, .ymin = 0.1f, .width = 0.2f, .height = 0.2f, .score = 0.8f},
+         {.label_id = 0, .xmin = 0.4f, .ymin = 0.4f, .width = 0.1f, .height = 0.1f, .score = 0.9f},
+         {.label_id = 1, .xmin = 0.5f, .ymin = 0.5f, .width = 0.3f, .height = 0.3f, .score = 0.9f},
+         {.label_id = 1, .xmin = 0.52f, .ymin = 0.5f, .width = 0.3f, .height = 0.3f, .score = 0.5f}},
+        {{.label_id = 0, .xmin = 0.6f, .ymin = 0.12f, .width = 0.2f, .height = 0.2f, .score = 0.7f}},
+    };
+    EXPECT_NEAR(aikit::ml::MeanAveragePrecision(detections, ground_truth), (2.0 / 3.0 + 1.0) / 2.0, 1e-9);
+
+    // Nothing detected.
+    EXPECT_DOUBLE_EQ(aikit::ml::MeanAveragePrecision({{}, {}}, ground_truth), 0.0);
+}
+
+TEST(TestMLQuantizationMetrics, ExactMatch) {
+    EXPECT_DOUBLE_EQ(aikit::ml::ExactMatch({"Alice", "Bob", "Eve"}, {"Alice", "Rob", "Eve"}), 2.0 / 3.0);
+    EXPECT_DOUBLE_EQ(aikit::ml::ExactMatch({}, {}), 0.0);
+}
@@ -0,0 +1,281 @@
+// Compares the float and the quantized variants of the visual models on
+// the frames held out of the calibration (see ml/detection/converter.py
+// and ml/ocr/converter.py): latency, memory and accuracy, detection mAP
+// for CDetr and exact match of the names for OCR.
+//
+// bazel run //ml/quantization:report -- \
+//   --cdetr_models=ml/detection/models/model.onnx,ml/detection/models/model_int8.onnx \
+//   --detection_labels=/path/to/held_out_labels.txt
+//
+// Exits with failure if a model is less accurate than the first one of
+// its list by more than --max_accuracy_drop, so the quantized model is
+// shipped only where the accuracy holds.
+//
+// The CDetr variants at lower resolutions are compared the same way, the
+// latency and the mAP of each resolution:
+//
+// bazel run //ml/quantization:report -- \
+//   --cdetr_models=ml/detection/models/model.onnx,ml/detection/models/model_960x540.onnx,ml/detection/models/model_640x360.onnx \
+//   --detection_labels=/path/to/held_out_labels.txt
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/flags/usage.h"
+#include "absl/log/absl_log.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "ml/detection/model.h"
+#include "ml/ocr/model.h"
+#include "ml/quantization/metrics.h"
+
+ABSL_FLAG(std::vector<std::string>, cdetr_models, {},
+          "Comma separated CDetr models, the first one is the reference.");
+ABSL_FLAG(std::string, detection_labels, "",
+          "Held-out frames, held_out_labels.txt of ml/detection/converter.py.");
+ABSL_FLAG(std::vector<std::string>, ocr_models, {},
+          "Comma separated OCR models, the first one is the reference.");
+ABSL_FLAG(std::string, ocr_labels, "", "Held-out crops, held_out_labels.txt of ml/ocr/converter.py.");
+ABSL_FLAG(double, max_accuracy_drop, 0.02, "Largest drop of mAP or exact match from the reference model.");
+
+namespace {
+struct Frame {
+    std::string path;
+    cv::Mat image;
+    std::vector<aikit::ml::LabeledBox> boxes;
+};
+
+struct Crop {
+    cv::Mat image;
+    std::string text;
+};
+
+struct Report {
+    double mean_ms = 0.0;
+    double p90_ms = 0.0;
+    // Growth of the resident memory while the model is loaded and
+    // warmed up. The models are run one after another in this process,
+    // memory freed by the earlier ones may be reused.
+    double memory_mb = 0.0;
+    double accuracy = 0.0;
+};
+
+double ResidentMemoryMB() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            std::vector<std::string> fields = absl::StrSplit(line, ' ', absl::SkipEmpty());
+            double kb = 0.0;
+            if (fields.size() >= 2 && absl::SimpleAtod(fields[1], &kb)) {
+                return kb / 1024.0;
+            }
+        }
+    }
+    return 0.0;
+}
+
+// Empty if the image can't be read.
+cv::Mat ReadImage(const std::string& path, int code, int width, int height) {
+    const cv::Mat bgr = cv::imread(path);
+    if (bgr.empty()) {
+        return bgr;
+    }
+    cv::Mat image;
+    cv::cvtColor(bgr, image, code);
+    if (image.cols != width || image.rows != height) {
+        cv::resize(image, image, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    }
+    return image;
+}
+
+absl::StatusOr<std::vector<Frame>> ReadFrames(const std::string& labels_path) {
+    std::ifstream labels(labels_path);
+    if (!labels) {
+        return absl::NotFoundError(absl::StrFormat("Can't read %s", labels_path));
+    }
+    std::vector<Frame> frames;
+    std::string line;
+    while (std::getline(labels, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        std::vector<std::string> fields = absl::StrSplit(line, '\t');
+        if (frames.empty() || frames.back().path != fields[0]) {
+            frames.push_back({.path = fields[0],
+                              .image = ReadImage(fields[0], cv::COLOR_BGR2RGB, aikit::ml::CDetr::width,
+                                                 aikit::ml::CDetr::height)});
+            if (frames.back().image.empty()) {
+                return absl::NotFoundError(absl::StrFormat("Can't read %s", fields[0]));
+            }
+        }
+        if (fields.size() < 2) {
+            continue;
+        }
+        std::vector<std::string> values = absl::StrSplit(fields[1], ' ', absl::SkipEmpty());
+        aikit::ml::LabeledBox box;
+        if (values.size() != 5 || !absl::SimpleAtoi(values[0], &box.label_id) ||
+            !absl::SimpleAtof(values[1], &box.xmin) || !absl::SimpleAtof(values[2], &box.ymin) ||
+            !absl::SimpleAtof(values[3], &box.width) || !absl::SimpleAtof(values[4], &box.height)) {
+            return absl::InvalidArgumentError(absl::StrFormat("Bad box in %s: %s", labels_path, line));
+        }
+        frames.back().boxes.push_back(box);
+    }
+    return frames;
+}
+
+absl::StatusOr<std::vector<Crop>> ReadCrops(const std::string& labels_path) {
+    std::ifstream labels(labels_path);
+    if (!labels) {
+        return absl::NotFoundError(absl::StrFormat("Can't read %s", labels_path));
+    }
+    std::vector<Crop> crops;
+    std::string line;
+    while (std::getline(labels, line)) {
+        std::vector<std::string> fields = absl::StrSplit(line, absl::MaxSplits('\t', 1));
+        if (fields.size() != 2) {
+            continue;
+        }
+        crops.push_back({.image = ReadImage(fields[0], cv::COLOR_BGR2GRAY, aikit::ml::OCR::width,
+                                            aikit::ml::OCR::height),
+                         .text = fields[1]});
+        if (crops.back().image.empty()) {
+            return absl::NotFoundError(absl::StrFormat("Can't read %s", fields[0]));
+        }
+    }
+    return crops;
+}
+
+// Runs the model on every input, fills the latency of the report.
+template <typename Model, typename Input, typename Output>
+std::vector<Output> Run(Model& model, const std::vector<Input>& inputs, Report& report) {
+    std::vector<Output> outputs;
+    std::vector<double> latencies_ms;
+    for (const auto& input : inputs) {
+        const auto start = std::chrono::steady_clock::now();
+        outputs.push_back(model(input.image.data));
+        latencies_ms.push_back(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    if (!latencies_ms.empty()) {
+        report.mean_ms = std::accumulate(latencies_ms.begin(), latencies_ms.end(), 0.0) / latencies_ms.size();
+        std::sort(latencies_ms.begin(), latencies_ms.end());
+        report.p90_ms = latencies_ms[latencies_ms.size() * 9 / 10];
+    }
+    return outputs;
+}
+
+Report EvaluateCDetr(const std::string& model_path, const std::vector<Frame>& frames) {
+    Report report;
+    const double memory_mb = ResidentMemoryMB();
+    aikit::ml::CDetr model(model_path);
+    model(frames.front().image.data);
+    report.memory_mb = ResidentMemoryMB() - memory_mb;
+
+    const auto outputs = Run<aikit::ml::CDetr, Frame, std::vector<aikit::ml::Detection>>(model, frames, report);
+    std::vector<std::vector<aikit::ml::LabeledBox>> detections;
+    std::vector<std::vector<aikit::ml::LabeledBox>> ground_truth;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        auto& boxes = detections.emplace_back();
+        for (const auto& detection : outputs[i]) {
+            boxes.push_back({
+                .label_id = detection.label_id,
+                .xmin = detection.x_center - detection.width * 0.5f,
+                .ymin = detection.y_center - detection.height * 0.5f,
+                .width = detection.width,
+                .height = detection.height,
+                .score = detection.score,
+            });
+        }
+        ground_truth.push_back(frames[i].boxes);
+    }
+    report.accuracy = aikit::ml::MeanAveragePrecision(detections, ground_truth);
+    return report;
+}
+
+Report EvaluateOCR(const std::string& model_path, const std::vector<Crop>& crops) {
+    Report report;
+    const double memory_mb = ResidentMemoryMB();
+    aikit::ml::OCR model(model_path);
+    model(crops.front().image.data);
+    report.memory_mb = ResidentMemoryMB() - memory_mb;
+
+    const auto outputs = Run<aikit::ml::OCR, Crop, std::string>(model, crops, report);
+    std::vector<std::string> expected;
+    for (const auto& crop : crops) {
+        expected.push_back(crop.text);
+    }
+    report.accuracy = aikit::ml::ExactMatch(outputs, expected);
+    return report;
+}
+
+// Prints the reports of the models, returns whether their accuracy
+// holds against the first one.
+bool PrintReports(const std::string& metric, const std::vector<std::string>& models,
+                  const std::vector<Report>& reports) {
+    bool accuracy_holds = true;
+    std::cout << absl::StrFormat("%-60s %10s %10s %12s %12s\n", "model", "mean, ms", "p90, ms", "memory, MB",
+                                 metric);
+    for (size_t i = 0; i < models.size(); ++i) {
+        const auto& report = reports[i];
+        const double drop = reports.front().accuracy - report.accuracy;
+        const bool holds = drop <= absl::GetFlag(FLAGS_max_accuracy_drop);
+        accuracy_holds = accuracy_holds && holds;
+        std::cout << absl::StrFormat("%-60s %10.1f %10.1f %12.1f %12.4f%s\n", models[i], report.mean_ms,
+                                     report.p90_ms, report.memory_mb, report.accuracy,
+                                     holds ? "" : "  accuracy drop");
+    }
+    return accuracy_holds;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    absl::SetProgramUsageMessage("Compares the float and the quantized visual models.");
+    absl::ParseCommandLine(argc, argv);
+
+    bool accuracy_holds = true;
+    const auto cdetr_models = absl::GetFlag(FLAGS_cdetr_models);
+    if (!cdetr_models.empty()) {
+        auto frames = ReadFrames(absl::GetFlag(FLAGS_detection_labels));
+        if (!frames.ok() || frames->empty()) {
+            ABSL_LOG(ERROR) << "No held-out frames: " << frames.status().message();
+            return EXIT_FAILURE;
+        }
+        std::vector<Report> reports;
+        for (const auto& model : cdetr_models) {
+            reports.push_back(EvaluateCDetr(model, *frames));
+        }
+        accuracy_holds = PrintReports("mAP@0.5", cdetr_models, reports) && accuracy_holds;
+    }
+
+    const auto ocr_models = absl::GetFlag(FLAGS_ocr_models);
+    if (!ocr_models.empty()) {
+        auto crops = ReadCrops(absl::GetFlag(FLAGS_ocr_labels));
+        if (!crops.ok() || crops->empty()) {
+            ABSL_LOG(ERROR) << "No held-out crops: " << crops.status().message();
+            return EXIT_FAILURE;
+        }
+        std::vector<Report> reports;
+        for (const auto& model : ocr_models) {
+            reports.push_back(EvaluateOCR(model, *crops));
+        }
+        accuracy_holds = PrintReports("exact match", ocr_models, reports) && accuracy_holds;
+    }
+
+    return accuracy_holds ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,129 @@
+#include "ml/whisper/model.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <onnxruntime_extensions.h>
+
+#include "absl/strings/str_cat.h"
+#include "ml/common/ort_runtime.h"
+#include "ml/common/wav.h"
+
+namespace aikit::ml {
+namespace {
+// First token of the decoder, <|startoftranscript|>.
+constexpr int32_t kDecoderStartTokenId = 50258;
+} // namespace
+
+Whisper::Whisper(const std::string &path_to_model,
+                 const WhisperOptions &options)
+    : options_(options) {
+  run_options_ = Ort::RunOptions();
+  // The shared thread pools unless the number of threads is given.
+  session_options_ = OrtRuntime::SessionOptions(log_id_, logging_level_,
+                                                options_.num_threads);
+  num_threads_ = options_.num_threads > 0 ? options_.num_threads
+                                          : OrtRuntime::intra_op_num_threads();
+  // Audio decoding and the tokenizer of the model are custom ops of
+  // onnxruntime-extensions.
+  Ort::ThrowOnError(RegisterCustomOps(
+      static_cast<OrtSessionOptions *>(session_options_), OrtGetApiBase()));
+
+  session_ = Ort::Session(OrtRuntime::Env(), path_to_model.c_str(),
+                          session_options_);
+  memory_info_ = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+
+  Ort::AllocatorWithDefaultOptions allocator;
+  for (size_t i = 0; i < session_.GetInputCount(); ++i) {
+    input_names_.emplace_back(
+        session_.GetInputNameAllocated(i, allocator).get());
+  }
+  for (size_t i = 0; i < session_.GetOutputCount(); ++i) {
+    output_names_.emplace_back(
+        session_.GetOutputNameAllocated(i, allocator).get());
+  }
+
+  // Scalars don't change between the calls, the order matches the
+  // names below.
+  int_inputs_ = {options_.max_length, 0, options_.num_beams, 1, 1,
+                 kDecoderStartTokenId};
+  float_inputs_ = {options_.length_penalty, options_.repetition_penalty};
+}
+
+absl::StatusOr<std::vector<WhisperSegment>>
+Whisper::operator()(absl::Span<const float> audio) {
+  const size_t max_samples = static_cast<size_t>(kWindowSec * kSampleRate);
+  if (audio.size() > max_samples) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Whisper window is at most ", kWindowSec, " s, got ",
+                     audio.size() / kSampleRate, " s"));
+  }
+  auto wav = EncodeWav(audio, kSampleRate);
+
+  const std::array<int64_t, 2> audio_shape = {
+      1, static_cast<int64_t>(wav.size())};
+  const std::array<int64_t, 1> scalar_shape = {1};
+  const std::array<int64_t, 2> decoder_input_shape = {1, 1};
+  auto int_scalar = [&](size_t index) {
+    return Ort::Value::CreateTensor<int32_t>(memory_info_, &int_inputs_[index],
+                                             1, scalar_shape.data(),
+                                             scalar_shape.size());
+  };
+  auto float_scalar = [&](size_t index) {
+    return Ort::Value::CreateTensor<float>(memory_info_,
+                                           &float_inputs_[index], 1,
+                                           scalar_shape.data(),
+                                           scalar_shape.size());
+  };
+
+  std::vector<const char *> input_names;
+  std::vector<Ort::Value> inputs;
+  for (const auto &name : input_names_) {
+    if (name == "audio_stream") {
+      inputs.push_back(Ort::Value::CreateTensor<uint8_t>(
+          memory_info_, wav.data(), wav.size(), audio_shape.data(),
+          audio_shape.size()));
+    } else if (name == "max_length") {
+      inputs.push_back(int_scalar(0));
+    } else if (name == "min_length") {
+      inputs.push_back(int_scalar(1));
+    } else if (name == "num_beams") {
+      inputs.push_back(int_scalar(2));
+    } else if (name == "num_return_sequences") {
+      inputs.push_back(int_scalar(3));
+    } else if (name == "logits_processor") {
+      // Enables the timestamp tokens.
+      inputs.push_back(int_scalar(4));
+    } else if (name == "decoder_input_ids") {
+      inputs.push_back(Ort::Value::CreateTensor<int32_t>(
+          memory_info_, &int_inputs_[5], 1, decoder_input_shape.data(),
+          decoder_input_shape.size()));
+    } else if (name == "length_penalty") {
+      inputs.push_back(float_scalar(0));
+    } else if (name == "repetition_penalty") {
+      inputs.push_back(float_scalar(1));
+    } else {
+      return absl::UnimplementedError(
+          absl::StrCat("Whisper model input ", name, " is not supported"));
+    }
+    input_names.push_back(name.c_str());
+  }
+  const char *output_name = output_names_.front().c_str();
+
+  std::string text;
+  try {
+    auto outputs = session_.Run(run_options_, input_names.data(),
+                                inputs.data(), inputs.size(), &output_name, 1);
+    // [batch, num_return_sequences] of strings.
+    const auto &output = outputs.front();
+    text.resize(output.GetStringTensorElementLength(0));
+    output.GetStringTensorElement(text.size(), 0, text.data());
+  } catch (const Ort::Exception &e) {
+    return absl::InternalError(
+        absl::StrCat("Whisper inference failed: ", e.what()));
+  }
+  return ParseWhisperTranscript(text, static_cast<float>(audio.size()) /
+                                          kSampleRate);
+}
+
+} // namespace aikit::ml
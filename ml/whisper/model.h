@@ -0,0 +1,68 @@
+#pragma once
+
+#include <onnxruntime_cxx_api.h>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ml/whisper/transcript.h"
+
+namespace aikit::ml {
+
+struct WhisperOptions {
+  // Beam search of the decoder, 1 is greedy.
+  int num_beams = 1;
+  // Limit of the decoded tokens per window, 448 is the context of the
+  // decoder.
+  int max_length = 448;
+  float length_penalty = 1.0f;
+  float repetition_penalty = 1.0f;
+  // Intra-op threads of the session, 0 to share the thread pools of
+  // OrtRuntime.
+  int num_threads = 0;
+};
+
+// Whisper exported by ml/whisper/converter.py.
+//
+// The model is end-to-end: it decodes the WAV bytes, computes log-mel
+// features and runs the BeamSearch contrib op over the encoder and the
+// decoder. The encoder output and the cross-attention keys/values are
+// computed once per window and the self-attention KV cache is carried
+// from step to step inside the op, so every decoding step only runs the
+// decoder on the last token.
+class Whisper {
+public:
+  explicit Whisper(const std::string &path_to_model,
+                   const WhisperOptions &options = {});
+
+  // Transcribes at most 30 s of 16 kHz mono audio, shorter audio is
+  // padded by the model. Segment times are relative to the audio start.
+  absl::StatusOr<std::vector<WhisperSegment>>
+  operator()(absl::Span<const float> audio);
+
+  int num_threads() const { return num_threads_; }
+
+public:
+  static constexpr int kSampleRate = 16000;
+  static constexpr float kWindowSec = 30.0f;
+
+private:
+  std::string log_id_ = "whisper";
+  OrtLoggingLevel logging_level_ = ORT_LOGGING_LEVEL_WARNING;
+  WhisperOptions options_;
+  int num_threads_;
+
+  Ort::RunOptions run_options_;
+  Ort::SessionOptions session_options_;
+  Ort::Session session_{nullptr};
+  Ort::MemoryInfo memory_info_{nullptr};
+
+  std::vector<std::string> input_names_;
+  std::vector<std::string> output_names_;
+  // Scalars of the search options, kept alive for the tensors which
+  // point to them.
+  std::vector<int32_t> int_inputs_;
+  std::vector<float> float_inputs_;
+};
+} // namespace aikit::ml
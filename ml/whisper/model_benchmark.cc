@@ -0,0 +1,41 @@
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+#include "ml/common/wav.h"
+#include "ml/whisper/model.h"
+
+// Transcription of a 30 s window, the argument is the number of threads
+// of the session. rtf is the wall time divided by the audio duration,
+// core_rtf is the same per thread, it's comparable with the rtf of the
+// single threaded Vosk in ml/asr:model_benchmark.
+static void BM_Whisper_Window(benchmark::State &state) {
+  auto audio = aikit::ml::ReadWav("testdata/whisper_audio.wav");
+  if (!audio.ok()) {
+    state.SkipWithError("No test audio");
+    return;
+  }
+  aikit::ml::Whisper model(
+      "ml/whisper/models/onnx/whisper-large-v2_fp32_e2e.onnx",
+      {.num_threads = static_cast<int>(state.range(0))});
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(model(audio->samples));
+  }
+
+  const double audio_sec = audio->duration_sec() * state.iterations();
+  state.counters["rtf"] = benchmark::Counter(
+      audio_sec, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.counters["core_rtf"] = benchmark::Counter(
+      audio_sec / model.num_threads(),
+      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(BM_Whisper_Window)
+    ->ArgName("threads")
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->Iterations(3)
+    ->UseRealTime()
+    ->Unit(benchmark::kSecond);
+BENCHMARK_MAIN();
@@ -0,0 +1,33 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "ml/common/wav.h"
+#include "ml/whisper/model.h"
+
+#include "absl/log/absl_log.h"
+
+TEST(TestMLWhisperModel, SanityCheck) {
+  auto audio = aikit::ml::ReadWav("testdata/whisper_audio.wav");
+  ASSERT_TRUE(audio.ok()) << audio.status().message();
+  ASSERT_EQ(audio->sample_rate, aikit::ml::Whisper::kSampleRate);
+
+  aikit::ml::Whisper model(
+      "ml/whisper/models/onnx/whisper-large-v2_fp32_e2e.onnx");
+  auto segments = model(audio->samples);
+  ASSERT_TRUE(segments.ok()) << segments.status().message();
+  ASSERT_FALSE(segments->empty());
+
+  std::string text;
+  float prev_end = 0.0f;
+  for (const auto &segment : segments.value()) {
+    ABSL_LOG(INFO) << segment.start << " - " << segment.end << ": "
+                   << segment.text;
+    EXPECT_LE(prev_end, segment.start);
+    EXPECT_LE(segment.start, segment.end);
+    EXPECT_LE(segment.end, aikit::ml::Whisper::kWindowSec);
+    prev_end = segment.end;
+    text += segment.text;
+  }
+  EXPECT_NE(text.find("Продукт"), std::string::npos) << text;
+}
@@ -0,0 +1,96 @@
+#include "ml/whisper/transcript.h"
+
+#include <cstdlib>
+#include <optional>
+
+namespace aikit::ml {
+namespace {
+// Leading and trailing whitespace is an artifact of the tokenization.
+std::string Trim(std::string_view text) {
+    const auto begin = text.find_first_not_of(" \t\n");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    const auto end = text.find_last_not_of(" \t\n");
+    return std::string(text.substr(begin, end - begin + 1));
+}
+
+// Value of the "<|12.34|>" token at the start of `text`.
+std::optional<float> ParseTimestampToken(std::string_view text, size_t& token_size) {
+    if (text.substr(0, 2) != "<|") {
+        return std::nullopt;
+    }
+    const auto close = text.find("|>");
+    if (close == std::string_view::npos) {
+        return std::nullopt;
+    }
+    const std::string value(text.substr(2, close - 2));
+    char* parsed_end = nullptr;
+    const float seconds = std::strtof(value.c_str(), &parsed_end);
+    if (value.empty() || parsed_end != value.c_str() + value.size()) {
+        // Some other special token, like <|ru|>.
+        return std::nullopt;
+    }
+    token_size = close + 2;
+    return seconds;
+}
+}  // namespace
+
+std::vector<WhisperSegment> ParseWhisperTranscript(std::string_view text, float window_sec) {
+    std::vector<WhisperSegment> segments;
+    std::optional<float> start;
+    std::string segment_text;
+    bool has_timestamps = false;
+    for (size_t pos = 0; pos < text.size();) {
+        size_t token_size = 0;
+        auto timestamp = ParseTimestampToken(text.substr(pos), token_size);
+        if (!timestamp.has_value()) {
+            segment_text.push_back(text[pos]);
+            ++pos;
+            continue;
+        }
+        has_timestamps = true;
+        pos += token_size;
+        if (!start.has_value()) {
+            start = timestamp;
+            segment_text.clear();
+            continue;
+        }
+        auto trimmed = Trim(segment_text);
+        if (!trimmed.empty()) {
+            segments.push_back({start.value(), timestamp.value(), std::move(trimmed)});
+        }
+        start.reset();
+        segment_text.clear();
+    }
+
+    auto trimmed = Trim(segment_text);
+    if (!trimmed.empty()) {
+        segments.push_back({has_timestamps ? start.value_or(0.0f) : 0.0f, window_sec, std::move(trimmed)});
+    }
+    return segments;
+}
+
+WhisperCommit CommitWhisperSegments(const std::vector<WhisperSegment>& segments, float commit_sec) {
+    WhisperCommit commit;
+    while (commit.num_segments < segments.size() && segments[commit.num_segments].end <= commit_sec) {
+        commit.end_sec = segments[commit.num_segments].end;
+        ++commit.num_segments;
+    }
+    if (commit.num_segments > 0) {
+        return commit;
+    }
+    if (segments.empty()) {
+        // No speech, the audio until the overlap has no text to lose.
+        commit.end_sec = commit_sec;
+    } else if (segments.front().start > 0.0f) {
+        commit.end_sec = segments.front().start;
+    } else {
+        // The next window would start at the same sample.
+        commit.num_segments = 1;
+        commit.end_sec = segments.front().end;
+    }
+    return commit;
+}
+
+}  // namespace aikit::ml
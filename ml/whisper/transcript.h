@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aikit::ml {
+
+// Part of the transcription between two timestamp tokens of Whisper,
+// times are in seconds from the start of the decoded window.
+struct WhisperSegment {
+    float start = 0.0f;
+    float end = 0.0f;
+    std::string text;
+};
+
+// Splits the decoded text "<|0.00|> Hello.<|2.40|><|2.40|> World<|4.00|>"
+// into segments. A segment without the closing timestamp (the window
+// ended in the middle of it) ends at `window_sec`. Text without any
+// timestamp tokens becomes one segment of the whole window.
+std::vector<WhisperSegment> ParseWhisperTranscript(std::string_view text, float window_sec);
+
+// Leading segments of a window which are sent and the end of the audio
+// which is dropped after them, seconds from the window start.
+struct WhisperCommit {
+    size_t num_segments = 0;
+    float end_sec = 0.0f;
+};
+
+// Segments which end after `commit_sec` may be cut by the window border,
+// they are decoded again in the next window which starts at the end of the
+// last sent segment. When no segment ends before `commit_sec`, the next
+// window starts at the first segment, or, if it already starts the window,
+// the segment is sent as is. Audio is never dropped before its text is sent.
+WhisperCommit CommitWhisperSegments(const std::vector<WhisperSegment>& segments, float commit_sec);
+
+}  // namespace aikit::ml
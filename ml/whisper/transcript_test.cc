@@ -0,0 +1,57 @@
+#include "gtest/gtest.h"
+
+#include "ml/whisper/transcript.h"
+
+TEST(TestMLWhisperTranscript, SplitsSegments) {
+    auto segments = aikit::ml::ParseWhisperTranscript(
+        "<|0.00|> Продукт-менеджер, у него огромный опыт,<|4.00|><|4.00|> с разными продуктами.<|6.50|>"
+        "<|6.50|><|7.00|><|28.00|> и потом", 30.0f);
+    ASSERT_EQ(segments.size(), 3);
+    EXPECT_EQ(segments[0].text, "Продукт-менеджер, у него огромный опыт,");
+    EXPECT_FLOAT_EQ(segments[0].start, 0.0f);
+    EXPECT_FLOAT_EQ(segments[0].end, 4.0f);
+    EXPECT_EQ(segments[1].text, "с разными продуктами.");
+    EXPECT_FLOAT_EQ(segments[1].start, 4.0f);
+    EXPECT_FLOAT_EQ(segments[1].end, 6.5f);
+    // Unfinished segment ends with the window.
+    EXPECT_EQ(segments[2].text, "и потом");
+    EXPECT_FLOAT_EQ(segments[2].start, 28.0f);
+    EXPECT_FLOAT_EQ(segments[2].end, 30.0f);
+}
+
+TEST(TestMLWhisperTranscript, KeepsOtherSpecialTokensAndPlainText) {
+    auto segments = aikit::ml::ParseWhisperTranscript(" Hello <|en|> world ", 12.0f);
+    ASSERT_EQ(segments.size(), 1);
+    EXPECT_EQ(segments[0].text, "Hello <|en|> world");
+    EXPECT_FLOAT_EQ(segments[0].start, 0.0f);
+    EXPECT_FLOAT_EQ(segments[0].end, 12.0f);
+
+    EXPECT_TRUE(aikit::ml::ParseWhisperTranscript("<|0.00|> <|2.00|>", 30.0f).empty());
+}
+
+TEST(TestMLWhisperTranscript, CommitsSegmentsBeforeOverlap) {
+    const std::vector<aikit::ml::WhisperSegment> segments = {
+        {0.0f, 4.0f, "a"}, {4.0f, 20.0f, "b"}, {20.0f, 27.0f, "c"}};
+    auto commit = aikit::ml::CommitWhisperSegments(segments, 25.0f);
+    EXPECT_EQ(commit.num_segments, 2);
+    EXPECT_FLOAT_EQ(commit.end_sec, 20.0f);
+
+    // Silence, nothing to decode again.
+    commit = aikit::ml::CommitWhisperSegments({}, 25.0f);
+    EXPECT_EQ(commit.num_segments, 0);
+    EXPECT_FLOAT_EQ(commit.end_sec, 25.0f);
+}
+
+TEST(TestMLWhisperTranscript, KeepsSegmentCrossingCommit) {
+    // The audio before the segment has no text, the segment is decoded
+    // again from its start.
+    auto commit = aikit::ml::CommitWhisperSegments({{3.0f, 28.0f, "a"}}, 25.0f);
+    EXPECT_EQ(commit.num_segments, 0);
+    EXPECT_FLOAT_EQ(commit.end_sec, 3.0f);
+
+    // The segment starts the window, it can't be decoded from a later
+    // sample, so it's sent.
+    commit = aikit::ml::CommitWhisperSegments({{0.0f, 28.0f, "a"}, {28.0f, 30.0f, "b"}}, 25.0f);
+    EXPECT_EQ(commit.num_segments, 1);
+    EXPECT_FLOAT_EQ(commit.end_sec, 28.0f);
+}
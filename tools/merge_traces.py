@@ -0,0 +1,134 @@
+import argparse
+import json
+from collections import defaultdict
+from pathlib import Path
+
+from mediapipe.framework import calculator_profile_pb2
+
+_DESCRIPTION = """
+Merges the ONNX Runtime profiles of the models with the MediaPipe traces
+of the calculators into one Chrome trace, to open in chrome://tracing or
+ui.perfetto.dev, and prints the operators which take the most time.
+
+    bazel run //av_transducer:debug -- --profile --input_file_path=...
+    bazel run //tools:merge_traces -- \\
+        --mediapipe_traces /tmp/mediapipe_trace_*.binarypb \\
+        --ort_profiles /tmp/ort_profile_*.json \\
+        --output /tmp/trace.json
+"""
+
+# Events of the calculators which take time, the rest are instants.
+_CALCULATOR_EVENTS = {
+    calculator_profile_pb2.GraphTrace.OPEN: "Open",
+    calculator_profile_pb2.GraphTrace.PROCESS: "Process",
+    calculator_profile_pb2.GraphTrace.CLOSE: "Close",
+}
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description=_DESCRIPTION, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    parser.add_argument(
+        "--mediapipe_traces",
+        help="Specify the trace logs of the MediaPipe profiler (*.binarypb).",
+        nargs="*",
+        default=[],
+        type=Path,
+    )
+    parser.add_argument(
+        "--ort_profiles",
+        help="Specify the ONNX Runtime profiles, each with its .start_ns next to it.",
+        nargs="*",
+        default=[],
+        type=Path,
+    )
+    parser.add_argument(
+        "--output",
+        help="Specify path to store the merged Chrome trace.",
+        required=True,
+        type=Path,
+    )
+    parser.add_argument(
+        "--top",
+        help="Number of the operators to print for each model.",
+        type=int,
+        default=15,
+    )
+    return parser.parse_args()
+
+
+def mediapipe_events(trace_path: Path) -> list[dict]:
+    """Calculator events of the trace log, microseconds since the epoch."""
+    profile = calculator_profile_pb2.GraphProfile()
+    profile.ParseFromString(trace_path.read_bytes())
+    events = []
+    for graph_trace in profile.graph_trace:
+        for trace in graph_trace.calculator_trace:
+            if trace.event_type not in _CALCULATOR_EVENTS or not trace.HasField("finish_time"):
+                continue
+            events.append(
+                {
+                    "name": graph_trace.calculator_name[trace.node_id],
+                    "cat": _CALCULATOR_EVENTS[trace.event_type],
+                    "ph": "X",
+                    "ts": graph_trace.base_time + trace.start_time,
+                    "dur": trace.finish_time - trace.start_time,
+                    "pid": "mediapipe",
+                    "tid": trace.thread_id,
+                    "args": {"input_timestamp": graph_trace.base_timestamp + trace.input_timestamp},
+                }
+            )
+    return events
+
+
+def ort_events(profile_path: Path) -> list[dict]:
+    """Events of the profile moved to microseconds since the epoch.
+
+    The profile is relative to the start of profiling, which
+    aikit::ml::OrtRuntime::EndProfiling writes to <profile>.start_ns.
+    """
+    start_us = int(Path(str(profile_path) + ".start_ns").read_text()) // 1000
+    # <prefix>_<model>_<date>.json, a process per model.
+    model = profile_path.stem.rsplit("_", 2)[0]
+    events = json.loads(profile_path.read_text())
+    for event in events:
+        event["ts"] = start_us + event["ts"]
+        event["pid"] = model
+    return events
+
+
+def print_top_operators(events: list[dict], top: int):
+    """Total time of each operator type per model, the largest first."""
+    run_us = defaultdict(int)
+    op_us = defaultdict(lambda: defaultdict(int))
+    for event in events:
+        if event.get("cat") == "Session" and event["name"] == "model_run":
+            run_us[event["pid"]] += event["dur"]
+        elif event.get("cat") == "Node" and event["name"].endswith("_kernel_time"):
+            op_us[event["pid"]][event["args"].get("op_name", event["name"])] += event["dur"]
+
+    for model, ops in op_us.items():
+        total_us = run_us[model] or sum(ops.values())
+        print(f"{model}: {total_us / 1000:.1f} ms in model runs")
+        for op_name, us in sorted(ops.items(), key=lambda item: -item[1])[:top]:
+            print(f"  {op_name:<32} {us / 1000:10.1f} ms {100 * us / total_us:6.1f}%")
+
+
+def main():
+    args = parse_args()
+    events = []
+    for trace_path in args.mediapipe_traces:
+        events.extend(mediapipe_events(trace_path))
+    model_events = []
+    for profile_path in args.ort_profiles:
+        model_events.extend(ort_events(profile_path))
+    events.extend(model_events)
+
+    args.output.write_text(json.dumps({"traceEvents": events, "displayTimeUnit": "ms"}))
+    print(f"{len(events)} events written to {args.output}")
+    print_top_operators(model_events, args.top)
+
+
+if __name__ == "__main__":
+    main()